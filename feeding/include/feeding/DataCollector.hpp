@@ -1,7 +1,9 @@
 #ifndef FEEDING_DATACOLLECTOR_HPP_
 #define FEEDING_DATACOLLECTOR_HPP_
 
+#include <chrono>
 #include <fstream>
+#include <future>
 #include <iostream>
 
 #include <aikido/rviz/InteractiveMarkerViewer.hpp>
@@ -14,11 +16,20 @@
 #include <ros/ros.h>
 #include <rosbag/bag.h>
 #include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/JointState.h>
 
 #include <libada/Ada.hpp>
 
+#include "feeding/Dataset.hpp"
+#include "feeding/DepthCodec.hpp"
 #include "feeding/FTThresholdHelper.hpp"
 #include "feeding/FeedingDemo.hpp"
+#include "feeding/ImageWriter.hpp"
+#include "feeding/PlanningPortfolio.hpp"
+#include "feeding/SkewerSuccessClassifier.hpp"
+#include "feeding/SynchronizedCapture.hpp"
+#include "feeding/TrialLog.hpp"
+#include "feeding/TrialRecorder.hpp"
 #include "feeding/perception/Perception.hpp"
 #include "feeding/util.hpp"
 
@@ -96,7 +107,71 @@ private:
 
   void recordSuccess();
 
-  void captureFrame();
+  /// Requests a synchronized color and depth pair.
+  /// \param[in] waitUntilSettled If true, only frames taken after the arm
+  /// came to rest are used.
+  /// \return Resolved once the pair has been handed to the image writer.
+  std::future<CapturedFrames> requestCapture(bool waitUntilSettled = true);
+
+  /// Captures a pair once the arm has settled and waits for it.
+  /// \return False if no pair arrived within the capture timeout.
+  bool captureFrame();
+
+  /// Timings of one viewpoint of an image sweep.
+  struct ViewTiming
+  {
+    int step = 0;
+    bool success = false;
+    /// Planning time, spent while the arm moved to the previous view.
+    std::chrono::duration<double, std::milli> planTime{0};
+    /// Part of the planning time the arm had to wait for.
+    std::chrono::duration<double, std::milli> waitTime{0};
+    std::chrono::duration<double, std::milli> executionTime{0};
+    /// Time from arriving until a settled frame pair was captured.
+    std::chrono::duration<double, std::milli> captureTime{0};
+  };
+
+  /// Moves through the side views of \c steps and captures a frame pair at
+  /// each. Views are visited in nearest-neighbor order from the current end
+  /// effector pose, and each view is planned while the arm moves to the
+  /// previous one.
+  /// \return Timings of all views, in visiting order.
+  std::vector<ViewTiming> sweepViews(const std::vector<int>& steps);
+
+  /// Plans to the side view \c step from the arm configuration \c start
+  /// and times the path. Safe to call while the arm moves.
+  aikido::trajectory::TrajectoryPtr planToView(
+      int step, const Eigen::VectorXd& start);
+
+  /// Queues a captured pair for writing.
+  /// \return False if the writer cannot take both images right now.
+  bool storeFrames(const CapturedFrames& frames);
+
+  void jointStateCallback(const sensor_msgs::JointState::ConstPtr& msg);
+
+  /// True if the arm had been still for the settle time at \c stamp.
+  bool isSettledAt(const ros::Time& stamp) const;
+
+  /// Waits for all captured images to be on disk and logs the writer
+  /// statistics.
+  void finishImageWrites();
+
+  /// Opens the dataset of \c action in \c directory, starts the trial
+  /// \c trialName and routes encoded images into it.
+  void openDataset(
+      const std::string& directory,
+      const std::string& action,
+      const std::string& trialName);
+
+  /// Waits for pending images and closes the dataset, if one is open.
+  void closeDataset();
+
+  /// Starts the event log of \c trialName in \c filename and hands it to
+  /// the FeedingDemo.
+  void openTrialLog(const std::string& filename, const std::string& trialName);
+
+  /// Detaches the event log of the current trial.
+  void closeTrialLog();
 
   /// Update mColorImageCount and mDepthImageCount to match
   /// the number of images in the respective directories.
@@ -104,6 +179,8 @@ private:
 
   std::shared_ptr<FeedingDemo> mFeedingDemo;
   std::shared_ptr<ada::Ada> mAda;
+  // Plans the next view on a copy of the robot while the arm moves.
+  std::shared_ptr<PlanningPortfolio> mPlanningPortfolio;
 
   ros::NodeHandle mNodeHandle;
   const bool mAutoContinueDemo;
@@ -118,13 +195,31 @@ private:
   std::vector<double> mDirections;
   std::vector<std::string> mAngleNames;
 
+  // If true, a session is stored as one dataset file instead of a
+  // directory tree; mDataset is the file of the current trial. Replaced
+  // with std::atomic_store, since the info callbacks read it with
+  // std::atomic_load.
+  bool mUseDataset;
+  std::shared_ptr<DatasetWriter> mDataset;
+
+  // Declared before the subscribers so it outlives their callbacks.
+  std::unique_ptr<ImageWriter> mImageWriter;
+
   image_transport::Subscriber sub;
   image_transport::Subscriber sub2;
   ros::Subscriber sub3;
   ros::Subscriber sub4;
+  ros::Subscriber mJointStateSub;
+
+  std::unique_ptr<SynchronizedCapture> mCapture;
+  std::chrono::milliseconds mCaptureTimeout;
+
+  // Stamp in seconds since which all joint velocities were below
+  // mSettledVelocity, infinity while moving.
+  std::atomic<double> mSettledSince;
+  double mSettledVelocity;
+  double mSettleTime;
 
-  std::atomic<bool> mShouldRecordColorImage;
-  std::atomic<bool> mShouldRecordDepthImage;
   std::atomic<bool> mShouldRecordColorInfo;
   std::atomic<bool> mShouldRecordDepthInfo;
   std::atomic<bool> isAfterPush;
@@ -134,6 +229,12 @@ private:
   std::atomic<int> mColorImageCount;
   std::atomic<int> mDepthImageCount;
 
+  // Raw F/T and joint state stream of the current trial.
+  std::unique_ptr<TrialRecorder> mTrialRecorder;
+
+  // Motions, thresholds, images and outcome of the current trial.
+  std::shared_ptr<TrialLog> mTrialLog;
+
   std::mutex mCallbackLock;
   std::mutex mCameraInfoCallbackLock;
 
@@ -0,0 +1,251 @@
+#ifndef FEEDING_DATASET_HPP_
+#define FEEDING_DATASET_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <opencv2/core/core.hpp>
+
+#include "feeding/FTSampleBuffer.hpp"
+#include "feeding/TrialRecorder.hpp"
+
+namespace feeding {
+
+/// Binary layout of dataset files.
+///
+/// A dataset holds all trials of a data collection session in one file.
+/// After the FileHeader come chunks, each a ChunkHeader followed by its
+/// payload padded to 8 bytes, so every chunk and all doubles in it are
+/// aligned when the file is memory mapped. Closing the file appends an
+/// index of all chunks and a Footer. Reopening a dataset drops the index,
+/// appends new chunks and writes a new index on close. If the footer is
+/// missing after a crash, the index is rebuilt by walking the chunks.
+namespace dataset {
+
+static const char MAGIC[8] = {'F', 'E', 'E', 'D', 'D', 'S', 'E', 'T'};
+static const char FOOTER_MAGIC[8] = {'F', 'E', 'E', 'D', 'I', 'D', 'X', '\0'};
+static const std::uint32_t VERSION = 1;
+
+enum ChunkType : std::uint32_t
+{
+  /// Starts a trial; payload is the trial name.
+  TRIAL = 1,
+  /// FrameHeader followed by the encoded image.
+  FRAME = 2,
+  /// CameraInfoRecord.
+  CAMERA_INFO = 3,
+  /// A batch of trialrecord records (F/T and joint states).
+  SENSOR_RECORDS = 4,
+  /// Outcome label of the trial, e.g. "success", "fail" or "deleted".
+  OUTCOME = 5
+};
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+};
+
+struct ChunkHeader
+{
+  std::uint32_t type;
+  std::uint32_t trial;
+  /// Payload size without padding.
+  std::uint64_t size;
+  double time;
+};
+
+struct FrameHeader
+{
+  char stream[8];
+  /// Extension understood by cv::imdecode, e.g. "png".
+  char format[8];
+  std::int32_t width;
+  std::int32_t height;
+  /// OpenCV type of the decoded image, e.g. CV_16UC1.
+  std::int32_t cvType;
+  std::uint32_t reserved;
+};
+
+struct CameraInfoRecord
+{
+  char stream[8];
+  std::uint32_t width;
+  std::uint32_t height;
+  /// Row-major intrinsic matrix.
+  double K[9];
+};
+
+struct IndexEntry
+{
+  /// Offset of the ChunkHeader in the file.
+  std::uint64_t offset;
+  std::uint64_t size;
+  std::uint32_t type;
+  std::uint32_t trial;
+  double time;
+};
+
+struct Footer
+{
+  std::uint64_t indexOffset;
+  std::uint64_t numEntries;
+  char magic[8];
+};
+
+/// Builds the index of a dataset in memory.
+/// \param[in] data Start of the file.
+/// \param[in] size Size of the file.
+/// \param[out] index All complete chunks.
+/// \return Offset after the last complete chunk, where new chunks go.
+/// Throws a runtime_error if data is not a dataset.
+std::size_t readIndex(
+    const char* data, std::size_t size, std::vector<IndexEntry>& index);
+
+} // namespace dataset
+
+/// Camera intrinsics of one stream.
+struct CameraIntrinsics
+{
+  int width = 0;
+  int height = 0;
+  Eigen::Matrix3d K = Eigen::Matrix3d::Identity();
+};
+
+/// Appends trials to a dataset file. All methods are thread safe.
+class DatasetWriter
+{
+public:
+  /// Opens \c filename for appending, creating it if needed. Throws a
+  /// runtime_error if it exists but is not a dataset.
+  explicit DatasetWriter(const std::string& filename);
+
+  /// Closes the file.
+  ~DatasetWriter();
+
+  DatasetWriter(const DatasetWriter&) = delete;
+  DatasetWriter& operator=(const DatasetWriter&) = delete;
+
+  /// Starts a new trial; following chunks belong to it.
+  /// \return Index of the trial in the file.
+  std::uint32_t beginTrial(const std::string& name, double time);
+
+  /// Appends an already encoded image.
+  void appendFrame(
+      const std::string& stream,
+      double time,
+      const cv::Mat& image,
+      const std::string& format,
+      const std::vector<uchar>& encoded);
+
+  void appendCameraInfo(
+      const std::string& stream,
+      double time,
+      const CameraIntrinsics& intrinsics);
+
+  /// Appends a batch of trialrecord records.
+  void appendSensorRecords(double time, const char* data, std::size_t size);
+
+  void appendOutcome(double time, const std::string& label);
+
+  /// Writes the index and closes the file. Further appends are ignored.
+  void close();
+
+private:
+  /// Writes one chunk. Requires mMutex.
+  void appendChunk(
+      dataset::ChunkType type,
+      double time,
+      const void* header,
+      std::size_t headerSize,
+      const void* data,
+      std::size_t size);
+
+  std::mutex mMutex;
+  std::FILE* mFile;
+  std::uint64_t mOffset;
+  std::vector<dataset::IndexEntry> mIndex;
+  std::uint32_t mTrial;
+  std::uint32_t mNumTrials;
+};
+
+/// One encoded image in a memory-mapped dataset.
+struct DatasetFrame
+{
+  double time = 0;
+  std::string format;
+  int width = 0;
+  int height = 0;
+  int cvType = 0;
+  const uchar* data = nullptr;
+  std::size_t size = 0;
+
+  /// Decodes the image. Returns an empty matrix on failure.
+  cv::Mat decode() const;
+};
+
+/// Memory-mapped, read-only view of a dataset file.
+class DatasetReader
+{
+public:
+  /// Maps \c filename. Throws a runtime_error if it is not a dataset.
+  explicit DatasetReader(const std::string& filename);
+
+  ~DatasetReader();
+
+  DatasetReader(const DatasetReader&) = delete;
+  DatasetReader& operator=(const DatasetReader&) = delete;
+
+  std::size_t getNumTrials() const;
+
+  std::string getTrialName(std::size_t trial) const;
+
+  /// Last outcome label of \c trial, empty if none was recorded.
+  std::string getOutcome(std::size_t trial) const;
+
+  std::size_t getNumFrames(std::size_t trial, const std::string& stream) const;
+
+  /// Returns the \c index th frame of \c stream in \c trial. The data
+  /// points into the mapping and is valid as long as the reader.
+  DatasetFrame getFrame(
+      std::size_t trial, const std::string& stream, std::size_t index) const;
+
+  /// \return False if no camera info was recorded for \c stream.
+  bool getCameraIntrinsics(
+      std::size_t trial,
+      const std::string& stream,
+      CameraIntrinsics& intrinsics) const;
+
+  std::vector<FTSample> getWrenches(std::size_t trial) const;
+
+  std::vector<JointStateSample> getJointStates(std::size_t trial) const;
+
+private:
+  struct Trial
+  {
+    std::string name;
+    std::vector<std::size_t> chunks;
+  };
+
+  const dataset::ChunkHeader* getChunk(std::size_t entry) const;
+
+  const char* getPayload(std::size_t entry) const;
+
+  /// Index entries of the frames of \c stream in \c trial.
+  std::vector<std::size_t> getFrameEntries(
+      std::size_t trial, const std::string& stream) const;
+
+  const char* mData;
+  std::size_t mSize;
+  std::vector<dataset::IndexEntry> mIndex;
+  std::vector<Trial> mTrials;
+};
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef FEEDING_DEPTHCODEC_HPP_
+#define FEEDING_DEPTHCODEC_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+namespace feeding {
+
+/// Lossless codec for 16UC1 depth images.
+///
+/// Every pixel is predicted from its left, upper and upper-left neighbors
+/// (left + up - upLeft, exact on planar surfaces such as the plate and the
+/// table). The residuals are zigzag mapped and Rice coded in blocks of
+/// 64 with a per-block parameter, so flat and invalid (zero) regions cost
+/// about one bit per pixel. The prediction loops have no dependency
+/// between neighboring pixels except a prefix sum on decode, so the
+/// compiler vectorizes them.
+namespace depthcodec {
+
+/// File extension and dataset format name of encoded images.
+static const char FORMAT[] = "fdc";
+
+static const char MAGIC[4] = {'F', 'D', 'C', '1'};
+
+struct Header
+{
+  char magic[4];
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t reserved;
+};
+
+/// Number of residuals sharing a Rice parameter.
+static const std::size_t BLOCK_SIZE = 64;
+
+/// Quotients from this value on are followed by the raw residual.
+static const std::uint32_t ESCAPE = 16;
+
+} // namespace depthcodec
+
+/// Encodes a CV_16UC1 image.
+/// \param[in] image Depth image.
+/// \param[out] buffer Encoded image.
+/// \return False if \c image is not CV_16UC1.
+bool encodeDepth(const cv::Mat& image, std::vector<uchar>& buffer);
+
+/// Decodes an image written by encodeDepth.
+/// \param[in] data Encoded image.
+/// \param[in] size Size of \c data in bytes.
+/// \param[out] image Decoded CV_16UC1 image.
+/// \return False if \c data is truncated or not an encoded depth image.
+bool decodeDepth(const uchar* data, std::size_t size, cv::Mat& image);
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef FEEDING_FTSAMPLEBUFFER_HPP_
+#define FEEDING_FTSAMPLEBUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace feeding {
+
+/// A single force/torque reading.
+struct FTSample
+{
+  /// Sensor timestamp in seconds.
+  double time = 0;
+  Eigen::Vector3d force = Eigen::Vector3d::Zero();
+  Eigen::Vector3d torque = Eigen::Vector3d::Zero();
+};
+
+/// Statistics over the most recent samples of the F/T stream.
+struct FTWindowStatistics
+{
+  /// Number of samples in the window (at most the window size).
+  std::size_t numSamples = 0;
+  /// Total number of samples pushed since construction or reset.
+  std::size_t totalSamples = 0;
+  /// Timestamp of the newest sample in the window.
+  double latestTime = 0;
+  Eigen::Vector3d forceMean = Eigen::Vector3d::Zero();
+  Eigen::Vector3d forceVariance = Eigen::Vector3d::Zero();
+  Eigen::Vector3d torqueMean = Eigen::Vector3d::Zero();
+  Eigen::Vector3d torqueVariance = Eigen::Vector3d::Zero();
+  /// Largest force magnitude in the window.
+  double forcePeak = 0;
+  /// Largest torque magnitude in the window.
+  double torquePeak = 0;
+};
+
+/// Single-producer/single-consumer ring buffer for F/T samples.
+///
+/// The producer (the ROS F/T callback) calls push(), which never blocks and
+/// never allocates. If the consumer falls behind, new samples are dropped and
+/// counted instead of overwriting unread ones.
+///
+/// While pushing, the producer also maintains mean, variance and peak over a
+/// sliding window of the last samples. These are published through a
+/// sequence lock, so getStatistics() can be called from any thread at any
+/// time without ever making the producer wait.
+///
+/// pop() may only be called from a single consumer thread.
+class FTSampleBuffer
+{
+public:
+  /// Constructor.
+  /// \param[in] capacity Number of slots in the ring. Rounded up to the next
+  /// power of two.
+  /// \param[in] windowSize Number of most recent samples the statistics are
+  /// computed over.
+  explicit FTSampleBuffer(
+      std::size_t capacity = 4096, std::size_t windowSize = 50);
+
+  FTSampleBuffer(const FTSampleBuffer&) = delete;
+  FTSampleBuffer& operator=(const FTSampleBuffer&) = delete;
+
+  /// Producer side. Adds a sample and updates the window statistics.
+  /// \return False if the ring was full and the sample was only used for the
+  /// statistics.
+  bool push(const FTSample& sample);
+
+  /// Consumer side. Moves all available samples to the end of \c out.
+  /// \return Number of samples moved.
+  std::size_t pop(std::vector<FTSample>& out);
+
+  /// Consumer side. Discards all samples that have not been popped yet.
+  void discard();
+
+  /// Returns a consistent snapshot of the window statistics.
+  /// Safe to call from any thread.
+  FTWindowStatistics getStatistics() const;
+
+  /// Number of samples dropped because the ring was full.
+  std::size_t getNumDropped() const;
+
+  std::size_t getCapacity() const;
+
+  std::size_t getWindowSize() const;
+
+private:
+  // Layout of the published statistics, see publishStatistics().
+  enum StatisticsField
+  {
+    NUM_SAMPLES = 0,
+    TOTAL_SAMPLES = 1,
+    LATEST_TIME = 2,
+    FORCE_MEAN = 3,
+    FORCE_VARIANCE = 6,
+    TORQUE_MEAN = 9,
+    TORQUE_VARIANCE = 12,
+    FORCE_PEAK = 15,
+    TORQUE_PEAK = 16,
+    NUM_STATISTICS_FIELDS = 17
+  };
+
+  /// Updates the producer-side window statistics with \c sample.
+  void updateWindow(const FTSample& sample);
+
+  /// Copies the producer-side statistics into the published snapshot.
+  void publishStatistics();
+
+  const std::size_t mCapacity;
+  const std::size_t mMask;
+  std::vector<FTSample> mSlots;
+
+  // Written by the producer, read by the consumer.
+  alignas(64) std::atomic<std::size_t> mHead;
+  // Written by the consumer, read by the producer.
+  alignas(64) std::atomic<std::size_t> mTail;
+  alignas(64) std::atomic<std::size_t> mNumDropped;
+
+  // Producer-only state for the sliding window.
+  const std::size_t mWindowSize;
+  std::vector<FTSample> mWindow;
+  std::size_t mWindowCount;
+  std::size_t mTotalSamples;
+  Eigen::Vector3d mForceMean;
+  Eigen::Vector3d mForceM2;
+  Eigen::Vector3d mTorqueMean;
+  Eigen::Vector3d mTorqueM2;
+
+  // Monotonic queues (indices into the total sample count) used to track the
+  // window maxima of the force and torque magnitudes in amortized O(1).
+  std::vector<std::pair<std::size_t, double>> mForcePeakQueue;
+  std::vector<std::pair<std::size_t, double>> mTorquePeakQueue;
+  std::size_t mForcePeakBegin;
+  std::size_t mForcePeakEnd;
+  std::size_t mTorquePeakBegin;
+  std::size_t mTorquePeakEnd;
+
+  // Published statistics, guarded by mStatisticsSequence (odd while the
+  // producer is writing).
+  alignas(64) std::atomic<std::size_t> mStatisticsSequence;
+  std::array<std::atomic<double>, NUM_STATISTICS_FIELDS> mStatistics;
+};
+
+} // namespace feeding
+
+#endif
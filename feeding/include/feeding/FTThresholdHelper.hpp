@@ -6,13 +6,21 @@
 #ifdef REWD_CONTROLLERS_FOUND
 #include <rewd_controllers/FTThresholdClient.hpp>
 #endif
+#include <atomic>
 #include <mutex>
+#include <thread>
 
 #include <Eigen/Geometry>
 #include <ros/ros.h>
 
+#include "feeding/FTSampleBuffer.hpp"
+#include "feeding/ParameterSnapshot.hpp"
+#include "feeding/TrialLog.hpp"
+
 namespace feeding {
 
+class SimulatedMoveUntilTouchExecutor;
+
 enum FTThreshold
 {
   STANDARD_FT_THRESHOLD,
@@ -33,7 +41,14 @@ public:
   /// Useful if you don't use the MoveUntilTouchController and don't need to set
   /// these thresholds.
   /// \param[in] nodeHandle Handle of the ros node.
-  FTThresholdHelper(bool useThresholdControl, ros::NodeHandle nodeHandle);
+  /// \param[in] parameters Source of the threshold values. If nullptr, one
+  /// is created from nodeHandle.
+  FTThresholdHelper(
+      bool useThresholdControl,
+      ros::NodeHandle nodeHandle,
+      std::shared_ptr<ParameterSnapshot> parameters = nullptr);
+
+  ~FTThresholdHelper();
 
   /// Needs to be called before setting the first thresholds.
   /// Blocks until the threshold could be set successfully.
@@ -49,28 +64,88 @@ public:
 
   bool setThresholds(double forces, double torques);
 
+  /// Logs all following threshold changes to \c trialLog, or stops logging
+  /// if nullptr.
+  void setTrialLog(std::shared_ptr<TrialLog> trialLog);
+
+  /// Starts collecting F/T samples. Samples received before this call are
+  /// discarded.
+  /// \param[in] numberOfDataPoints Number of samples averaged by
+  /// isDataCollectionFinished().
   bool startDataCollection(int numberOfDataPoints);
+
+  /// Returns true once numberOfDataPoints samples have been collected and
+  /// writes their mean to forces and torques.
   bool isDataCollectionFinished(
       Eigen::Vector3d& forces, Eigen::Vector3d& torques);
 
+  /// Returns mean, variance and peak of the most recent F/T samples.
+  /// Never blocks the F/T callback.
+  FTWindowStatistics getWindowStatistics() const;
+
+  /// Returns every sample received since the last call to
+  /// startDataCollection(), if it was called with a positive number.
+  std::vector<FTSample> getCollectedSamples();
+
+  /// Starts keeping every F/T sample, e.g. the contact of a motion, until
+  /// stopContactCapture(). The sample buffer is drained in the background
+  /// meanwhile, so no sample is dropped however long the motion takes.
+  /// Independent of startDataCollection().
+  bool startContactCapture();
+
+  /// Stops the capture started with startContactCapture().
+  /// \return The samples received during the capture.
+  std::vector<FTSample> stopContactCapture();
+
+  /// Number of samples lost because nobody drained the sample buffer.
+  std::size_t getNumDroppedSamples() const;
+
+  /// Sets thresholds on \c controller instead of the
+  /// MoveUntilTouchController and takes its wrench readings instead of the
+  /// F/T sensor topic. Turns threshold control on, also in simulation.
+  void setSimulatedController(
+      std::shared_ptr<SimulatedMoveUntilTouchExecutor> controller);
+
+  /// Returns the controller set with setSimulatedController(), if any.
+  std::shared_ptr<SimulatedMoveUntilTouchExecutor> getSimulatedController()
+      const;
+
 private:
   bool mUseThresholdControl;
   ros::NodeHandle mNodeHandle;
+  std::shared_ptr<ParameterSnapshot> mParameters;
+  // Accessed with std::atomic_load/std::atomic_store.
+  std::shared_ptr<TrialLog> mTrialLog;
+
+  // Filled by the F/T callback, drained by the reading threads.
+  FTSampleBuffer mSampleBuffer;
 
   int mDataPointsToCollect = 0;
+  // Serializes the consumers of mSampleBuffer; never taken by the callback.
   std::mutex mDataCollectionMutex;
-  std::vector<Eigen::Vector3d> mCollectedForces;
-  std::vector<Eigen::Vector3d> mCollectedTorques;
+  std::vector<FTSample> mCollectedSamples;
+  bool mIsCapturing = false;
+  std::vector<FTSample> mCapturedSamples;
+
+  // Drains mSampleBuffer while a contact capture is running.
+  std::thread mCaptureThread;
+  std::atomic<bool> mStopCapture{false};
 
   // \brief Gets data from the force/torque sensor
   ros::Subscriber mForceTorqueDataSub;
 
+  std::shared_ptr<SimulatedMoveUntilTouchExecutor> mSimulatedController;
+
 #ifdef REWD_CONTROLLERS_FOUND
   std::unique_ptr<rewd_controllers::FTThresholdClient> mFTThresholdClient;
 #endif
 
   std::pair<double, double> getThresholdValues(FTThreshold threshold);
 
+  /// Moves the samples of mSampleBuffer to the running collection and
+  /// capture. mDataCollectionMutex must be held.
+  void drainSampleBuffer();
+
   /**
    * \brief Called whenever a new Force/Torque message arrives on the ros topic
    */
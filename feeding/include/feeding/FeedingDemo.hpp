@@ -11,7 +11,19 @@
 
 #include "feeding/AcquisitionAction.hpp"
 #include "feeding/FTThresholdHelper.hpp"
+#include "feeding/LookaheadPlanner.hpp"
+#include "feeding/ParameterSnapshot.hpp"
+#include "feeding/PlanningPortfolio.hpp"
+#include "feeding/GoalSeedCache.hpp"
+#include "feeding/Retimer.hpp"
+#include "feeding/Roadmap.hpp"
+#include "feeding/SkewerSuccessClassifier.hpp"
+#include "feeding/SkewerThresholdAdapter.hpp"
 #include "feeding/TargetItem.hpp"
+#include "feeding/TrajectoryCache.hpp"
+#include "feeding/TrajectoryDump.hpp"
+#include "feeding/TrialLog.hpp"
+#include "feeding/TrialRecorder.hpp"
 #include "feeding/Workspace.hpp"
 #include "feeding/perception/Perception.hpp"
 #include "feeding/perception/PerceptionServoClient.hpp"
@@ -41,6 +53,8 @@ public:
   /// \param[in] allowFreeRotation, If true, items specified as rotationFree
   /// get rotational freedom.
   /// \param[in] nodeHandle Handle of the ros node.
+  /// \param[in] parameters Runtime parameters. If nullptr, one is created
+  /// from nodeHandle.
   FeedingDemo(
       bool adaReal,
       std::shared_ptr<ros::NodeHandle> nodeHandle,
@@ -48,7 +62,8 @@ public:
       bool useVisualServo,
       bool allowFreeRotation,
       std::shared_ptr<FTThresholdHelper> ftThresholdHelper = nullptr,
-      bool autoContinueDemo = false);
+      bool autoContinueDemo = false,
+      std::shared_ptr<ParameterSnapshot> parameters = nullptr);
 
   /// Destructor for the Feeding Demo.
   /// Also shuts down the trajectory controllers.
@@ -89,8 +104,66 @@ public:
 
   std::shared_ptr<FTThresholdHelper> getFTThresholdHelper();
 
+  /// Gets the runtime parameters. Actions should read parameters from here
+  /// instead of the parameter server.
+  std::shared_ptr<ParameterSnapshot> getParameters();
+
+  /// Gets the classifier deciding skewering success from F/T data.
+  /// nullptr if F/T sensing is disabled.
+  std::shared_ptr<SkewerSuccessClassifier> getSkewerSuccessClassifier();
+
+  /// Gets the per-food skewering thresholds adapted from past attempts.
+  std::shared_ptr<SkewerThresholdAdapter> getSkewerThresholdAdapter();
+
+  /// Gets the recorder for raw F/T and joint state streams.
+  /// nullptr unless /trialRecorder/directory is set.
+  std::shared_ptr<TrialRecorder> getTrialRecorder();
+
+  /// Gets the directory trial records and logs are written to.
+  /// Empty unless /trialRecorder/directory is set.
+  const std::string& getTrialRecordDirectory() const;
+
+  /// Sets the log of the current trial, nullptr between trials. Motions,
+  /// perception and threshold changes are logged to it.
+  void setTrialLog(std::shared_ptr<TrialLog> trialLog);
+
+  /// Gets the log of the current trial. nullptr between trials.
+  std::shared_ptr<TrialLog> getTrialLog();
+
+  /// Gets the roadmap TSR moves are planned with.
+  /// nullptr unless /roadmap/file is set.
+  std::shared_ptr<Roadmap> getRoadmap();
+
+  /// Gets the planner chained motions are planned ahead with.
+  /// nullptr if /lookahead/enabled is false.
+  std::shared_ptr<LookaheadPlanner> getLookaheadPlanner();
+
+  /// Gets the portfolio TSR moves with looser tolerances are planned with.
+  /// nullptr if /planningPortfolio/enabled is false.
+  std::shared_ptr<PlanningPortfolio> getPlanningPortfolio();
+
+  /// Gets the cache of goal configurations TSR moves start sampling from.
+  /// nullptr if /goalSeeds/enabled is false.
+  std::shared_ptr<GoalSeedCache> getGoalSeedCache();
+
+  /// Gets the retimer planned paths are timed with.
+  /// nullptr if /retimer/enabled is false.
+  std::shared_ptr<Retimer> getRetimer();
+
+  /// Gets the cache of paths to fixed goals.
+  /// nullptr if /trajectoryCache/enabled is false.
+  std::shared_ptr<TrajectoryCache> getTrajectoryCache();
+
+  /// Gets the dump executed trajectories are appended to.
+  /// nullptr unless /trajectoryDump/file is set.
+  std::shared_ptr<TrajectoryDumpWriter> getTrajectoryDump();
+
   Eigen::Isometry3d getPlateEndEffectorTransform() const;
 
+  /// Returns true if \c foodName is in /tiltFood/names, i.e. long food
+  /// that is fed tilted.
+  bool isTiltFood(const std::string& foodName) const;
+
   // bool moveWithEndEffectorTwist(
   //   const Eigen::Vector6d& twists,
   //   double durations = 1.0,
@@ -135,8 +208,21 @@ private:
   bool mVisualServo;
   bool mAllowRotationFree;
   std::shared_ptr<ros::NodeHandle> mNodeHandle;
+  std::shared_ptr<ParameterSnapshot> mParameters;
   std::shared_ptr<Perception> mPerception;
   std::shared_ptr<FTThresholdHelper> mFTThresholdHelper;
+  std::shared_ptr<SkewerSuccessClassifier> mSkewerSuccessClassifier;
+  std::shared_ptr<SkewerThresholdAdapter> mSkewerThresholdAdapter;
+  std::shared_ptr<TrialRecorder> mTrialRecorder;
+  std::string mTrialRecordDirectory;
+  std::shared_ptr<TrialLog> mTrialLog;
+  std::shared_ptr<Roadmap> mRoadmap;
+  std::shared_ptr<GoalSeedCache> mGoalSeedCache;
+  std::shared_ptr<LookaheadPlanner> mLookaheadPlanner;
+  std::shared_ptr<PlanningPortfolio> mPlanningPortfolio;
+  std::shared_ptr<Retimer> mRetimer;
+  std::shared_ptr<TrajectoryCache> mTrajectoryCache;
+  std::shared_ptr<TrajectoryDumpWriter> mTrajectoryDump;
 
   aikido::planner::WorldPtr mWorld;
 
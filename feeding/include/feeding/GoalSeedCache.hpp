@@ -0,0 +1,135 @@
+#ifndef FEEDING_GOALSEEDCACHE_HPP_
+#define FEEDING_GOALSEEDCACHE_HPP_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <aikido/common/ExecutorThread.hpp>
+#include <aikido/common/RNG.hpp>
+#include <aikido/constraint/Sampleable.hpp>
+#include <aikido/constraint/dart/CollisionFree.hpp>
+#include <aikido/constraint/dart/TSR.hpp>
+#include <aikido/distance/ConfigurationRanker.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+#include <aikido/trajectory/Trajectory.hpp>
+#include <ros/ros.h>
+
+#include <libada/Ada.hpp>
+
+namespace feeding {
+
+/// Goal configurations the arm reached for TSRs it is sent to over and
+/// over: above the plate, above the food in each tilt style and in front of
+/// the person.
+///
+/// Seeds are binned by the TSR: its origin (position and yaw), its end
+/// effector offset, which tells the TSR families apart, and its bounds, all
+/// quantized to /goalSeeds/positionResolution and /goalSeeds/angleResolution.
+/// Seeds are tried first as inverse kinematics seeds and rank the sampled
+/// goals, so that goal sampling mostly converges on the first trial. They
+/// are persisted to a YAML file between sessions; it is written every
+/// /goalSeeds/saveInterval seconds if seeds were added, and when the cache
+/// is destroyed, never on the motion path.
+class GoalSeedCache
+{
+public:
+  /// Constructor. Loads /goalSeeds/file if it is set.
+  /// \param[in] nodeHandle Handle of the ros node.
+  explicit GoalSeedCache(ros::NodeHandle nodeHandle);
+
+  /// Destructor. Saves to /goalSeeds/file if seeds were added since the
+  /// last save.
+  ~GoalSeedCache();
+
+  /// Returns the seeds of the bin of \c tsr, most recent first.
+  std::vector<Eigen::VectorXd> getSeeds(
+      const aikido::constraint::dart::TSR& tsr) const;
+
+  /// Records that the arm reached \c tsr at \c configuration. Keeps the
+  /// /goalSeeds/maxSeedsPerBin most recent seeds of each bin. Does not
+  /// write the file; the background save does.
+  void addSeed(
+      const aikido::constraint::dart::TSR& tsr,
+      const Eigen::VectorXd& configuration);
+
+  /// Returns a ranker that prefers goals close to the most recent seed of
+  /// \c tsr, or close to the current configuration if there is none.
+  aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::constraint::dart::TSR& tsr) const;
+
+  /// Returns inverse kinematics seeds that start with the seeds of \c tsr
+  /// and continue with uniform samples within the joint limits.
+  aikido::constraint::SampleablePtr createSeedSampleable(
+      const aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr& space,
+      const aikido::constraint::dart::TSR& tsr,
+      std::unique_ptr<aikido::common::RNG> rng) const;
+
+  /// Plans the arm to \c tsr like Ada::planArmToTSR, but samples the goals
+  /// with the seeds of \c tsr as inverse kinematics seeds.
+  /// \param[in] ada Ada whose arm is planned.
+  /// \param[in] tsr Goal of the arm.
+  /// \param[in] collisionFree Constraint the path and goals satisfy.
+  /// \param[in] timelimit Planning time per goal, in seconds.
+  /// \param[in] maxNumTrials Number of goals sampled.
+  /// \param[in] ranker Order in which the goals are planned to.
+  /// \return Path to the first goal that was reached, nullptr if none.
+  aikido::trajectory::TrajectoryPtr planToTSR(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::constraint::dart::TSR& tsr,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+      double timelimit,
+      int maxNumTrials,
+      const aikido::distance::ConfigurationRankerPtr& ranker) const;
+
+  /// Plans with planToTSR() and executes the path with Kunz.
+  /// \return True if the arm reached \c tsr.
+  bool moveArmToTSR(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::constraint::dart::TSR& tsr,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+      double timelimit,
+      int maxNumTrials,
+      const aikido::distance::ConfigurationRankerPtr& ranker,
+      const std::vector<double>& velocityLimits) const;
+
+  /// Loads seeds from \c filename, adding them to the current ones.
+  /// \return False if the file does not exist or cannot be parsed.
+  bool load(const std::string& filename);
+
+  /// Saves the seeds to \c filename.
+  /// \return False if the file cannot be written.
+  bool save(const std::string& filename) const;
+
+  /// Saves to the file configured in /goalSeeds/file, if any.
+  bool save() const;
+
+  /// Saves to /goalSeeds/file if seeds were added since the last save.
+  void saveIfModified();
+
+private:
+  std::string getKey(const aikido::constraint::dart::TSR& tsr) const;
+
+  std::string mFilename;
+  double mPositionResolution;
+  double mAngleResolution;
+  std::size_t mMaxSeedsPerBin;
+
+  mutable std::mutex mMutex;
+  std::map<std::string, std::deque<Eigen::VectorXd>> mSeeds;
+  /// True if seeds were added since the last save.
+  bool mIsModified;
+
+  /// Calls saveIfModified() every /goalSeeds/saveInterval, if
+  /// /goalSeeds/file is set.
+  std::unique_ptr<aikido::common::ExecutorThread> mSaveThread;
+};
+
+} // namespace feeding
+
+#endif
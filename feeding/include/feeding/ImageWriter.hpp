@@ -0,0 +1,153 @@
+#ifndef FEEDING_IMAGEWRITER_HPP_
+#define FEEDING_IMAGEWRITER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cv_bridge/cv_bridge.h>
+
+namespace feeding {
+
+/// How the images of one stream are encoded.
+struct ImageStreamConfig
+{
+  /// File extension understood by cv::imencode, e.g. "png", "jpg", "tiff",
+  /// or depthcodec::FORMAT for 16UC1 depth images.
+  std::string format = "png";
+  /// PNG compression level (0-9) or JPEG quality (0-100). Negative uses the
+  /// OpenCV default.
+  int compression = -1;
+};
+
+/// Counters of one stream.
+struct ImageWriterStatistics
+{
+  std::size_t numQueued = 0;
+  std::size_t numWritten = 0;
+  /// Images refused because the queue was full.
+  std::size_t numRejected = 0;
+  /// Images that could not be encoded or written.
+  std::size_t numFailed = 0;
+  /// Largest number of images waiting at once.
+  std::size_t maxQueueDepth = 0;
+  /// Time to encode and write one image.
+  std::chrono::duration<double, std::milli> meanEncodeTime{0};
+  std::chrono::duration<double, std::milli> maxEncodeTime{0};
+};
+
+/// Encodes and writes images on a pool of background threads.
+///
+/// The queue is bounded. tryWrite() never blocks and refuses images while
+/// the queue is full, so ROS image callbacks can hand frames over without
+/// ever waiting on the disk; write() blocks until there is room instead.
+class ImageWriter
+{
+public:
+  /// Receives encoded images in place of the file system.
+  /// Returns false if the image could not be stored.
+  using Sink = std::function<bool(
+      const std::string& stream,
+      const cv_bridge::CvImage& image,
+      const std::string& format,
+      const std::vector<uchar>& encoded)>;
+
+  /// Constructor.
+  /// \param[in] numThreads Number of encoding threads.
+  /// \param[in] maxQueueSize Number of images that may wait for a thread.
+  explicit ImageWriter(
+      std::size_t numThreads = 2, std::size_t maxQueueSize = 8);
+
+  /// Writes all queued images and stops the threads.
+  ~ImageWriter();
+
+  ImageWriter(const ImageWriter&) = delete;
+  ImageWriter& operator=(const ImageWriter&) = delete;
+
+  /// Sets how images of \c stream are encoded. Streams without a config
+  /// use the ImageStreamConfig defaults.
+  void setStreamConfig(
+      const std::string& stream, const ImageStreamConfig& config);
+
+  /// Hands encoded images to \c sink instead of writing files. Applies to
+  /// images queued afterwards; nullptr goes back to files.
+  void setSink(Sink sink);
+
+  /// Returns the file extension used for \c stream, including the dot.
+  std::string getExtension(const std::string& stream) const;
+
+  /// Queues \c image to be written to \c filename plus the stream's
+  /// extension. \c image is kept alive until it is written, so it may share
+  /// the data of the ROS message.
+  /// \return False if the queue is full. Never blocks.
+  bool tryWrite(
+      const std::string& stream,
+      const std::string& filename,
+      cv_bridge::CvImageConstPtr image);
+
+  /// Like tryWrite(), but waits for room in the queue. Drops the image if
+  /// the writer is being destroyed.
+  void write(
+      const std::string& stream,
+      const std::string& filename,
+      cv_bridge::CvImageConstPtr image);
+
+  /// Blocks until every queued image has been written.
+  void flush();
+
+  /// Number of images queued or being encoded.
+  std::size_t getQueueDepth() const;
+
+  /// Number of images tryWrite() would accept right now.
+  std::size_t getNumFreeSlots() const;
+
+  ImageWriterStatistics getStatistics(const std::string& stream) const;
+
+private:
+  struct Job
+  {
+    std::string stream;
+    std::string filename;
+    ImageStreamConfig config;
+    cv_bridge::CvImageConstPtr image;
+    Sink sink;
+  };
+
+  /// Adds a job. Requires mMutex.
+  void enqueue(
+      const std::string& stream,
+      const std::string& filename,
+      cv_bridge::CvImageConstPtr image);
+
+  void workerLoop();
+
+  /// Encodes and writes one image.
+  /// \return False on failure.
+  bool encodeAndWrite(const Job& job) const;
+
+  const std::size_t mMaxQueueSize;
+
+  mutable std::mutex mMutex;
+  std::condition_variable mJobAvailable;
+  std::condition_variable mSpaceAvailable;
+  std::condition_variable mIdle;
+  std::deque<Job> mQueue;
+  std::size_t mNumInProgress;
+  bool mStop;
+
+  std::map<std::string, ImageStreamConfig> mStreamConfigs;
+  Sink mSink;
+  std::map<std::string, ImageWriterStatistics> mStatistics;
+
+  std::vector<std::thread> mWorkers;
+};
+
+} // namespace feeding
+
+#endif
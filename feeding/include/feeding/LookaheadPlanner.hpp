@@ -0,0 +1,89 @@
+#ifndef FEEDING_LOOKAHEADPLANNER_HPP_
+#define FEEDING_LOOKAHEADPLANNER_HPP_
+
+#include <future>
+#include <memory>
+
+#include <Eigen/Core>
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+#include <aikido/trajectory/Trajectory.hpp>
+#include <dart/dart.hpp>
+#include <ros/ros.h>
+
+#include <libada/Ada.hpp>
+
+namespace feeding {
+
+/// Plans end effector offsets in the background from where the arm will
+/// be, so that chained motions start without waiting for their planner.
+///
+/// A plan is started from a predicted configuration, e.g. the end of the
+/// trajectory currently executing, and is only used if the arm actually
+/// ends up within /lookahead/startTolerance of it. Planning runs on a copy
+/// of the robot, so the executor and joint state updates are not held up,
+/// and only the self collision check of the path locks the robot, like
+/// offsets planned without a collision constraint.
+class LookaheadPlanner
+{
+public:
+  /// Constructor.
+  /// \param[in] ada The robot to plan for.
+  /// \param[in] nodeHandle Handle of the ros node.
+  LookaheadPlanner(std::shared_ptr<ada::Ada> ada, ros::NodeHandle nodeHandle);
+
+  /// Waits for the pending plan.
+  ~LookaheadPlanner();
+
+  /// Starts planning a straight end effector motion from \c start,
+  /// replacing the pending plan.
+  /// \param[in] start Configuration of the arm the motion starts at.
+  /// \param[in] direction Direction of the motion.
+  /// \param[in] length Length of the motion, in m.
+  void planEndEffectorOffset(
+      const Eigen::VectorXd& start,
+      const Eigen::Vector3d& direction,
+      double length,
+      double planningTimeout,
+      double endEffectorOffsetPositionTolerance,
+      double endEffectorOffsetAngularTolerance);
+
+  /// Returns the configuration of the arm, read under the skeleton lock.
+  Eigen::VectorXd getCurrentConfiguration() const;
+
+  /// Returns true if the pending plan starts at the current configuration
+  /// of the arm. Does not wait for the plan.
+  bool startsAtCurrentConfiguration() const;
+
+  /// Waits for the pending plan and returns its untimed path, or nullptr if
+  /// planning failed or the path does not start at the current
+  /// configuration of the arm.
+  aikido::trajectory::TrajectoryPtr getPath();
+
+  /// Returns the configuration of the arm at the end of \c path.
+  Eigen::VectorXd getEndConfiguration(
+      const aikido::trajectory::Trajectory& path) const;
+
+private:
+  /// Converts \c path planned on the copy to the arm of the robot, or
+  /// returns nullptr if it is in self collision there.
+  aikido::trajectory::TrajectoryPtr convertPath(
+      const aikido::trajectory::Trajectory& path) const;
+
+  const std::shared_ptr<ada::Ada> mAda;
+  double mStartTolerance;
+  double mCollisionCheckResolution;
+
+  /// Copy of the robot the plans run on.
+  dart::dynamics::SkeletonPtr mSkeleton;
+  dart::dynamics::MetaSkeletonPtr mArm;
+  aikido::statespace::dart::MetaSkeletonStateSpacePtr mArmSpace;
+  dart::dynamics::BodyNodePtr mEndEffector;
+
+  /// Start of the pending plan.
+  Eigen::VectorXd mStart;
+  std::future<aikido::trajectory::TrajectoryPtr> mPlan;
+};
+
+} // namespace feeding
+
+#endif
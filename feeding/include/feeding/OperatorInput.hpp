@@ -0,0 +1,88 @@
+#ifndef FEEDING_OPERATORINPUT_HPP_
+#define FEEDING_OPERATORINPUT_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "feeding/TopicInput.hpp"
+
+namespace feeding {
+
+/// Answers the questions the demo asks the operator, such as which option
+/// to take or whether to continue.
+class OperatorInput
+{
+public:
+  virtual ~OperatorInput() = default;
+
+  /// Returns the answer to \c prompt, or "" if there is none.
+  virtual std::string ask(const std::string& prompt) = 0;
+};
+
+/// Reads the answers from the console, one line each.
+class TtyOperatorInput : public OperatorInput
+{
+public:
+  std::string ask(const std::string& prompt) override;
+};
+
+/// Publishes the prompts on /operatorInput/promptTopic and takes the answers
+/// from /operatorInput/answerTopic, e.g. for a remote console.
+class TopicOperatorInput : public OperatorInput
+{
+public:
+  /// Constructor. Subscribes to the answers.
+  /// \param[in] nodeHandle Handle of the ros node.
+  explicit TopicOperatorInput(ros::NodeHandle nodeHandle);
+
+  /// Waits up to /operatorInput/timeout seconds for the answer, or forever
+  /// if it is not positive.
+  std::string ask(const std::string& prompt) override;
+
+private:
+  ros::Publisher mPromptPub;
+  TopicInput mAnswers;
+  double mTimeout;
+};
+
+/// Gives the answers listed in a yaml file, so that the demo can run with
+/// no one at the console. Each entry is a map with
+/// - answer: The answer.
+/// - prompt: Optional text the prompt has to contain.
+/// - delay: Optional seconds to wait before answering.
+/// - repeat: Optional, if true the entry is kept to answer later prompts.
+/// Each prompt is answered by the first remaining entry that matches it.
+class ScriptedOperatorInput : public OperatorInput
+{
+public:
+  /// Constructor. Loads the answers from \c filename.
+  /// \param[in] filename Yaml file with a list of answers.
+  /// \param[in] defaultAnswer Answer when no entry matches a prompt.
+  ScriptedOperatorInput(
+      const std::string& filename, const std::string& defaultAnswer = "");
+
+  std::string ask(const std::string& prompt) override;
+
+private:
+  struct Entry
+  {
+    std::string prompt;
+    std::string answer;
+    double delay;
+    bool repeat;
+  };
+
+  std::vector<Entry> mEntries;
+  std::string mDefaultAnswer;
+};
+
+/// Creates the input selected by /operatorInput/backend, which is "tty",
+/// "topic" or "script". The script is read from /operatorInput/scriptFile.
+std::unique_ptr<OperatorInput> createOperatorInput(ros::NodeHandle nodeHandle);
+
+} // namespace feeding
+
+#endif
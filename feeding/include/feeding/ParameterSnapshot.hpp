@@ -0,0 +1,90 @@
+#ifndef FEEDING_PARAMETERSNAPSHOT_HPP_
+#define FEEDING_PARAMETERSNAPSHOT_HPP_
+
+#include <memory>
+#include <string>
+
+#include <Eigen/Core>
+#include <ros/ros.h>
+#include <std_msgs/Empty.h>
+
+namespace feeding {
+
+/// Force and torque limits of one F/T threshold.
+struct FTThresholdValues
+{
+  double force = 0;
+  double torque = 0;
+};
+
+/// Parameters read by the actions while the demo is running.
+/// Everything here is read once from the parameter server so that no action
+/// step has to wait for an XML-RPC round trip.
+struct FeedingParameters
+{
+  // /humanStudy
+  bool autoAcquisition = true;
+  bool autoTiming = true;
+  bool autoTransfer = true;
+  bool createError = false;
+  std::string actionTopic = "/study_action_msgs";
+  std::string foodTopic = "/study_food_msgs";
+
+  // /topicInput
+  double topicInputMaxAge = 5.0;
+
+  // /study
+  Eigen::Vector3d tiltOffset = Eigen::Vector3d::Zero();
+
+  // /feedingDemo
+  double fixedFaceY = 0;
+
+  // /lookahead
+  double approachReplanDistance = 0.01;
+
+  // /ftSensor/thresholds
+  FTThresholdValues standardThreshold;
+  FTThresholdValues grabFoodThreshold;
+  FTThresholdValues afterGrabFoodThreshold;
+  FTThresholdValues pushFoodThreshold;
+};
+
+/// Holds the current FeedingParameters.
+///
+/// Readers get an immutable snapshot and never block. Publishing anything
+/// on /parameterSnapshot/updateTopic re-reads the parameter server and
+/// swaps the snapshot atomically, like a dynamic_reconfigure callback.
+class ParameterSnapshot
+{
+public:
+  /// Constructor. Reads all parameters and throws a runtime_error if one
+  /// of the required F/T thresholds is missing.
+  /// \param[in] nodeHandle Handle of the ros node.
+  explicit ParameterSnapshot(ros::NodeHandle nodeHandle);
+
+  /// Returns the current parameters. The returned snapshot stays valid
+  /// and unchanged across reloads.
+  std::shared_ptr<const FeedingParameters> get() const;
+
+  /// Re-reads the parameter server. Keeps the previous snapshot if a
+  /// required parameter is missing.
+  /// \return True if the snapshot was replaced.
+  bool reload();
+
+private:
+  /// Reads all parameters. Throws a runtime_error if a required one is
+  /// missing or malformed.
+  std::shared_ptr<const FeedingParameters> read() const;
+
+  void updateCallback(const std_msgs::Empty::ConstPtr& msg);
+
+  ros::NodeHandle mNodeHandle;
+  ros::Subscriber mUpdateSub;
+
+  // Only accessed through std::atomic_load and std::atomic_store.
+  std::shared_ptr<const FeedingParameters> mParameters;
+};
+
+} // namespace feeding
+
+#endif
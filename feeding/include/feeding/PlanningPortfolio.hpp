@@ -0,0 +1,105 @@
+#ifndef FEEDING_PLANNINGPORTFOLIO_HPP_
+#define FEEDING_PLANNINGPORTFOLIO_HPP_
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <aikido/constraint/Testable.hpp>
+#include <aikido/constraint/dart/CollisionFree.hpp>
+#include <aikido/constraint/dart/TSR.hpp>
+#include <aikido/trajectory/Trajectory.hpp>
+#include <dart/dart.hpp>
+#include <ros/ros.h>
+
+#include <libada/Ada.hpp>
+
+namespace feeding {
+
+/// Plans to several TSRs at once, each on its own copy of the robot.
+///
+/// Used for retrying with looser tolerances: instead of planning to the
+/// next TSR only after the previous one failed, all of them are planned
+/// concurrently and the first TSR whose planner succeeded is taken, so the
+/// worst case takes one planning timeout instead of one per TSR.
+///
+/// Each copy has its own skeleton, state space and collision detector and
+/// mirrors one collision constraint of the demo: the arm against a fixed
+/// set of workspace skeletons, which nothing moves during planning. Paths
+/// are converted back to the arm of the robot and checked there with the
+/// full constraint of the robot, including self collision, before they
+/// are returned.
+class PlanningPortfolio
+{
+public:
+  /// Constructor.
+  /// \param[in] ada The robot to copy.
+  /// \param[in] collisionFree The constraint the copies mirror.
+  /// \param[in] environment The skeletons \c collisionFree checks the arm
+  /// against.
+  /// \param[in] nodeHandle Handle of the ros node.
+  PlanningPortfolio(
+      std::shared_ptr<ada::Ada> ada,
+      aikido::constraint::dart::CollisionFreePtr collisionFree,
+      std::vector<dart::dynamics::ConstSkeletonPtr> environment,
+      ros::NodeHandle nodeHandle);
+
+  /// Waits for planners still running on the copies.
+  ~PlanningPortfolio();
+
+  /// Returns the constraint the copies mirror. Only plans with this
+  /// constraint can be run on the portfolio.
+  aikido::constraint::dart::CollisionFreePtr getCollisionConstraint() const;
+
+  /// Plans from the current configuration of the arm, or from \c start if
+  /// it is not empty, to every TSR in \c tsrs concurrently.
+  /// \param[in] tsrs TSRs in order of preference, e.g. tightest first. At
+  /// most /planningPortfolio/numCopies are planned to.
+  /// \param[in] timelimit Timeout of each planner.
+  /// \param[in] start Configuration of the arm the paths start at, e.g.
+  /// the end of the trajectory executing meanwhile.
+  /// \return Index of the first TSR that was reached with its untimed path,
+  /// or the number of TSRs planned to and nullptr if none was reached.
+  std::pair<std::size_t, aikido::trajectory::TrajectoryPtr> plan(
+      const std::vector<aikido::constraint::dart::TSR>& tsrs,
+      double timelimit,
+      int maxNumTrials,
+      const Eigen::VectorXd& start = Eigen::VectorXd());
+
+private:
+  /// Copy of the robot planned on by one thread.
+  struct Copy
+  {
+    dart::dynamics::SkeletonPtr mSkeleton;
+    dart::dynamics::MetaSkeletonPtr mArm;
+    aikido::statespace::dart::MetaSkeletonStateSpacePtr mArmSpace;
+    dart::dynamics::BodyNodePtr mEndEffector;
+    aikido::constraint::TestablePtr mConstraint;
+    /// Planner still running on the copy.
+    std::future<aikido::trajectory::TrajectoryPtr> mPlan;
+  };
+
+  /// Creates the copies if needed and sets them to the current
+  /// configuration of the robot.
+  void updateCopies(std::size_t numCopies);
+
+  /// Converts \c path planned on \c copy to the arm of the robot, or
+  /// returns nullptr if it is in collision there.
+  aikido::trajectory::TrajectoryPtr convertPath(
+      const Copy& copy, const aikido::trajectory::Trajectory& path) const;
+
+  const std::shared_ptr<ada::Ada> mAda;
+  const aikido::constraint::dart::CollisionFreePtr mCollisionFree;
+  const std::vector<dart::dynamics::ConstSkeletonPtr> mEnvironment;
+  std::size_t mMaxNumCopies;
+  double mCollisionCheckResolution;
+
+  std::mutex mMutex;
+  std::vector<std::unique_ptr<Copy>> mCopies;
+};
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef FEEDING_RETIMER_HPP_
+#define FEEDING_RETIMER_HPP_
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <aikido/constraint/dart/CollisionFree.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
+#include <aikido/trajectory/Spline.hpp>
+#include <aikido/trajectory/Trajectory.hpp>
+#include <ros/ros.h>
+
+#include <libada/Ada.hpp>
+
+#include "feeding/TrajectoryDump.hpp"
+
+namespace feeding {
+
+/// Largest deviation of Kunz trajectories from the corners of their path,
+/// in rad.
+static const double KUNZ_MAX_DEVIATION = 1e-2;
+/// Time step of the Kunz retimer, in s.
+static const double KUNZ_TIME_STEP = 3e-3;
+/// Coarser time step of the Kunz retimer, in s, for long paths.
+static const double KUNZ_COARSE_TIME_STEP = 9e-3;
+
+/// Times planned paths with whichever retimer gives the shortest
+/// trajectory within the velocity and acceleration limits.
+///
+/// The options are the parabolic retimer and the Kunz retimer with each
+/// (maxDeviation, timeStep) pair of /retimer/kunzSettings. The first path
+/// of each motion, e.g. "moveAbove", is timed with every option and the
+/// fastest one within the limits is kept for the following paths of the
+/// motion. All options are compared again every /retimer/reevaluateEvery
+/// paths, since the paths of a motion change with the scene. Retimers may
+/// cut the corners of a path, so moveArm() checks the timed trajectory for
+/// collisions and moves on to the next fastest option if it collides.
+class Retimer
+{
+public:
+  struct Option
+  {
+    std::string name;
+    /// Kunz retimer if true, parabolic retimer otherwise.
+    bool kunz;
+    double maxDeviation;
+    double timeStep;
+  };
+
+  struct Result
+  {
+    /// Index of the option.
+    std::size_t option;
+    /// nullptr if the retimer failed.
+    aikido::trajectory::UniqueSplinePtr trajectory;
+    double duration;
+    /// Seconds spent retiming.
+    double computeTime;
+    bool isWithinLimits;
+  };
+
+  /// Returns the parabolic retimer and the Kunz retimer with the settings
+  /// used so far in the demo.
+  static std::vector<Option> getDefaultOptions();
+
+  /// Constructor.
+  /// \param[in] nodeHandle Handle of the ros node.
+  explicit Retimer(ros::NodeHandle nodeHandle);
+
+  /// Constructor, e.g. for benchmarks.
+  /// \param[in] options Options to choose from.
+  /// \param[in] limitTolerance Relative tolerance of the limit check.
+  /// \param[in] reevaluateEvery Paths of a motion between comparisons.
+  Retimer(
+      std::vector<Option> options,
+      double limitTolerance = 0.05,
+      int reevaluateEvery = 20);
+
+  const std::vector<Option>& getOptions() const;
+
+  /// Times \c path with every option.
+  std::vector<Result> compare(
+      const aikido::trajectory::Interpolated& path,
+      const Eigen::VectorXd& velocityLimits,
+      const Eigen::VectorXd& accelerationLimits) const;
+
+  /// Times \c path with the option chosen for \c motion, comparing all of
+  /// them if none is chosen yet or it is time to reevaluate.
+  /// \param[in] isValid If set, trajectories it rejects are not used.
+  /// \return nullptr if no option could time the path within the limits.
+  aikido::trajectory::UniqueSplinePtr retime(
+      const std::string& motion,
+      const aikido::trajectory::Interpolated& path,
+      const Eigen::VectorXd& velocityLimits,
+      const Eigen::VectorXd& accelerationLimits,
+      const std::function<bool(const aikido::trajectory::Spline&)>& isValid
+      = nullptr);
+
+  /// Like ada::Ada::moveArmOnTrajectory, but times \c path with retime(),
+  /// rejecting trajectories that violate \c collisionFree. Paths that are
+  /// not interpolated are passed on to moveArmOnTrajectory.
+  /// \param[in] velocityLimits Velocity limits of the arm, its own if
+  /// empty.
+  /// \param[in] dump Dump the trajectory is appended to, if any.
+  /// \return False if the path could not be timed or execution failed.
+  bool moveArm(
+      const std::shared_ptr<ada::Ada>& ada,
+      const std::string& motion,
+      const aikido::trajectory::TrajectoryPtr& path,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+      const std::vector<double>& velocityLimits,
+      const std::shared_ptr<TrajectoryDumpWriter>& dump = nullptr);
+
+  /// Returns the index of the option chosen for \c motion, or the number
+  /// of options if none is chosen.
+  std::size_t getChoice(const std::string& motion) const;
+
+private:
+  struct Choice
+  {
+    std::size_t option;
+    int numUses;
+  };
+
+  /// Returns true if the velocities and accelerations of \c trajectory are
+  /// within the limits.
+  bool isWithinLimits(
+      const aikido::trajectory::Spline& trajectory,
+      const Eigen::VectorXd& velocityLimits,
+      const Eigen::VectorXd& accelerationLimits) const;
+
+  /// Returns true if \c trajectory satisfies \c collisionFree, checked
+  /// every /retimer/collisionCheckResolution of joint motion.
+  bool isCollisionFree(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::trajectory::Spline& trajectory,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+      const Eigen::VectorXd& velocityLimits) const;
+
+  /// Times \c path with \c option. Returns nullptr if the retimer failed.
+  aikido::trajectory::UniqueSplinePtr retime(
+      const Option& option,
+      const aikido::trajectory::Interpolated& path,
+      const Eigen::VectorXd& velocityLimits,
+      const Eigen::VectorXd& accelerationLimits) const;
+
+  std::vector<Option> mOptions;
+  double mLimitTolerance;
+  int mReevaluateEvery;
+  double mCollisionCheckResolution;
+
+  mutable std::mutex mMutex;
+  std::map<std::string, Choice> mChoices;
+};
+
+} // namespace feeding
+
+#endif
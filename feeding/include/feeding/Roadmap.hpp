@@ -0,0 +1,155 @@
+#ifndef FEEDING_ROADMAP_HPP_
+#define FEEDING_ROADMAP_HPP_
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+#include <aikido/constraint/dart/CollisionFree.hpp>
+#include <aikido/constraint/dart/TSR.hpp>
+#include <aikido/distance/ConfigurationRanker.hpp>
+#include <aikido/trajectory/Trajectory.hpp>
+#include <ros/ros.h>
+
+#include <libada/Ada.hpp>
+
+#include "feeding/GoalSeedCache.hpp"
+
+namespace feeding {
+
+/// Probabilistic roadmap of the arm's configuration space in the static
+/// feeding workspace.
+///
+/// The roadmap is built offline (demo type "buildRoadmap") against the
+/// workspace collision constraint and saved to /roadmap/file, which is
+/// loaded at startup. A query samples a few goal configurations, connects
+/// them and the start configuration to their nearest roadmap nodes and
+/// searches the graph. Roadmap edges on the found path are checked again
+/// against the collision constraint of the query, which may contain more
+/// than the static workspace; edges in collision are skipped and the
+/// search is repeated. Paths are shortcut before they are returned.
+///
+/// Joints without position limits are treated as cyclic, like the SO2
+/// subspaces of the arm's state space.
+class Roadmap
+{
+public:
+  /// Constructor. Loads /roadmap/file if it exists.
+  /// \param[in] numDofs Number of degrees of freedom of the arm; roadmaps
+  /// of another dimension are not loaded.
+  /// \param[in] nodeHandle Handle of the ros node.
+  Roadmap(std::size_t numDofs, ros::NodeHandle nodeHandle);
+
+  /// Returns true if the roadmap has no nodes.
+  bool isEmpty() const;
+
+  /// Sets the cache whose seeds goal sampling starts from, none if nullptr.
+  void setGoalSeedCache(std::shared_ptr<GoalSeedCache> goalSeeds);
+
+  /// Samples /roadmap/numNodes collision free configurations of the arm
+  /// and connects each to its /roadmap/numNeighbors nearest nodes,
+  /// replacing the current roadmap.
+  void build(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree);
+
+  /// Plans a path from the current configuration of the arm to \c tsr.
+  /// Goals are sampled with /roadmap/maxNumGoalTrials inverse kinematics
+  /// trials, independent of the trials of the planners.
+  /// \return Untimed path, or nullptr if the roadmap could not connect the
+  /// start to any goal.
+  aikido::trajectory::TrajectoryPtr planToTSR(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::constraint::dart::TSR& tsr,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree) const;
+
+  /// Like ada::Ada::moveArmToTSR, but plans with the roadmap first and
+  /// only falls back to planning from scratch if the roadmap fails.
+  /// \param[in] maxNumTrials Trials of the planner the roadmap falls back
+  /// to.
+  bool moveArmToTSR(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::constraint::dart::TSR& tsr,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+      double planningTimeout,
+      int maxNumTrials,
+      const aikido::distance::ConfigurationRankerPtr& ranker,
+      const std::vector<double>& velocityLimits) const;
+
+  /// Loads the roadmap from \c filename.
+  /// \return False if the file does not exist, is not a roadmap of the arm
+  /// or is corrupt.
+  bool load(const std::string& filename);
+
+  /// Saves the roadmap to \c filename.
+  /// \return False if the file cannot be written.
+  bool save(const std::string& filename) const;
+
+  /// Saves to the file configured in /roadmap/file, if any.
+  bool save() const;
+
+private:
+  using Edge = std::pair<std::uint32_t, std::uint32_t>;
+
+  /// Returns the shortest motion from \c from to \c to, which wraps around
+  /// for cyclic joints.
+  Eigen::VectorXd getDifference(
+      const Eigen::VectorXd& from, const Eigen::VectorXd& to) const;
+
+  double getDistance(const Eigen::VectorXd& from, const Eigen::VectorXd& to)
+      const;
+
+  /// Returns the indices of the \c numNeighbors nodes closest to
+  /// \c positions, closest first.
+  std::vector<std::size_t> getNearestNodes(
+      const Eigen::VectorXd& positions, std::size_t numNeighbors) const;
+
+  /// Returns true if the straight motion from \c from to \c to satisfies
+  /// \c collisionFree. Requires the skeleton mutex.
+  bool isMotionCollisionFree(
+      const std::shared_ptr<ada::Ada>& ada,
+      const Eigen::VectorXd& from,
+      const Eigen::VectorXd& to,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree)
+      const;
+
+  /// Samples up to /roadmap/numGoals collision free configurations in
+  /// \c tsr in at most /roadmap/maxNumGoalTrials trials, seeding inverse
+  /// kinematics with the goal seeds first. Requires the skeleton mutex.
+  std::vector<Eigen::VectorXd> sampleGoals(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::constraint::dart::TSR& tsr,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree) const;
+
+  /// Rebuilds mAdjacency from mEdges.
+  void updateAdjacency();
+
+  std::string mFilename;
+  std::size_t mNumDofs;
+  std::size_t mNumNodes;
+  std::size_t mNumNeighbors;
+  std::size_t mNumGoals;
+  int mMaxNumGoalTrials;
+  std::size_t mMaxNumSearches;
+  double mCollisionCheckResolution;
+  unsigned int mSeed;
+  /// Seeds goal sampling, so that queries draw different goals. Guarded by
+  /// the skeleton mutex, like sampleGoals().
+  mutable std::mt19937 mGoalRandom;
+  std::shared_ptr<GoalSeedCache> mGoalSeeds;
+
+  /// Whether each joint wraps around.
+  std::vector<bool> mIsCyclic;
+  std::vector<Eigen::VectorXd> mNodes;
+  std::vector<Edge> mEdges;
+  /// Neighbors and edge indices of every node.
+  std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>>
+      mAdjacency;
+};
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef FEEDING_SIMULATEDCONTACTMODEL_HPP_
+#define FEEDING_SIMULATEDCONTACTMODEL_HPP_
+
+#include <random>
+
+#include <Eigen/Geometry>
+#include <ros/ros.h>
+
+#include "feeding/FTSampleBuffer.hpp"
+
+namespace feeding {
+
+/// Force/torque readings of the forque when its tip touches the plate or
+/// the food on it, for running contact motions without the robot.
+///
+/// The plate is a disk of /simulatedContact/plateRadius whose surface lies
+/// /simulatedContact/plateHeight above the plate pose, covered by a layer of
+/// food /simulatedContact/foodHeight thick. Pushing into the food builds up
+/// force like a spring until /simulatedContact/piercingForce is reached;
+/// then the fork breaks through and only /simulatedContact/foodFriction is
+/// left. Below the food the plate pushes back with a much stiffer spring.
+/// The contact force points up and acts at the tip, so the sensor behind it
+/// also measures a torque.
+class SimulatedContactModel
+{
+public:
+  /// Constructor.
+  /// \param[in] platePose Pose of the plate in the world.
+  /// \param[in] nodeHandle Handle of the ros node.
+  SimulatedContactModel(
+      const Eigen::Isometry3d& platePose, ros::NodeHandle nodeHandle);
+
+  /// Returns the reading of the sensor when the end effector, i.e. the fork
+  /// tip, is at \c endEffectorPose. Tracks whether the food is pierced, so
+  /// it has to be called along the motion.
+  FTSample getWrench(const Eigen::Isometry3d& endEffectorPose);
+
+private:
+  Eigen::Vector3d mPlateCenter;
+  double mPlateRadius;
+  double mPlateStiffness;
+  double mFoodHeight;
+  double mFoodStiffness;
+  double mPiercingForce;
+  double mFoodFriction;
+  /// Position of the fork tip relative to the sensor, in the end effector
+  /// frame.
+  Eigen::Vector3d mSensorToTip;
+  double mForceNoise;
+  double mTorqueNoise;
+
+  bool mIsPierced;
+  std::mt19937 mRandom;
+  std::normal_distribution<double> mNoise;
+};
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef FEEDING_SIMULATEDMOVEUNTILTOUCHEXECUTOR_HPP_
+#define FEEDING_SIMULATEDMOVEUNTILTOUCHEXECUTOR_HPP_
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include <aikido/common/ExecutorThread.hpp>
+#include <aikido/control/TrajectoryExecutor.hpp>
+#include <aikido/trajectory/Trajectory.hpp>
+#include <dart/dart.hpp>
+#include <ros/ros.h>
+
+#include "feeding/FTSampleBuffer.hpp"
+#include "feeding/SimulatedContactModel.hpp"
+
+namespace feeding {
+
+/// Stand-in for the move_until_touch_topic_controller when running without
+/// the robot.
+///
+/// Plays trajectories on the arm in the aikido world, advancing
+/// /simulatedContact/timeScale trajectory seconds per second, so contact
+/// motions can also run faster than real time. Every
+/// /simulatedContact/stepPeriod it reads the wrench at the end effector
+/// from a SimulatedContactModel and, like the real controller, stops the
+/// trajectory as soon as the force or torque exceeds the thresholds. The
+/// thresholds are set through FTThresholdHelper, which also receives the
+/// wrench readings in place of the F/T sensor topic.
+class SimulatedMoveUntilTouchExecutor
+  : public aikido::control::TrajectoryExecutor
+{
+public:
+  /// Constructor.
+  /// \param[in] metaSkeleton Arm the trajectories are played on.
+  /// \param[in] endEffector Body node at the fork tip.
+  /// \param[in] contactModel Model the wrench readings come from.
+  /// \param[in] nodeHandle Handle of the ros node.
+  SimulatedMoveUntilTouchExecutor(
+      dart::dynamics::MetaSkeletonPtr metaSkeleton,
+      dart::dynamics::BodyNodePtr endEffector,
+      std::unique_ptr<SimulatedContactModel> contactModel,
+      ros::NodeHandle nodeHandle);
+
+  virtual ~SimulatedMoveUntilTouchExecutor();
+
+  void validate(const aikido::trajectory::Trajectory* trajectory) override;
+
+  /// Starts playing \c trajectory. The future throws if the thresholds
+  /// stopped the trajectory or it was cancelled.
+  std::future<void> execute(
+      const aikido::trajectory::ConstTrajectoryPtr& trajectory) override;
+
+  void step(const std::chrono::system_clock::time_point& timepoint) override;
+
+  void cancel() override;
+
+  /// Sets the force (in N) and torque (in Nm) that stop a trajectory.
+  void setThresholds(double force, double torque);
+
+  /// Calls \c callback with every wrench reading, or stops if empty.
+  void setSampleCallback(std::function<void(const FTSample&)> callback);
+
+  /// Returns true if the thresholds stopped the last trajectory.
+  bool hasStoppedOnContact() const;
+
+private:
+  dart::dynamics::MetaSkeletonPtr mMetaSkeleton;
+  dart::dynamics::BodyNodePtr mEndEffector;
+  std::unique_ptr<SimulatedContactModel> mContactModel;
+  double mTimeScale;
+
+  mutable std::mutex mMutex;
+  aikido::trajectory::ConstTrajectoryPtr mTrajectory;
+  std::unique_ptr<std::promise<void>> mPromise;
+  std::chrono::system_clock::time_point mStartTime;
+  double mForceThreshold;
+  double mTorqueThreshold;
+  bool mStoppedOnContact;
+  std::function<void(const FTSample&)> mSampleCallback;
+
+  /// Calls step() every /simulatedContact/stepPeriod.
+  std::unique_ptr<aikido::common::ExecutorThread> mThread;
+};
+
+} // namespace feeding
+
+#endif
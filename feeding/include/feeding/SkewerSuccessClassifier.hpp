@@ -0,0 +1,84 @@
+#ifndef FEEDING_SKEWERSUCCESSCLASSIFIER_HPP_
+#define FEEDING_SKEWERSUCCESSCLASSIFIER_HPP_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <ros/ros.h>
+
+#include "feeding/FTSampleBuffer.hpp"
+#include "feeding/FTThresholdHelper.hpp"
+
+namespace feeding {
+
+/// Result of classifying a skewering attempt.
+struct SkewerClassification
+{
+  /// True if the fork is believed to hold food.
+  bool success = false;
+
+  /// Probability of the reported outcome, in [0.5, 1].
+  /// 0 if no F/T data was available.
+  double confidence = 0;
+
+  /// Static load added to the fork since the baseline was recorded, in N.
+  double load = 0;
+
+  /// True if confidence reached the configured threshold, i.e. the result
+  /// can be used without asking the supervisor.
+  bool isConfident = false;
+};
+
+/// Decides whether food was acquired from the static load on the forque.
+///
+/// The baseline is recorded while the empty fork hovers above the food.
+/// After moving out of the food the load is compared again; food on the
+/// fork shows up as a change of the mean force exceeding a per-food
+/// threshold. The confidence accounts for the sensor noise in both windows,
+/// so a supervisor only needs to be asked when the two are hard to tell
+/// apart.
+class SkewerSuccessClassifier
+{
+public:
+  /// Constructor.
+  /// \param[in] ftThresholdHelper Source of the F/T statistics.
+  /// \param[in] nodeHandle Handle of the ros node.
+  SkewerSuccessClassifier(
+      std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
+      ros::NodeHandle nodeHandle);
+
+  /// Records the empty-fork load. Call while the fork is still and empty.
+  /// \return False if no F/T data is available.
+  bool recordBaseline();
+
+  /// Classifies the attempt from the current load and the last baseline.
+  /// \param[in] foodName Name of the food that was skewered.
+  SkewerClassification classify(const std::string& foodName) const;
+
+  /// Returns the load threshold used for \c foodName.
+  double getLoadThreshold(const std::string& foodName) const;
+
+private:
+  std::shared_ptr<FTThresholdHelper> mFTThresholdHelper;
+
+  bool mHasBaseline;
+  FTWindowStatistics mBaseline;
+
+  std::unordered_map<std::string, double> mFoodLoadThresholds;
+  double mDefaultLoadThreshold;
+  double mLoadScale;
+  double mConfidenceThreshold;
+};
+
+/// Classifies the attempt with \c classifier and asks the supervisor with
+/// \c optionPrompts only when the classifier is not confident or missing.
+/// \return True if the food was acquired.
+bool isSkewerSuccessful(
+    const std::shared_ptr<SkewerSuccessClassifier>& classifier,
+    const std::string& foodName,
+    const std::vector<std::string>& optionPrompts);
+
+} // namespace feeding
+
+#endif
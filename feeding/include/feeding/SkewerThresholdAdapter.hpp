@@ -0,0 +1,101 @@
+#ifndef FEEDING_SKEWERTHRESHOLDADAPTER_HPP_
+#define FEEDING_SKEWERTHRESHOLDADAPTER_HPP_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "feeding/FTSampleBuffer.hpp"
+
+namespace feeding {
+
+/// Contact forces observed while moving into the food.
+struct SkewerContact
+{
+  /// Largest force magnitude above the empty-fork baseline, in N.
+  double peakForce = 0;
+  /// Typical force while the fork is in contact, in N.
+  double steadyForce = 0;
+  /// Largest torque magnitude above the empty-fork baseline, in Nm.
+  double peakTorque = 0;
+  /// Number of samples the estimates are based on.
+  std::size_t numSamples = 0;
+
+  /// Computes the contact forces from the samples recorded during moveInto.
+  /// The first samples are taken as the empty-fork baseline.
+  static SkewerContact fromSamples(const std::vector<FTSample>& samples);
+};
+
+/// Adapts the per-food F/T thresholds used for skewering.
+///
+/// Thresholds start at /foodItems/forces and the grabFood torque. After
+/// every attempt they are moved based on the observed contact:
+/// - success: towards the successful peak force plus a margin,
+/// - failure that was stopped by the force threshold while the force was
+///   still building up in the food: up, since it stopped too early,
+/// - failure with a force spike well above the steady in-food force: down
+///   towards the steady force, since the fork went through into the plate.
+/// The thresholds are persisted to a YAML file between sessions.
+class SkewerThresholdAdapter
+{
+public:
+  /// Constructor.
+  /// \param[in] initialForces Force thresholds to start from, per food.
+  /// \param[in] initialTorque Torque threshold to start from.
+  /// \param[in] nodeHandle Handle of the ros node.
+  SkewerThresholdAdapter(
+      const std::unordered_map<std::string, double>& initialForces,
+      double initialTorque,
+      ros::NodeHandle nodeHandle);
+
+  /// Returns the force and torque thresholds for \c foodName.
+  std::pair<double, double> getThresholds(const std::string& foodName) const;
+
+  /// Updates the thresholds of \c foodName with the outcome of an attempt.
+  void update(
+      const std::string& foodName, const SkewerContact& contact, bool success);
+
+  /// Loads thresholds from \c filename, overriding the initial ones.
+  /// \return False if the file does not exist or cannot be parsed.
+  bool load(const std::string& filename);
+
+  /// Saves all thresholds to \c filename.
+  /// \return False if the file cannot be written.
+  bool save(const std::string& filename) const;
+
+  /// Saves to the file configured in /skewerThresholds/file, if any.
+  bool save() const;
+
+private:
+  struct FoodThresholds
+  {
+    double force;
+    double torque;
+    std::size_t numSuccesses;
+    std::size_t numFailures;
+  };
+
+  FoodThresholds& getFoodThresholds(const std::string& foodName);
+
+  mutable std::mutex mMutex;
+  std::unordered_map<std::string, FoodThresholds> mThresholds;
+
+  double mDefaultForce;
+  double mDefaultTorque;
+
+  std::string mFilename;
+  double mLearningRate;
+  double mMargin;
+  double mMinForce;
+  double mMaxForce;
+  double mMinTorque;
+  double mMaxTorque;
+};
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef FEEDING_SPEECH_HPP_
+#define FEEDING_SPEECH_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <ros/ros.h>
+
+namespace feeding {
+
+/// Speaks one statement at a time.
+class SpeechBackend
+{
+public:
+  virtual ~SpeechBackend() = default;
+
+  /// Speaks \c statement and returns when it has been spoken.
+  virtual void speak(const std::string& statement) = 0;
+};
+
+/// Speaks with the swift text to speech engine.
+class SwiftSpeechBackend : public SpeechBackend
+{
+public:
+  void speak(const std::string& statement) override;
+};
+
+/// Only logs statements. Used in simulation.
+class NullSpeechBackend : public SpeechBackend
+{
+public:
+  void speak(const std::string& statement) override;
+};
+
+/// Queue of statements spoken by a single worker thread, so that callers
+/// never wait for speech.
+///
+/// Statements are spoken by priority, oldest first within a priority, and
+/// published on /talk_pub when they are spoken. Queued statements are
+/// merged and dropped so that speech does not lag behind the demo:
+/// - A statement that is already queued is not queued again.
+/// - A low priority statement replaces the queued low priority one, and is
+///   dropped if it waited longer than /speech/maxAge.
+/// - If more than /speech/maxQueueSize statements are queued, the oldest
+///   one with the lowest priority is dropped.
+class SpeechQueue
+{
+public:
+  enum class Priority
+  {
+    LOW,
+    NORMAL,
+    HIGH
+  };
+
+  /// Constructor. Starts the worker.
+  /// \param[in] backend Speaks the statements.
+  /// \param[in] nodeHandle Handle of the ros node.
+  SpeechQueue(
+      std::unique_ptr<SpeechBackend> backend, ros::NodeHandle nodeHandle);
+
+  /// Drops the queued statements and waits for the current one.
+  ~SpeechQueue();
+
+  /// Queues \c statement and returns immediately.
+  /// \return Future that is true once the statement was spoken and false
+  /// if it was dropped.
+  std::shared_future<bool> say(
+      const std::string& statement, Priority priority = Priority::NORMAL);
+
+  /// Drops all queued statements.
+  void clear();
+
+private:
+  struct Utterance
+  {
+    std::string statement;
+    Priority priority;
+    std::chrono::steady_clock::time_point queueTime;
+    std::shared_ptr<std::promise<bool>> promise;
+    std::shared_future<bool> future;
+  };
+
+  /// Highest priority first, then in queue order.
+  using Key = std::pair<int, std::uint64_t>;
+  using Queue = std::map<Key, Utterance>;
+
+  void run();
+
+  /// Removes the utterance at \c it and completes its future with false.
+  /// Requires mMutex.
+  void drop(Queue::iterator it);
+
+  std::unique_ptr<SpeechBackend> mBackend;
+  ros::Publisher mTalkPub;
+  std::chrono::duration<double> mMaxAge;
+  std::size_t mMaxQueueSize;
+
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  Queue mQueue;
+  std::uint64_t mNextSequence = 0;
+  bool mRunning = true;
+  std::thread mWorker;
+};
+
+} // namespace feeding
+
+#endif
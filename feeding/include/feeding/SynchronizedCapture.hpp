@@ -0,0 +1,85 @@
+#ifndef FEEDING_SYNCHRONIZEDCAPTURE_HPP_
+#define FEEDING_SYNCHRONIZEDCAPTURE_HPP_
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+
+#include <cv_bridge/cv_bridge.h>
+#include <ros/ros.h>
+
+namespace feeding {
+
+/// A color and a depth image taken at (nearly) the same time.
+struct CapturedFrames
+{
+  cv_bridge::CvImageConstPtr color;
+  cv_bridge::CvImageConstPtr depth;
+};
+
+/// Pairs color and depth images by header stamp to serve capture requests.
+///
+/// A request is served by the first pair whose stamps are both newer than
+/// the request, at most maxStampDifference apart, and accepted by the
+/// request's ready predicate. The image callbacks do all the work, so
+/// nobody has to sleep and hope both images arrive.
+class SynchronizedCapture
+{
+public:
+  /// Stores the frames of a request. Returns false to be offered the next
+  /// pair instead, e.g. when the writer is saturated.
+  using Handler = std::function<bool(const CapturedFrames&)>;
+
+  /// Returns true if a frame taken at the given stamp may be used.
+  using ReadyPredicate = std::function<bool(const ros::Time&)>;
+
+  /// Constructor.
+  /// \param[in] maxStampDifference Largest color/depth stamp difference of a
+  /// pair, in seconds.
+  explicit SynchronizedCapture(double maxStampDifference = 0.02);
+
+  /// Requests a pair taken after now.
+  /// \param[in] handler Called from the image callback with the pair.
+  /// \param[in] isReady Optional check of the frame stamps.
+  /// \return Resolved once handler accepted a pair.
+  std::future<CapturedFrames> request(
+      Handler handler, ReadyPredicate isReady = nullptr);
+
+  /// True while a request waits for frames.
+  bool isPending() const;
+
+  /// Drops all open requests. Their futures get a broken_promise error.
+  void cancel();
+
+  void addColor(cv_bridge::CvImageConstPtr image);
+
+  void addDepth(cv_bridge::CvImageConstPtr image);
+
+private:
+  struct Request
+  {
+    ros::Time time;
+    Handler handler;
+    ReadyPredicate isReady;
+    std::promise<CapturedFrames> promise;
+  };
+
+  /// Stores \c image as the latest of its stream and serves the oldest
+  /// request if it completes a pair.
+  void add(
+      cv_bridge::CvImageConstPtr image,
+      cv_bridge::CvImageConstPtr& latest,
+      const cv_bridge::CvImageConstPtr& other);
+
+  const double mMaxStampDifference;
+
+  mutable std::mutex mMutex;
+  std::deque<Request> mRequests;
+  cv_bridge::CvImageConstPtr mLatestColor;
+  cv_bridge::CvImageConstPtr mLatestDepth;
+};
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef FEEDING_TOPICINPUT_HPP_
+#define FEEDING_TOPICINPUT_HPP_
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+
+#include <ros/ros.h>
+#include <std_msgs/String.h>
+
+namespace feeding {
+
+/// Long-lived subscription to a topic of text input, such as the voice and
+/// web commands of the human study.
+///
+/// Messages are queued from the moment the subscription is created, up to
+/// a bounded number, and each one is handed to exactly one receive call,
+/// so commands sent before anyone waits for them are not lost.
+class TopicInput
+{
+public:
+  /// Constructor. Subscribes to \c topic.
+  /// \param[in] nodeHandle Handle of the ros node.
+  /// \param[in] topic std_msgs/String topic.
+  /// \param[in] maxQueueSize Number of messages kept before the oldest is
+  /// dropped.
+  TopicInput(
+      ros::NodeHandle nodeHandle,
+      const std::string& topic,
+      std::size_t maxQueueSize = 16);
+
+  /// Cancels the pending receive calls.
+  ~TopicInput();
+
+  /// Returns the oldest queued message received after \c newerThan, or the
+  /// next message if none is queued. Queued messages that are not newer
+  /// are discarded.
+  /// \param[out] id Id to cancel just this call with, if not nullptr.
+  std::future<std::string> receive(
+      const ros::Time& newerThan, std::size_t* id = nullptr);
+
+  /// Completes the pending receive call \c id with an empty string, so
+  /// that it does not take the next message. Other calls keep waiting.
+  /// Does nothing if the call is already completed.
+  void cancel(std::size_t id);
+
+  /// Completes all pending receive calls with an empty string.
+  void cancel();
+
+private:
+  struct Message
+  {
+    std::string data;
+    ros::Time stamp;
+  };
+
+  struct Request
+  {
+    std::size_t id;
+    ros::Time newerThan;
+    std::promise<std::string> promise;
+  };
+
+  void callback(const std_msgs::String::ConstPtr& msg);
+
+  std::size_t mMaxQueueSize;
+  std::mutex mMutex;
+  std::deque<Message> mQueue;
+  std::deque<Request> mRequests;
+  std::size_t mNextRequestId = 0;
+  ros::Subscriber mSubscriber;
+};
+
+} // namespace feeding
+
+#endif
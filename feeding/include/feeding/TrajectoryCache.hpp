@@ -0,0 +1,160 @@
+#ifndef FEEDING_TRAJECTORYCACHE_HPP_
+#define FEEDING_TRAJECTORYCACHE_HPP_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+#include <aikido/common/ExecutorThread.hpp>
+#include <aikido/constraint/dart/CollisionFree.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
+#include <aikido/trajectory/Trajectory.hpp>
+#include <ros/ros.h>
+
+#include <libada/Ada.hpp>
+
+namespace feeding {
+
+/// Caches arm paths to goals that are planned to over and over, e.g. the
+/// hard-coded configurations above the plate and in front of the person.
+///
+/// Paths are keyed by the goal and the start configuration, with continuous
+/// joints wrapped to (-pi, pi], quantized to /trajectoryCache/resolution. A
+/// cached path is only reused after the trajectory that executes it passed
+/// the current collision constraint, and it is timed anew with the current
+/// velocity limits, so only the planning is skipped. Paths are persisted to
+/// a YAML file between sessions; it is written every
+/// /trajectoryCache/saveInterval seconds if paths changed, and when the
+/// cache is destroyed, never on the motion path.
+class TrajectoryCache
+{
+public:
+  /// How often the cache saved a planner call.
+  struct Statistics
+  {
+    /// Valid cached paths that were executed.
+    std::size_t numHits = 0;
+    /// Calls without a cached path.
+    std::size_t numMisses = 0;
+    /// Cached paths that were in collision and replanned.
+    std::size_t numRejected = 0;
+
+    double getHitRate() const;
+  };
+
+  /// Plans a path from the current configuration of the arm.
+  using Planner = std::function<aikido::trajectory::TrajectoryPtr()>;
+
+  /// Constructor.
+  /// \param[in] space State space of the arm, used to wrap the continuous
+  /// joints of start configurations.
+  /// \param[in] nodeHandle Handle of the ros node.
+  TrajectoryCache(
+      aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr space,
+      ros::NodeHandle nodeHandle);
+
+  /// Destructor. Saves the paths if they changed since the last save.
+  ~TrajectoryCache();
+
+  /// Moves the arm along a cached path to \c goal, calling \c plan on a
+  /// miss and caching its path.
+  /// \param[in] goal Identifies the goal, including everything the planned
+  /// paths depend on besides the start configuration.
+  /// \return False if no path was found or execution failed.
+  bool moveArm(
+      const std::shared_ptr<ada::Ada>& ada,
+      const std::string& goal,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+      const Planner& plan,
+      const std::vector<double>& velocityLimits);
+
+  /// Moves the arm to \c configuration like ada::Ada::moveArmToConfiguration
+  /// but through the cache.
+  /// \param[in] name Name of the configuration, e.g. "abovePlate".
+  bool moveArmToConfiguration(
+      const std::shared_ptr<ada::Ada>& ada,
+      const std::string& name,
+      const Eigen::VectorXd& configuration,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+      double timelimit,
+      const std::vector<double>& velocityLimits);
+
+  /// Returns the statistics of all goals since the start of the session.
+  Statistics getStatistics() const;
+
+  /// Returns the statistics of \c goal since the start of the session.
+  Statistics getStatistics(const std::string& goal) const;
+
+  /// Loads paths from \c filename, adding them to the cached ones.
+  /// \return False if the file does not exist or cannot be parsed.
+  bool load(const std::string& filename);
+
+  /// Saves all paths to \c filename.
+  /// \return False if the file cannot be written.
+  bool save(const std::string& filename) const;
+
+  /// Saves to the file configured in /trajectoryCache/file, if any.
+  bool save() const;
+
+  /// Saves to /trajectoryCache/file if paths changed since the last save.
+  void saveIfModified();
+
+  /// Creates a goal name from \c name and the values it is planned with.
+  static std::string getGoalName(
+      const std::string& name, const std::vector<double>& values);
+
+private:
+  using Path = std::vector<Eigen::VectorXd>;
+
+  /// Returns the key of paths to \c goal starting at \c start. Wraps the
+  /// continuous joints first, so that the raw positions of the arm and the
+  /// positions of stored paths give the same key.
+  std::string getKey(const std::string& goal, const Eigen::VectorXd& start)
+      const;
+
+  /// Returns the path through \c path as the arm executes it.
+  std::shared_ptr<aikido::trajectory::Interpolated> createTrajectory(
+      const Path& path) const;
+
+  /// Returns a cached path to \c goal that starts at the current
+  /// configuration of the arm and is collision free, or nullptr.
+  aikido::trajectory::TrajectoryPtr findPath(
+      const std::shared_ptr<ada::Ada>& ada,
+      const std::string& goal,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree);
+
+  /// Returns true if \c trajectory satisfies \c collisionFree, checked
+  /// every /trajectoryCache/collisionCheckResolution of joint motion.
+  bool isCollisionFree(
+      const std::shared_ptr<ada::Ada>& ada,
+      const aikido::trajectory::Interpolated& trajectory,
+      const aikido::constraint::dart::CollisionFreePtr& collisionFree) const;
+
+  aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr mSpace;
+
+  mutable std::mutex mMutex;
+  /// Goal of every key, needed to save the paths.
+  std::unordered_map<std::string, std::string> mGoals;
+  std::unordered_map<std::string, Path> mPaths;
+  std::map<std::string, Statistics> mStatistics;
+  /// True if paths were added or removed since the last save.
+  bool mIsModified;
+
+  std::string mFilename;
+  double mResolution;
+  double mCollisionCheckResolution;
+
+  /// Calls saveIfModified() every /trajectoryCache/saveInterval, if
+  /// /trajectoryCache/file is set.
+  std::unique_ptr<aikido::common::ExecutorThread> mSaveThread;
+};
+
+} // namespace feeding
+
+#endif
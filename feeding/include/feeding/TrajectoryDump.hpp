@@ -0,0 +1,159 @@
+#ifndef FEEDING_TRAJECTORYDUMP_HPP_
+#define FEEDING_TRAJECTORYDUMP_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <aikido/statespace/StateSpace.hpp>
+#include <aikido/trajectory/Spline.hpp>
+
+namespace feeding {
+
+/// Binary layout of trajectory dumps.
+///
+/// A FileHeader is followed by one record per trajectory: a RecordHeader,
+/// the label padded to 8 bytes, then numSamples doubles each of the sample
+/// times, every position coordinate and every velocity coordinate. Each
+/// column is contiguous, so a record maps directly onto column-major
+/// (numSamples x dimension) matrices. Files are only appended to; a record
+/// cut off by a crash is ignored by the reader and cut off the file when a
+/// writer opens it again.
+namespace trajectorydump {
+
+static const char MAGIC[8] = {'F', 'E', 'E', 'D', 'T', 'R', 'J', '\0'};
+static const std::uint32_t VERSION = 1;
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+};
+
+struct RecordHeader
+{
+  std::uint32_t dimension;
+  std::uint32_t numSamples;
+  /// Label size without padding.
+  std::uint32_t labelSize;
+  std::uint32_t reserved;
+  /// When the trajectory was dumped, e.g. sent to the executor.
+  double time;
+};
+
+} // namespace trajectorydump
+
+/// Samples splines and appends them to a trajectory dump.
+///
+/// Each spline segment is evaluated for all its samples at once as a
+/// product of a matrix of time powers with the segment coefficients, into
+/// buffers that are reused across calls. Records are collected in memory
+/// and written in large batches. All methods are thread safe.
+class TrajectoryDumpWriter
+{
+public:
+  /// Opens \c filename for appending after its last complete record,
+  /// creating it if needed. isOpen() is false if it is not a dump.
+  /// \param[in] timeStep Sampling period in seconds. The end of every
+  /// trajectory is sampled as well.
+  /// \param[in] bufferSize Bytes collected before they are written.
+  explicit TrajectoryDumpWriter(
+      const std::string& filename,
+      double timeStep = 0.01,
+      std::size_t bufferSize = 1 << 20);
+
+  /// Writes pending records and closes the file.
+  ~TrajectoryDumpWriter();
+
+  TrajectoryDumpWriter(const TrajectoryDumpWriter&) = delete;
+  TrajectoryDumpWriter& operator=(const TrajectoryDumpWriter&) = delete;
+
+  bool isOpen() const;
+
+  /// Samples positions and velocities of \c spline and appends them.
+  /// \param[in] label Free text, e.g. the motion the spline belongs to.
+  /// \param[in] time Timestamp of the record, e.g. the ROS time of execution.
+  void append(
+      const aikido::trajectory::Spline& spline,
+      const std::string& label,
+      double time);
+
+  /// Appends several splines that share \c time, e.g. all segments of a
+  /// blended motion, in one pass.
+  void append(
+      const std::vector<const aikido::trajectory::Spline*>& splines,
+      const std::vector<std::string>& labels,
+      double time);
+
+  /// Writes all pending records.
+  void flush();
+
+private:
+  /// Samples \c spline into mTimes, mPositions and mVelocities. Requires
+  /// mMutex.
+  void sample(const aikido::trajectory::Spline& spline);
+
+  /// Adds the sampled trajectory to mBuffer. Requires mMutex.
+  void appendRecord(const std::string& label, double time);
+
+  /// Writes mBuffer to the file. Requires mMutex.
+  void writeBuffer();
+
+  const double mTimeStep;
+  const std::size_t mBufferSize;
+
+  std::mutex mMutex;
+  std::FILE* mFile;
+  std::vector<char> mBuffer;
+
+  // Sampling buffers, grown as needed and never shrunk.
+  std::size_t mDimension;
+  std::vector<double> mTimes;
+  std::vector<double> mPositions;
+  std::vector<double> mVelocities;
+  std::vector<double> mPowers;
+  std::vector<double> mDerivativePowers;
+  Eigen::VectorXd mStartPositions;
+
+  // State buffer for mStateSpace.
+  aikido::statespace::ConstStateSpacePtr mStateSpace;
+  aikido::statespace::StateSpace::State* mState;
+};
+
+/// One trajectory read from a dump.
+struct DumpedTrajectory
+{
+  std::string label;
+  double time = 0;
+  Eigen::VectorXd times;
+  /// numSamples x dimension.
+  Eigen::MatrixXd positions;
+  /// numSamples x dimension.
+  Eigen::MatrixXd velocities;
+};
+
+/// Reads a trajectory dump into memory.
+class TrajectoryDumpReader
+{
+public:
+  /// Reads \c filename. Throws a runtime_error if it is not a trajectory
+  /// dump.
+  explicit TrajectoryDumpReader(const std::string& filename);
+
+  std::size_t getNumTrajectories() const;
+
+  DumpedTrajectory getTrajectory(std::size_t index) const;
+
+private:
+  std::vector<char> mData;
+  /// Offsets of the complete records.
+  std::vector<std::size_t> mRecords;
+};
+
+} // namespace feeding
+
+#endif
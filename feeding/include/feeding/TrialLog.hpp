@@ -0,0 +1,79 @@
+#ifndef FEEDING_TRIALLOG_HPP_
+#define FEEDING_TRIALLOG_HPP_
+
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include <aikido/trajectory/Trajectory.hpp>
+
+namespace feeding {
+
+/// Structured log of the events of one trial.
+///
+/// Every event is a YAML flow map on its own line of a YAML sequence, e.g.
+///   - {time: 1571234567.25, event: plan, planner: planArmToTSR, ...}
+/// so the file stays readable if the trial is interrupted. All times are
+/// ROS times in seconds, the time base of image stamps and of the
+/// TrialRecorder records, so motions, thresholds and images can be lined
+/// up with the F/T and joint state streams. All methods are thread safe.
+class TrialLog
+{
+public:
+  /// Number of samples logged per trajectory.
+  static const std::size_t NUM_TRAJECTORY_SAMPLES = 20;
+
+  /// Creates \c filename, overwriting an existing log.
+  TrialLog(const std::string& filename, const std::string& trialName);
+
+  bool isOpen() const;
+
+  /// Logs a planner call.
+  /// \param[in] planner Name of the planner or planning function.
+  void logPlan(
+      const std::string& planner,
+      double startTime,
+      double endTime,
+      bool success);
+
+  /// Logs a motion of the arm.
+  /// \param[in] motion What moved, e.g. the executed trajectory's planner.
+  /// \param[in] trajectory If given, NUM_TRAJECTORY_SAMPLES evenly spaced
+  /// configurations of it are logged.
+  void logExecution(
+      const std::string& motion,
+      double startTime,
+      double endTime,
+      bool success,
+      const aikido::trajectory::Trajectory* trajectory = nullptr);
+
+  /// Logs a perception call.
+  void logPerception(
+      const std::string& target,
+      double startTime,
+      double endTime,
+      bool success);
+
+  /// Logs commanded F/T thresholds.
+  void logThresholds(double time, double force, double torque);
+
+  /// Logs a stored image.
+  /// \param[in] stamp Header stamp of the image.
+  /// \param[in] name File or dataset name of the image.
+  void logImage(
+      const std::string& stream, double stamp, const std::string& name);
+
+  /// Logs the outcome label of the trial, e.g. "success".
+  void logOutcome(double time, const std::string& label);
+
+private:
+  /// Writes \c fields as the next event. Requires mMutex.
+  void write(double time, const std::string& event, const std::string& fields);
+
+  std::mutex mMutex;
+  std::ofstream mFile;
+};
+
+} // namespace feeding
+
+#endif
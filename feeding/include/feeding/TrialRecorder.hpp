@@ -0,0 +1,209 @@
+#ifndef FEEDING_TRIALRECORDER_HPP_
+#define FEEDING_TRIALRECORDER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Core>
+#include <geometry_msgs/WrenchStamped.h>
+#include <ros/ros.h>
+#include <sensor_msgs/JointState.h>
+
+#include "feeding/FTSampleBuffer.hpp"
+
+namespace feeding {
+
+class DatasetWriter;
+
+/// Binary layout of trial recordings.
+///
+/// A file starts with a FileHeader followed by records. Every record is a
+/// RecordHeader followed by numValues doubles, so all
+/// values are 8-byte aligned and the file can be used in place when memory
+/// mapped. Files are only ever appended to; a record cut off by a crash is
+/// ignored by the reader and cut off the file when recording to it resumes.
+/// The joint names are written once per file, in a JOINT_NAMES record before
+/// the first joint state.
+namespace trialrecord {
+
+static const char MAGIC[8] = {'F', 'E', 'E', 'D', 'R', 'E', 'C', '\0'};
+static const std::uint32_t VERSION = 1;
+
+enum RecordType : std::uint16_t
+{
+  /// force xyz, torque xyz
+  WRENCH = 1,
+  /// positions, velocities, efforts (numValues / 3 joints each)
+  JOINT_STATE = 2,
+  /// joint names, each followed by '\0', padded with '\0' to whole values
+  JOINT_NAMES = 3
+};
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+};
+
+struct RecordHeader
+{
+  std::uint16_t type;
+  std::uint16_t numValues;
+  std::uint32_t reserved;
+  double time;
+};
+
+} // namespace trialrecord
+
+/// A single joint state reading.
+struct JointStateSample
+{
+  double time = 0;
+  Eigen::VectorXd positions;
+  Eigen::VectorXd velocities;
+  Eigen::VectorXd efforts;
+};
+
+/// Records the raw F/T and joint state streams to one binary file per trial.
+///
+/// The ROS callbacks only append the message to an in-memory batch. A
+/// background thread swaps the batch out and writes it to disk, so disk
+/// latency never reaches the callback threads.
+class TrialRecorder
+{
+public:
+  /// Constructor. Subscribes to the F/T topic (/ftSensor/ftTopic) and the
+  /// joint state topic (/trialRecorder/jointStateTopic).
+  /// \param[in] nodeHandle Handle of the ros node.
+  /// \param[in] flushPeriod How often the background thread writes batches.
+  explicit TrialRecorder(
+      ros::NodeHandle nodeHandle,
+      std::chrono::milliseconds flushPeriod = std::chrono::milliseconds(100));
+
+  /// Stops the current trial and the background thread.
+  ~TrialRecorder();
+
+  TrialRecorder(const TrialRecorder&) = delete;
+  TrialRecorder& operator=(const TrialRecorder&) = delete;
+
+  /// Starts recording to \c filename. Stops the previous trial if any.
+  /// Appends to an existing recording after its last complete record.
+  /// \return False if the file could not be opened or is not a recording.
+  bool start(const std::string& filename);
+
+  /// Starts recording into the current trial of \c dataset, one
+  /// SENSOR_RECORDS chunk per batch. Stops the previous trial if any.
+  void start(std::shared_ptr<DatasetWriter> dataset);
+
+  /// Stops recording and blocks until everything is on disk.
+  void stop();
+
+  bool isRecording() const;
+
+  /// Number of records written to the current or last trial file.
+  std::size_t getNumRecords() const;
+
+  void wrenchCallback(const geometry_msgs::WrenchStamped::ConstPtr& msg);
+
+  void jointStateCallback(const sensor_msgs::JointState::ConstPtr& msg);
+
+private:
+  /// Appends a JOINT_NAMES record with \c names to the pending batch.
+  void appendJointNames(const std::vector<std::string>& names);
+
+  /// Appends one record to the pending batch.
+  void append(
+      trialrecord::RecordType type,
+      double time,
+      const double* values,
+      std::size_t numValues);
+
+  /// Background thread: periodically writes the pending batch.
+  void writerLoop();
+
+  /// Writes the pending batch to the file or dataset. Requires mFileMutex.
+  void flushPending();
+
+  ros::NodeHandle mNodeHandle;
+  ros::Subscriber mWrenchSub;
+  ros::Subscriber mJointStateSub;
+
+  const std::chrono::milliseconds mFlushPeriod;
+
+  std::atomic<bool> mRecording;
+  std::atomic<std::size_t> mNumRecords;
+  /// True once the current file or dataset trial has the joint names.
+  std::atomic<bool> mHasJointNames;
+
+  // Batch filled by the callbacks. Only held while appending or swapping.
+  std::mutex mBatchMutex;
+  std::vector<char> mPending;
+  std::vector<char> mWriting;
+
+  // Protects mFile and mDataset; at most one of them is set.
+  std::mutex mFileMutex;
+  std::FILE* mFile;
+  std::shared_ptr<DatasetWriter> mDataset;
+
+  std::mutex mWakeMutex;
+  std::condition_variable mWakeCondition;
+  bool mStopWriter;
+  std::thread mWriterThread;
+};
+
+/// Memory-mapped, read-only view of a trial recording.
+class TrialRecordReader
+{
+public:
+  /// Maps \c filename. Throws a runtime_error if it is not a valid
+  /// recording.
+  explicit TrialRecordReader(const std::string& filename);
+
+  ~TrialRecordReader();
+
+  TrialRecordReader(const TrialRecordReader&) = delete;
+  TrialRecordReader& operator=(const TrialRecordReader&) = delete;
+
+  std::size_t getNumWrenches() const;
+
+  FTSample getWrench(std::size_t index) const;
+
+  std::size_t getNumJointStates() const;
+
+  JointStateSample getJointState(std::size_t index) const;
+
+  /// Names of the joints of the joint states, empty if the recording has
+  /// none.
+  const std::vector<std::string>& getJointNames() const;
+
+  /// Returns all wrenches with time in [startTime, endTime].
+  std::vector<FTSample> getWrenches(
+      double startTime = -std::numeric_limits<double>::infinity(),
+      double endTime = std::numeric_limits<double>::infinity()) const;
+
+private:
+  const trialrecord::RecordHeader* getRecord(std::size_t offset) const;
+
+  const char* mData;
+  std::size_t mSize;
+
+  // Byte offsets of the records of each type.
+  std::vector<std::size_t> mWrenchOffsets;
+  std::vector<std::size_t> mJointStateOffsets;
+
+  std::vector<std::string> mJointNames;
+};
+
+} // namespace feeding
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef FEEDING_WEBSTATUSPUBLISHER_HPP_
+#define FEEDING_WEBSTATUSPUBLISHER_HPP_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ros/ros.h>
+
+namespace feeding {
+
+/// Publishes the progress of a bite to the web interface without blocking
+/// the demo.
+///
+/// Events are put into a bounded outbox and published by a worker thread.
+/// Each event is published on its own latched topic (/action_done,
+/// /timing_done, /transfer_done) with its usual text, and on the latched
+/// /webStatus/topic as "<sequence number> <text>", so that a web page that
+/// connects late still gets the latest state and can tell a new event
+/// from one it has seen.
+class WebStatusPublisher
+{
+public:
+  enum class Event
+  {
+    ACTION_DONE,
+    TIMING_DONE,
+    TRANSFER_DONE
+  };
+
+  /// Constructor. Advertises the topics and starts the worker.
+  /// \param[in] nodeHandle Handle of the ros node.
+  explicit WebStatusPublisher(ros::NodeHandle nodeHandle);
+
+  /// Publishes the events in the outbox and stops the worker.
+  ~WebStatusPublisher();
+
+  /// Queues \c event and returns immediately. Drops the oldest queued event
+  /// if /webStatus/outboxSize are queued.
+  /// \return Sequence number of the event.
+  std::uint64_t publish(Event event);
+
+private:
+  struct Message
+  {
+    Event event;
+    std::uint64_t sequence;
+  };
+
+  void run();
+
+  std::vector<ros::Publisher> mEventPubs;
+  ros::Publisher mStatusPub;
+  std::size_t mMaxOutboxSize;
+
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<Message> mOutbox;
+  std::uint64_t mNextSequence = 1;
+  bool mRunning = true;
+  std::thread mWorker;
+};
+
+} // namespace feeding
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef FEEDING_ACTION_FEEDFOODTOPERSON_HPP_
 #define FEEDING_ACTION_FEEDFOODTOPERSON_HPP_
 
+#include <functional>
+
 #include <libada/Ada.hpp>
 
 #include "feeding/FeedingDemo.hpp"
@@ -11,6 +13,9 @@
 namespace feeding {
 namespace action {
 
+/// \param[in] isCancelled If set, checked before every planning and
+/// execution step and while waiting for the mouth to open; the transfer
+/// stops where it is as soon as it returns true.
 void feedFoodToPerson(
     const std::shared_ptr<ada::Ada>& ada,
     const std::shared_ptr<Workspace>& workspace,
@@ -36,7 +41,8 @@ void feedFoodToPerson(
     double endEffectorOffsetAngularTolerance,
     std::vector<double> velocityLimits,
     const Eigen::Vector3d* tiltOffset,
-    FeedingDemo* feedingDemo);
+    FeedingDemo* feedingDemo,
+    const std::function<bool()>& isCancelled = nullptr);
 }
 } // namespace feeding
 
@@ -3,6 +3,7 @@
 
 #include <libada/Ada.hpp>
 
+#include "feeding/FeedingDemo.hpp"
 #include "feeding/Workspace.hpp"
 
 namespace feeding {
@@ -14,7 +15,8 @@ void moveAboveForque(
     double forkHolderAngle,
     std::vector<double> forkHolderTranslation,
     double planningTimeout,
-    int maxNumTrials);
+    int maxNumTrials,
+    FeedingDemo* feedingDemo = nullptr);
 
 } // namespace action
 } // namespace feeding
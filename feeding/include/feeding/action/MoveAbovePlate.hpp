@@ -3,6 +3,8 @@
 
 #include <libada/Ada.hpp>
 
+#include "feeding/FeedingDemo.hpp"
+
 namespace feeding {
 namespace action {
 
@@ -16,7 +18,8 @@ bool moveAbovePlate(
     double rotationTolerance,
     double planningTimeout,
     int maxNumTrials,
-    std::vector<double> velocityLimits);
+    std::vector<double> velocityLimits,
+    FeedingDemo* feedingDemo = nullptr);
 
 } // namespace action
 } // namespace feeding
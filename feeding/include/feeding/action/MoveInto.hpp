@@ -12,6 +12,11 @@
 namespace feeding {
 namespace action {
 
+/// Length of the motion into food, in m.
+static const double MOVE_INTO_FOOD_LENGTH = 0.085;
+
+/// Moves the fork into \c item. For food, \c path is executed instead of
+/// planning if it is given, e.g. when it was planned ahead.
 bool moveInto(
     const std::shared_ptr<ada::Ada>& ada,
     const std::shared_ptr<Perception>& perception,
@@ -23,7 +28,8 @@ bool moveInto(
     double endEffectorOffsetAngularTolerance,
     const Eigen::Vector3d& endEffectorDirection,
     std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
-    const std::vector<double>& velocityLimits = std::vector<double>());
+    const std::vector<double>& velocityLimits = std::vector<double>(),
+    const aikido::trajectory::TrajectoryPtr& path = nullptr);
 
 } // namespace action
 } // namespace feeding
@@ -10,6 +10,8 @@
 namespace feeding {
 namespace action {
 
+/// Moves the fork out of \c item. \c path is executed instead of planning
+/// if it is given, e.g. when it was planned ahead.
 void moveOutOf(
     const std::shared_ptr<ada::Ada>& ada,
     const aikido::constraint::dart::CollisionFreePtr& collisionFree,
@@ -20,7 +22,8 @@ void moveOutOf(
     double endEffectorOffsetPositionTolerance,
     double endEffectorOffsetAngularTolerance,
     const std::shared_ptr<FTThresholdHelper>& ftThresholdHelper,
-    const std::vector<double>& velocityLimits = std::vector<double>());
+    const std::vector<double>& velocityLimits = std::vector<double>(),
+    const aikido::trajectory::TrajectoryPtr& path = nullptr);
 }
 } // namespace feeding
 
@@ -9,6 +9,16 @@
 namespace feeding {
 namespace action {
 
+/// Returns the straight end effector motion from its current pose to
+/// \c facePose, stopping \c distanceToPerson short of it in y.
+Eigen::Vector3d getOffsetTowardsPerson(
+    const std::shared_ptr<ada::Ada>& ada,
+    const Eigen::Isometry3d& facePose,
+    double distanceToPerson);
+
+/// Moves the fork towards the perceived face. \c path is executed instead
+/// of perceiving and planning if it is given, e.g. when it was planned
+/// while waiting for the mouth to open.
 bool moveTowardsPerson(
     const std::shared_ptr<ada::Ada>& ada,
     const aikido::constraint::dart::CollisionFreePtr& collisionFree,
@@ -17,7 +27,8 @@ bool moveTowardsPerson(
     double distanceToPerson,
     double planningTimeout,
     double endEffectorOffsetPositionTolerenace,
-    double endEffectorOffsetAngularTolerance);
+    double endEffectorOffsetAngularTolerance,
+    const aikido::trajectory::TrajectoryPtr& path = nullptr);
 }
 } // namespace feeding
 
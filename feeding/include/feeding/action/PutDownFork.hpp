@@ -4,6 +4,7 @@
 #include <libada/Ada.hpp>
 
 #include "feeding/FTThresholdHelper.hpp"
+#include "feeding/FeedingDemo.hpp"
 
 namespace feeding {
 namespace action {
@@ -24,7 +25,8 @@ void putDownFork(
     double planningTimeout,
     int maxNumTrials,
     std::vector<double> velocityLimits,
-    std::shared_ptr<FTThresholdHelper> ftThresholdHelper);
+    std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
+    FeedingDemo* feedingDemo = nullptr);
 }
 } // namespace feeding
 
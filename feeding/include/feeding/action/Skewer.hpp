@@ -1,6 +1,8 @@
 #ifndef FEEDING_ACTION_SKEWER_HPP_
 #define FEEDING_ACTION_SKEWER_HPP_
 
+#include <functional>
+
 #include <libada/Ada.hpp>
 
 #include "feeding/FTThresholdHelper.hpp"
@@ -11,6 +13,8 @@
 namespace feeding {
 namespace action {
 
+/// \param[in] isCancelled If set, checked before every planning and
+/// execution step; skewering stops and fails as soon as it returns true.
 bool skewer(
     const std::shared_ptr<ada::Ada>& ada,
     const std::shared_ptr<Workspace>& workspace,
@@ -38,7 +42,8 @@ bool skewer(
     std::vector<double> velocityLimits,
     const std::shared_ptr<FTThresholdHelper>& ftThresholdHelper,
     std::vector<std::string> rotationFreeFoodNames = std::vector<std::string>(),
-    FeedingDemo* feedingDemo = nullptr);
+    FeedingDemo* feedingDemo = nullptr,
+    const std::function<bool()>& isCancelled = nullptr);
 }
 } // namespace feeding
 
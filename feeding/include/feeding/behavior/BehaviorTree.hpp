@@ -0,0 +1,203 @@
+#ifndef FEEDING_BEHAVIOR_BEHAVIORTREE_HPP_
+#define FEEDING_BEHAVIOR_BEHAVIORTREE_HPP_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace feeding {
+namespace behavior {
+
+enum class Status
+{
+  SUCCESS,
+  FAILURE,
+  CANCELLED
+};
+
+const char* toString(Status status);
+
+/// Time a node took to run.
+struct Timing
+{
+  std::string node;
+  double duration;
+  Status status;
+};
+
+/// State shared by the nodes of a running tree: a blackboard of named
+/// values, the timing of every node that ran, and cancellation.
+///
+/// A child context shares the blackboard and timings of its parent and is
+/// cancelled with it, but can be cancelled on its own, e.g. to stop the
+/// other children of a parallel node.
+class Context
+{
+public:
+  /// Constructor of a root context.
+  Context();
+
+  /// Constructor of a child of \c parent, which has to outlive it.
+  explicit Context(Context& parent);
+
+  ~Context();
+
+  Context(const Context&) = delete;
+  Context& operator=(const Context&) = delete;
+
+  /// Cancels this context and its children and calls the cancel callbacks.
+  void cancel();
+
+  bool isCancelled() const;
+
+  /// Registers \c callback to be called when the context is cancelled,
+  /// e.g. to stop the arm. Calls it right away if it already is.
+  /// \return Id to remove the callback with.
+  std::size_t onCancel(std::function<void()> callback);
+
+  /// Removes a callback, waiting for it if it is being called. Must not be
+  /// called from a callback of this context.
+  void removeOnCancel(std::size_t id);
+
+  void set(const std::string& key, const std::string& value);
+
+  /// Returns the value of \c key, or "" if it is not set.
+  std::string get(const std::string& key) const;
+
+  void addTiming(const Timing& timing);
+
+  /// Returns the timings in the order the nodes finished.
+  std::vector<Timing> getTimings() const;
+
+private:
+  struct Shared
+  {
+    std::mutex mutex;
+    std::map<std::string, std::string> blackboard;
+    std::vector<Timing> timings;
+  };
+
+  std::shared_ptr<Shared> mShared;
+  Context* mParent;
+  std::size_t mParentCallback;
+
+  std::mutex mCallbackMutex;
+  mutable std::mutex mMutex;
+  bool mCancelled = false;
+  std::map<std::size_t, std::function<void()>> mCallbacks;
+  std::size_t mNextCallback = 0;
+};
+
+/// Node of a behavior tree. Running a node blocks until it is done.
+class Node
+{
+public:
+  explicit Node(const std::string& name);
+
+  virtual ~Node() = default;
+
+  /// Runs the node unless \c context is cancelled, and records how long it
+  /// took. Exceptions count as failures.
+  Status run(Context& context);
+
+  const std::string& getName() const;
+
+protected:
+  virtual Status execute(Context& context) = 0;
+
+private:
+  std::string mName;
+};
+
+using NodePtr = std::shared_ptr<Node>;
+
+/// Leaf that calls a function, e.g. one of the actions.
+class Action : public Node
+{
+public:
+  /// \param[in] name Name of the node.
+  /// \param[in] function Returns whether the action succeeded.
+  Action(const std::string& name, std::function<bool(Context&)> function);
+
+protected:
+  Status execute(Context& context) override;
+
+private:
+  std::function<bool(Context&)> mFunction;
+};
+
+/// Runs its children in order until one of them does not succeed.
+class Sequence : public Node
+{
+public:
+  Sequence(const std::string& name, std::vector<NodePtr> children);
+
+protected:
+  Status execute(Context& context) override;
+
+private:
+  std::vector<NodePtr> mChildren;
+};
+
+/// Runs its children in order until one of them does not fail.
+class Fallback : public Node
+{
+public:
+  Fallback(const std::string& name, std::vector<NodePtr> children);
+
+protected:
+  Status execute(Context& context) override;
+
+private:
+  std::vector<NodePtr> mChildren;
+};
+
+/// Runs its child again when it fails, up to a number of attempts.
+class Retry : public Node
+{
+public:
+  Retry(const std::string& name, NodePtr child, int maxAttempts);
+
+protected:
+  Status execute(Context& context) override;
+
+private:
+  NodePtr mChild;
+  int mMaxAttempts;
+};
+
+/// Runs its children at the same time, each on its own thread.
+class Parallel : public Node
+{
+public:
+  enum class Policy
+  {
+    /// Succeeds if all children succeed. The first failure cancels the
+    /// others.
+    ALL,
+    /// Has the status of the first child. The others run alongside it,
+    /// e.g. to perceive while moving, and are cancelled when it is done.
+    MAIN
+  };
+
+  Parallel(const std::string& name, std::vector<NodePtr> children, Policy);
+
+protected:
+  Status execute(Context& context) override;
+
+private:
+  std::vector<NodePtr> mChildren;
+  Policy mPolicy;
+};
+
+/// Logs how often each node of \c context ran and how long it took in
+/// total, in the order the nodes first finished.
+void logTimings(const Context& context);
+
+} // namespace behavior
+} // namespace feeding
+
+#endif
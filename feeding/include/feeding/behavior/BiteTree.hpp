@@ -0,0 +1,31 @@
+#ifndef FEEDING_BEHAVIOR_BITETREE_HPP_
+#define FEEDING_BEHAVIOR_BITETREE_HPP_
+
+#include <memory>
+
+#include <ros/ros.h>
+
+#include "feeding/FeedingDemo.hpp"
+#include "feeding/behavior/BehaviorTree.hpp"
+#include "feeding/perception/Perception.hpp"
+
+namespace feeding {
+namespace behavior {
+
+/// Creates the tree of one bite. It reads the food from the "foodName"
+/// entry of the blackboard and whether to tilt it from "tilted".
+///
+/// The bite skewers the food, retrying up to /behavior/maxSkewerAttempts
+/// times without asking for the food again, and then feeds it. The string
+/// "stop" on /behavior/stopTopic preempts the bite at any time: the arm is
+/// stopped and the actions return before their next planning or execution
+/// step.
+NodePtr createBiteTree(
+    FeedingDemo& feedingDemo,
+    const std::shared_ptr<Perception>& perception,
+    ros::NodeHandle nodeHandle);
+
+} // namespace behavior
+} // namespace feeding
+
+#endif
@@ -22,6 +22,7 @@
 #include <libada/Ada.hpp>
 
 #include "feeding/FoodItem.hpp"
+#include "feeding/ParameterSnapshot.hpp"
 #include "feeding/ranker/ShortestDistanceRanker.hpp"
 #include "feeding/ranker/TargetFoodRanker.hpp"
 
@@ -42,6 +43,8 @@ public:
   /// \param[in] adasMetaSkeleton Ada's MetaSkeleton.
   /// \param[in] nodeHandle Handle of the ros node.
   /// \param[in] ranker Ranker to rank detected items.
+  /// \param[in] parameters Runtime parameters. If nullptr, one is created
+  /// from nodeHandle.
   Perception(
       aikido::planner::WorldPtr world,
       std::shared_ptr<ada::Ada> ada,
@@ -50,7 +53,8 @@ public:
       std::shared_ptr<TargetFoodRanker> ranker
       = std::make_shared<ShortestDistanceRanker>(),
       float faceZOffset = 0.0,
-      bool removeRotationForFood = true);
+      bool removeRotationForFood = true,
+      std::shared_ptr<ParameterSnapshot> parameters = nullptr);
 
   /// Gets food items of the name set by setFoodName
   /// from active perception ros nodes and adds their new
@@ -86,6 +90,7 @@ private:
   tf::TransformListener mTFListener;
   aikido::planner::WorldPtr mWorld;
   std::shared_ptr<ros::NodeHandle> mNodeHandle;
+  std::shared_ptr<ParameterSnapshot> mParameters;
   dart::dynamics::MetaSkeletonPtr mAdaMetaSkeleton;
 
   std::unique_ptr<aikido::perception::PoseEstimatorModule> mFoodDetector;
@@ -2,12 +2,14 @@
 #define FEEDING_UTIL_HPP_
 
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <utility>
 
 #include <Eigen/Dense>
 #include <aikido/rviz/InteractiveMarkerViewer.hpp>
 #include <aikido/statespace/StateSpace.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
 #include <aikido/trajectory/Interpolated.hpp>
 #include <aikido/trajectory/Spline.hpp>
 #include <boost/optional.hpp>
@@ -18,6 +20,8 @@
 
 #include <libada/Ada.hpp>
 
+#include "feeding/ParameterSnapshot.hpp"
+
 namespace feeding {
 
 static const std::vector<std::string> FOOD_NAMES
@@ -73,18 +77,6 @@ void handleArguments(
     std::string& dataCollectorPath,
     const std::string& description = "Ada Feeding Demo");
 
-void printStateWithTime(
-    double t,
-    std::size_t dimension,
-    Eigen::VectorXd& stateVec,
-    Eigen::VectorXd& velocityVec,
-    std::ofstream& cout);
-
-void dumpSplinePhasePlot(
-    const aikido::trajectory::Spline& spline,
-    const std::string& filename,
-    double timeStep);
-
 /// Gets user selection of food and actions
 /// param[in] food_only If true, only food choices are valid
 /// param[in]] nodeHandle Ros Node to set food name for detection.
@@ -94,9 +86,19 @@ std::string getUserFoodInput(
     bool useAlexa = true,
     double timeout = 5);
 
+/// Asks the operator to pick one of \c optionPrompts.
+/// \return Number of the option, or -1 if the answer is not a number.
 int getUserInputWithOptions(
     const std::vector<std::string>& optionPrompts, const std::string& prompt);
 
+/// Returns the operator's answer to \c prompt, from the console unless
+/// initTopics selected another /operatorInput/backend.
+std::string askOperator(const std::string& prompt);
+
+/// Waits until the operator lets the demo continue.
+/// \return False if the operator answered "n".
+bool waitForOperator(const std::string& prompt);
+
 /// Sets position limits of a metaskeleton.
 /// \param[in] metaSkeleton Metaskeleton to modify.
 /// \param[in] lowerLimits Lowerlimits of the joints.
@@ -136,18 +138,51 @@ Eigen::Isometry3d getForqueTransform(tf::TransformListener& tfListener);
 aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
     const std::shared_ptr<::ada::Ada>& ada);
 
+/// Ranks configurations of \c metaSkeleton by their distance to its current
+/// configuration, e.g. for a copy of the arm.
+aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
+    const aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr& space,
+    const dart::dynamics::MetaSkeletonPtr& metaSkeleton);
+
+/// Ranks configurations of \c metaSkeleton by their distance to
+/// \c nominalConfiguration, e.g. a goal the arm reached before.
+aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
+    const aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr& space,
+    const dart::dynamics::MetaSkeletonPtr& metaSkeleton,
+    const Eigen::VectorXd& nominalConfiguration);
+
+/// Waits for the next message on \c topic, skipping "~~no_input~~".
+/// Messages received up to /topicInput/maxAge before the call count, since
+/// the topic stays subscribed.
+/// \param[in] validateAsFood If true, returns "" unless the message is a
+/// food name.
+/// \param[in] timeout Timeout in seconds, none if not positive.
+/// \return The message, or "" on timeout.
 std::string getInputFromTopic(
     std::string topic,
     const ros::NodeHandle& nodeHandle,
     bool validateAsFood,
     double timeout = 20);
 
-void talk(const std::string&, bool background = false);
-
-void initTopics(ros::NodeHandle* nodeHandle);
+/// Queues \c statement to be spoken and returns immediately. Background
+/// statements are chatter, which is dropped when it gets stale.
+/// \return Future that is true once the statement was spoken and false if
+/// it was dropped.
+std::shared_future<bool> talk(
+    const std::string& statement, bool background = false);
+
+/// Advertises the latched topics of the web interface, starts speech and
+/// selects the operator input. Speech is only logged in simulation unless
+/// /speech/backend is set.
+/// \param[in] parameters Snapshot the study topics are read from.
+void initTopics(
+    ros::NodeHandle* nodeHandle,
+    bool adaReal,
+    std::shared_ptr<ParameterSnapshot> parameters);
 
 //==============================================================================
-// Publish msg to the web interface to indicate food acquisition is done
+// Publish msg to the web interface to indicate food acquisition is done.
+// Returns immediately; the message is sent by a WebStatusPublisher.
 void publishActionDoneToWeb(ros::NodeHandle* nodeHandle);
 
 //==============================================================================
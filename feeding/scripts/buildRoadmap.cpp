@@ -0,0 +1,34 @@
+#include <ros/ros.h>
+
+#include "feeding/FeedingDemo.hpp"
+#include "feeding/Roadmap.hpp"
+
+namespace feeding {
+
+///
+/// Builds the roadmap of the workspace and saves it to /roadmap/file.
+///
+/// Run in simulation; the roadmap is built against the collision
+/// constraint of the static workspace.
+///
+void buildRoadmap(FeedingDemo& feedingDemo, ros::NodeHandle nodeHandle)
+{
+  ROS_INFO_STREAM("========== BUILD ROADMAP ==========");
+
+  auto roadmap = feedingDemo.getRoadmap();
+  if (!roadmap)
+  {
+    ROS_ERROR_STREAM("Set /roadmap/file to build a roadmap.");
+    return;
+  }
+
+  roadmap->build(feedingDemo.getAda(), feedingDemo.getCollisionConstraint());
+  if (!roadmap->save())
+  {
+    ROS_ERROR_STREAM("Failed to save the roadmap.");
+    return;
+  }
+  ROS_INFO("Roadmap saved.");
+}
+
+} // namespace feeding
@@ -12,6 +12,7 @@
 #include "feeding/action/MoveAbove.hpp"
 #include "feeding/action/MoveInFrontOfPerson.hpp"
 #include "feeding/action/MoveDirectlyToPerson.hpp"
+#include "feeding/behavior/BiteTree.hpp"
 #include <cstdlib>
 #include <ctime>
 
@@ -37,6 +38,12 @@ void demo(
 
   srand(time(NULL));
 
+  bool useBehaviorTree;
+  nodeHandle.param<bool>("/behavior/enabled", useBehaviorTree, false);
+  behavior::NodePtr biteTree;
+  if (useBehaviorTree)
+    biteTree = behavior::createBiteTree(feedingDemo, perception, nodeHandle);
+
   while (true)
   {
     if (feedingDemo.getFTThresholdHelper())
@@ -105,7 +112,8 @@ void demo(
         feedingDemo.mPlanningTimeout,
         feedingDemo.mMaxNumTrials,
         feedingDemo.mVelocityLimits,
-        feedingDemo.getFTThresholdHelper());
+        feedingDemo.getFTThresholdHelper(),
+        &feedingDemo);
     }
     else if (foodName == "putdownfork")
     {
@@ -125,7 +133,20 @@ void demo(
         feedingDemo.mPlanningTimeout,
         feedingDemo.mMaxNumTrials,
         feedingDemo.mVelocityLimits,
-        feedingDemo.getFTThresholdHelper());
+        feedingDemo.getFTThresholdHelper(),
+        &feedingDemo);
+    }
+    else if (biteTree)
+    {
+      bool tilted = feedingDemo.isTiltFood(foodName);
+
+      behavior::Context context;
+      context.set("foodName", foodName);
+      context.set("tilted", tilted ? "true" : "false");
+      behavior::Status status = biteTree->run(context);
+      behavior::logTimings(context);
+      if (status != behavior::Status::SUCCESS)
+        ROS_WARN_STREAM("Restart from the beginning");
     }
     else
     {
@@ -170,8 +191,7 @@ void demo(
       // ===== IN FRONT OF PERSON =====
       ROS_INFO_STREAM("Move forque in front of person");
 
-      auto tiltFoods = feedingDemo.mTiltFoodNames;
-      bool tilted = (std::find(tiltFoods.begin(), tiltFoods.end(), foodName) != tiltFoods.end());
+      bool tilted = feedingDemo.isTiltFood(foodName);
 
       action::feedFoodToPerson(
         ada,
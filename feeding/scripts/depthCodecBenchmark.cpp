@@ -0,0 +1,134 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "feeding/DepthCodec.hpp"
+
+///
+/// Compares the depth codec with PNG on recorded depth images.
+///
+/// Usage: depth_codec_benchmark <depth image directory>...
+///
+/// Every 16UC1 PNG in the given directories (e.g. the depth/ directories
+/// written by the DataCollector) is encoded with PNG at the collector's
+/// compression levels and with the depth codec, and decoded again. The
+/// depth codec round trip is checked to be lossless.
+///
+
+namespace {
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+struct Result
+{
+  std::string name;
+  std::size_t numBytes = 0;
+  Milliseconds encodeTime{0};
+  Milliseconds decodeTime{0};
+};
+
+//==============================================================================
+template <typename Function>
+Milliseconds measure(Function function)
+{
+  auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::steady_clock::now() - start;
+}
+
+//==============================================================================
+void benchmarkPng(const cv::Mat& image, int compression, Result& result)
+{
+  std::vector<uchar> buffer;
+  result.encodeTime += measure([&] {
+    cv::imencode(
+        ".png", image, buffer, {cv::IMWRITE_PNG_COMPRESSION, compression});
+  });
+  result.numBytes += buffer.size();
+  result.decodeTime
+      += measure([&] { cv::imdecode(buffer, cv::IMREAD_UNCHANGED); });
+}
+
+//==============================================================================
+bool benchmarkDepthCodec(const cv::Mat& image, Result& result)
+{
+  std::vector<uchar> buffer;
+  result.encodeTime += measure([&] { feeding::encodeDepth(image, buffer); });
+  result.numBytes += buffer.size();
+
+  cv::Mat decoded;
+  result.decodeTime += measure([&] {
+    feeding::decodeDepth(buffer.data(), buffer.size(), decoded);
+  });
+  return cv::countNonZero(image != decoded) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <depth image directory>..."
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<Result> results(3);
+  results[0].name = "png level 1";
+  results[1].name = "png default";
+  results[2].name = feeding::depthcodec::FORMAT;
+
+  std::size_t numImages = 0;
+  std::size_t numRawBytes = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    using namespace boost::filesystem;
+    for (directory_iterator it(argv[i]); it != directory_iterator(); ++it)
+    {
+      if (it->path().extension() != ".png")
+        continue;
+
+      cv::Mat image = cv::imread(it->path().string(), cv::IMREAD_UNCHANGED);
+      if (image.type() != CV_16UC1)
+        continue;
+
+      benchmarkPng(image, 1, results[0]);
+      benchmarkPng(image, -1, results[1]);
+      if (!benchmarkDepthCodec(image, results[2]))
+      {
+        std::cerr << "Depth codec round trip failed for " << it->path()
+                  << std::endl;
+        return 1;
+      }
+
+      ++numImages;
+      numRawBytes += image.total() * image.elemSize();
+    }
+  }
+
+  if (numImages == 0)
+  {
+    std::cerr << "No 16UC1 PNG images found." << std::endl;
+    return 1;
+  }
+
+  std::cout << numImages << " depth images, " << numRawBytes / numImages
+            << " raw bytes each" << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  for (const auto& result : results)
+  {
+    std::cout << std::setw(12) << result.name << ": ratio "
+              << static_cast<double>(numRawBytes) / result.numBytes
+              << ", encode " << result.encodeTime.count() / numImages
+              << "ms, decode " << result.decodeTime.count() / numImages
+              << "ms per image" << std::endl;
+  }
+  return 0;
+}
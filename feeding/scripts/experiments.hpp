@@ -13,6 +13,8 @@ void acquisition(
     FeedingDemo& feedingDemo,
     ros::NodeHandle nodeHandle);
 
+void buildRoadmap(FeedingDemo& feedingDemo, ros::NodeHandle nodeHandle);
+
 void bite_location_detector(
     FeedingDemo& feedingDemo,
     FTThresholdHelper& ftThresholdHelper,
@@ -12,6 +12,7 @@
 #include "feeding/action/MoveAbove.hpp"
 #include "feeding/action/MoveInFrontOfPerson.hpp"
 #include "feeding/action/MoveDirectlyToPerson.hpp"
+#include "feeding/behavior/BiteTree.hpp"
 #include <cstdlib>
 #include <ctime>
 
@@ -34,6 +35,12 @@ void humanStudyDemo(
 
   //talk("Hello, my name is aid uh. It's my pleasure to serve you today!");
 
+  bool useBehaviorTree;
+  nodeHandle->param<bool>("/behavior/enabled", useBehaviorTree, false);
+  behavior::NodePtr biteTree;
+  if (useBehaviorTree)
+    biteTree = behavior::createBiteTree(feedingDemo, perception, *nodeHandle);
+
   while (true)
   {
     if (feedingDemo.getFTThresholdHelper())
@@ -56,6 +63,20 @@ void humanStudyDemo(
       foodName = std::string("strawberry");
     }
     */
+
+    bool tilted = feedingDemo.isTiltFood(foodName);
+
+    if (biteTree)
+    {
+      behavior::Context context;
+      context.set("foodName", foodName);
+      context.set("tilted", tilted ? "true" : "false");
+      behavior::Status status = biteTree->run(context);
+      behavior::logTimings(context);
+      if (status != behavior::Status::SUCCESS)
+        ROS_WARN_STREAM("Restart from the beginning");
+      continue;
+    }
     
       bool skewer = action::skewer(
         ada,
@@ -99,9 +120,6 @@ void humanStudyDemo(
       if (feedingDemo.getFTThresholdHelper())
         feedingDemo.getFTThresholdHelper()->setThresholds(STANDARD_FT_THRESHOLD);
 
-      // TODO: Set tilted explcitly for long food items:
-      bool tilted = (foodName == "celery" || foodName == "carrot" || foodName == "bell_pepper" || foodName == "apple");
-
       action::feedFoodToPerson(
         ada,
         workspace,
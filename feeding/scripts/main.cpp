@@ -7,6 +7,7 @@
 
 #include "feeding/FTThresholdHelper.hpp"
 #include "feeding/FeedingDemo.hpp"
+#include "feeding/ParameterSnapshot.hpp"
 #include "feeding/util.hpp"
 #include "feeding/perception/Perception.hpp"
 // #include "feeding/DataCollector.hpp"
@@ -97,13 +98,16 @@ int main(int argc, char** argv)
   ros::AsyncSpinner spinner(2); // 2 threads
   spinner.start();
 
+  // Parameters read by the actions, shared so they are refreshed together.
+  auto parameters = std::make_shared<ParameterSnapshot>(*nodeHandle);
+
   std::shared_ptr<FTThresholdHelper> ftThresholdHelper = nullptr;
 
   if (useFTSensingToStopTrajectories)
   {
     std::cout << "Construct FTThresholdHelper" << std::endl;
     ftThresholdHelper = std::make_shared<FTThresholdHelper>(
-    adaReal && useFTSensingToStopTrajectories, *nodeHandle);
+    adaReal && useFTSensingToStopTrajectories, *nodeHandle, parameters);
   }
 
   // start demo
@@ -114,7 +118,8 @@ int main(int argc, char** argv)
     useVisualServo,
     allowRotationFree,
     ftThresholdHelper,
-    autoContinueDemo);
+    autoContinueDemo,
+    parameters);
 
   std::shared_ptr<TargetFoodRanker> ranker;
 
@@ -133,7 +138,8 @@ int main(int argc, char** argv)
       nodeHandle,
       ranker,
       0.0,
-      false);
+      false,
+      parameters);
 
   if (ftThresholdHelper)
     ftThresholdHelper->init();
@@ -145,10 +151,14 @@ int main(int argc, char** argv)
   ROS_INFO_STREAM("Startup complete."); 
 
   // Init ROS topics
-  initTopics(nodeHandle.get());
+  initTopics(nodeHandle.get(), adaReal, parameters);
 
   // Start Demo
-  if (demoType == "spanet")
+  if (demoType == "buildRoadmap")
+  {
+    buildRoadmap(*feedingDemo, *nodeHandle);
+  }
+  else if (demoType == "spanet")
   {
     spanetDemo(*feedingDemo, perception, *nodeHandle);
   }
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <aikido/statespace/GeodesicInterpolator.hpp>
+#include <aikido/statespace/Rn.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
+
+#include "feeding/Retimer.hpp"
+#include "feeding/TrajectoryDump.hpp"
+
+///
+/// Compares the retimers of the Retimer on recorded paths.
+///
+/// Usage: retimer_benchmark <velocity limit> <acceleration limit>
+///        <trajectory dump>...
+///
+/// Every trajectory in the given dumps (see /trajectoryDump/file) is turned
+/// back into a path by keeping the samples where it bends, and timed with
+/// each retimer option under the same limit for every joint. Prints the
+/// duration and compute time per option, and the option the Retimer would
+/// choose most often for each motion label.
+///
+
+namespace {
+
+/// Largest distance of a dropped sample from the path, in rad.
+const double PATH_TOLERANCE = 1e-3;
+
+struct Statistics
+{
+  double duration = 0;
+  double computeTime = 0;
+  std::size_t numWithinLimits = 0;
+  std::size_t numFailed = 0;
+  std::size_t numFastest = 0;
+};
+
+//==============================================================================
+/// Returns the distance of \c point from the segment from \c from to \c to.
+double getDistanceToSegment(
+    const Eigen::VectorXd& point,
+    const Eigen::VectorXd& from,
+    const Eigen::VectorXd& to)
+{
+  Eigen::VectorXd segment = to - from;
+  double squaredLength = segment.squaredNorm();
+  double t = squaredLength > 0 ? (point - from).dot(segment) / squaredLength
+                               : 0;
+  t = std::min(std::max(t, 0.0), 1.0);
+  return (point - (from + t * segment)).norm();
+}
+
+//==============================================================================
+/// Keeps the samples of \c positions (one per row) where the path bends.
+std::vector<Eigen::VectorXd> getWaypoints(const Eigen::MatrixXd& positions)
+{
+  std::vector<Eigen::VectorXd> waypoints{positions.row(0).transpose()};
+  int last = 0;
+  for (int i = 2; i < positions.rows(); ++i)
+  {
+    Eigen::VectorXd to = positions.row(i).transpose();
+    for (int j = last + 1; j < i; ++j)
+    {
+      if (getDistanceToSegment(
+              positions.row(j).transpose(), waypoints.back(), to)
+          > PATH_TOLERANCE)
+      {
+        last = i - 1;
+        waypoints.push_back(positions.row(last).transpose());
+        break;
+      }
+    }
+  }
+  Eigen::VectorXd end = positions.row(positions.rows() - 1).transpose();
+  if ((end - waypoints.back()).norm() > 0)
+    waypoints.push_back(end);
+  return waypoints;
+}
+
+//==============================================================================
+std::unique_ptr<aikido::trajectory::Interpolated> createPath(
+    const std::vector<Eigen::VectorXd>& waypoints)
+{
+  using aikido::statespace::Rn;
+  auto space = std::make_shared<Rn>(waypoints.front().size());
+  auto path = std::unique_ptr<aikido::trajectory::Interpolated>(
+      new aikido::trajectory::Interpolated(
+          space,
+          std::make_shared<aikido::statespace::GeodesicInterpolator>(space)));
+  auto state = space->createState();
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    space->setValue(state, waypoints[i]);
+    path->addWaypoint(i, state);
+  }
+  return path;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " <velocity limit> <acceleration limit> <trajectory dump>..."
+              << std::endl;
+    return 1;
+  }
+
+  const double velocityLimit = std::atof(argv[1]);
+  const double accelerationLimit = std::atof(argv[2]);
+  feeding::Retimer retimer(feeding::Retimer::getDefaultOptions());
+  const auto& options = retimer.getOptions();
+
+  std::vector<Statistics> statistics(options.size());
+  // Number of times each option was the fastest, per motion label.
+  std::map<std::string, std::vector<std::size_t>> fastestByLabel;
+  std::size_t numPaths = 0;
+  for (int i = 3; i < argc; ++i)
+  {
+    feeding::TrajectoryDumpReader reader(argv[i]);
+    for (std::size_t j = 0; j < reader.getNumTrajectories(); ++j)
+    {
+      auto trajectory = reader.getTrajectory(j);
+      if (trajectory.positions.rows() < 2)
+        continue;
+
+      auto waypoints = getWaypoints(trajectory.positions);
+      if (waypoints.size() < 2)
+        continue;
+      auto path = createPath(waypoints);
+      Eigen::VectorXd velocityLimits
+          = Eigen::VectorXd::Constant(waypoints.front().size(), velocityLimit);
+      Eigen::VectorXd accelerationLimits = Eigen::VectorXd::Constant(
+          waypoints.front().size(), accelerationLimit);
+
+      auto results
+          = retimer.compare(*path, velocityLimits, accelerationLimits);
+      const feeding::Retimer::Result* fastest = nullptr;
+      for (const auto& result : results)
+      {
+        auto& stats = statistics[result.option];
+        stats.computeTime += result.computeTime;
+        if (!result.trajectory)
+        {
+          ++stats.numFailed;
+          continue;
+        }
+        stats.duration += result.duration;
+        if (!result.isWithinLimits)
+          continue;
+        ++stats.numWithinLimits;
+        if (!fastest || result.duration < fastest->duration)
+          fastest = &result;
+      }
+
+      auto& fastestCounts = fastestByLabel[trajectory.label];
+      fastestCounts.resize(options.size());
+      if (fastest)
+      {
+        ++statistics[fastest->option].numFastest;
+        ++fastestCounts[fastest->option];
+      }
+      ++numPaths;
+    }
+  }
+
+  if (numPaths == 0)
+  {
+    std::cerr << "No trajectories found." << std::endl;
+    return 1;
+  }
+
+  std::cout << numPaths << " paths" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  for (std::size_t i = 0; i < options.size(); ++i)
+  {
+    const auto& stats = statistics[i];
+    std::size_t numTimed = numPaths - stats.numFailed;
+    std::cout << std::setw(18) << options[i].name << ": duration "
+              << (numTimed ? stats.duration / numTimed : 0) << "s, compute "
+              << stats.computeTime / numPaths * 1000 << "ms per path, "
+              << stats.numWithinLimits << " within limits, "
+              << stats.numFailed << " failed, fastest "
+              << stats.numFastest << " times" << std::endl;
+  }
+
+  std::cout << "Fastest retimer per motion:" << std::endl;
+  for (const auto& entry : fastestByLabel)
+  {
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < entry.second.size(); ++i)
+    {
+      if (entry.second[i] > entry.second[best])
+        best = i;
+    }
+    std::cout << "  " << entry.first << ": "
+              << (entry.second[best] ? options[best].name : "none")
+              << std::endl;
+  }
+  return 0;
+}
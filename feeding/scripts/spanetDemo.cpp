@@ -1,13 +1,10 @@
 
 #include <ros/ros.h>
-#include <libada/util.hpp>
 
 #include "feeding/FeedingDemo.hpp"
 #include "feeding/util.hpp"
 #include "feeding/action/Skewer.hpp"
 
-using ada::util::waitForUser;
-
 namespace feeding {
 
 void spanetDemo(
@@ -25,7 +22,7 @@ void spanetDemo(
 
   while (true)
   {
-    waitForUser("next step?", ada);
+    feedingDemo.waitForUser("next step?");
 
     nodeHandle.setParam("/deep_pose/forceFood", false);
     nodeHandle.setParam("/deep_pose/publish_spanet", (true));
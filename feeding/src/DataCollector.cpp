@@ -1,8 +1,13 @@
 #include "feeding/DataCollector.hpp"
 
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <sstream>
 
+#include <aikido/planner/kunzretimer/KunzRetimer.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
 #include <boost/date_time.hpp>
 #include <boost/filesystem/path.hpp>
 #include <stdlib.h>
@@ -11,12 +16,16 @@
 #include <libada/util.hpp>
 
 #include "boost/date_time/posix_time/posix_time.hpp"
+#include "feeding/Retimer.hpp"
 
 using ada::util::createBwMatrixForTSR;
 using ada::util::createIsometry;
 using ada::util::getRosParam;
 using ada::util::waitForUser;
 using aikido::constraint::dart::TSR;
+using aikido::planner::kunzretimer::computeKunzTiming;
+using aikido::trajectory::Interpolated;
+using aikido::trajectory::Spline;
 
 namespace {
 
@@ -41,6 +50,45 @@ TSR getSideViewTSR(int step)
   tsr.mBw = createBwMatrixForTSR(0.001, 0.001, 0, 0);
   return tsr;
 }
+
+// Meters of end effector travel that count as much as one radian of
+// rotation when ordering views.
+static const double ROTATION_WEIGHT = 0.1;
+
+// Orders side view steps greedily by end effector travel from \c current.
+// The views are close together, so task space travel is a good proxy for
+// joint travel and needs no IK.
+std::vector<int> orderSideViews(
+    std::vector<int> steps, Eigen::Isometry3d current)
+{
+  std::vector<int> order;
+  while (!steps.empty())
+  {
+    auto nearest = steps.begin();
+    double nearestDistance = std::numeric_limits<double>::infinity();
+    Eigen::Isometry3d nearestPose;
+    for (auto it = steps.begin(); it != steps.end(); ++it)
+    {
+      auto tsr = getSideViewTSR(*it);
+      Eigen::Isometry3d pose = tsr.mT0_w * tsr.mTw_e;
+      double rotation = Eigen::AngleAxisd(
+                            current.linear().transpose() * pose.linear())
+                            .angle();
+      double distance = (pose.translation() - current.translation()).norm()
+                        + ROTATION_WEIGHT * rotation;
+      if (distance < nearestDistance)
+      {
+        nearest = it;
+        nearestDistance = distance;
+        nearestPose = pose;
+      }
+    }
+    order.push_back(*nearest);
+    steps.erase(nearest);
+    current = nearestPose;
+  }
+  return order;
+}
 } // namespace
 namespace feeding {
 
@@ -102,6 +150,23 @@ void DataCollector::infoCallback(
 
   std::string folder = imageType == COLOR ? "color" : "depth";
 
+  // openDataset() and closeDataset() replace the dataset meanwhile.
+  if (auto dataset = std::atomic_load(&mDataset))
+  {
+    CameraIntrinsics intrinsics;
+    intrinsics.width = msg->width;
+    intrinsics.height = msg->height;
+    for (std::size_t i = 0; i < 9; i++)
+      intrinsics.K(i / 3, i % 3) = msg->K[i];
+    dataset->appendCameraInfo(folder, msg->header.stamp.toSec(), intrinsics);
+
+    if (imageType == COLOR)
+      mShouldRecordColorInfo.store(false);
+    else
+      mShouldRecordDepthInfo.store(false);
+    return;
+  }
+
   if (mShouldRecordColorInfo.load() || mShouldRecordColorInfo.load())
   {
     ROS_INFO("recording camera info!");
@@ -141,70 +206,51 @@ void DataCollector::infoCallback(
 void DataCollector::imageCallback(
     const sensor_msgs::ImageConstPtr& msg, ImageType imageType)
 {
-  if (imageType == COLOR && !mShouldRecordColorImage.load())
-    return;
-  if (imageType == DEPTH && !mShouldRecordDepthImage.load())
+  if (!mCapture->isPending())
     return;
 
-  std::string folder = imageType == COLOR ? "color" : "depth";
-  std::lock_guard<std::mutex> lock(mCallbackLock);
-
-  if (mShouldRecordColorImage.load() || mShouldRecordDepthImage.load())
+  // Shares the message data when no conversion is needed; the writer keeps
+  // the message alive until the image is on disk.
+  try
   {
-
-    if (imageType == COLOR)
+    if (imageType == ImageType::COLOR)
     {
-      mShouldRecordColorImage.store(false);
+      mCapture->addColor(
+          cv_bridge::toCvShare(msg, sensor_msgs::image_encodings::BGR8));
     }
     else
     {
-      mShouldRecordDepthImage.store(false);
-    }
-    ROS_INFO("recording image!");
-
-    cv_bridge::CvImagePtr cv_ptr;
-    try
-    {
-      if (imageType == ImageType::COLOR)
-      {
-        cv_ptr = cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::BGR8);
-      }
-      else
-      {
-        cv_ptr = cv_bridge::toCvCopy(
-            msg, sensor_msgs::image_encodings::TYPE_16UC1);
-      }
-    }
-    catch (cv_bridge::Exception& e)
-    {
-      ROS_ERROR("cv_bridge exception: %s", e.what());
-      return;
+      mCapture->addDepth(
+          cv_bridge::toCvShare(msg, sensor_msgs::image_encodings::TYPE_16UC1));
     }
+  }
+  catch (cv_bridge::Exception& e)
+  {
+    ROS_ERROR("cv_bridge exception: %s", e.what());
+  }
+}
 
-    auto count = imageType == COLOR ? mColorImageCount.load()
-                                    : mDepthImageCount.load();
+//==============================================================================
+void DataCollector::jointStateCallback(
+    const sensor_msgs::JointState::ConstPtr& msg)
+{
+  if (msg->velocity.empty())
+    return;
 
-    std::string imageFile = mDataCollectionPath + folder + +"/image_"
-                            + std::to_string(count) + ".png";
-    bool worked = cv::imwrite(imageFile, cv_ptr->image);
-    std::cout << "Trying to save at " << imageFile << std::endl;
+  double maxVelocity = 0;
+  for (double velocity : msg->velocity)
+    maxVelocity = std::max(maxVelocity, std::abs(velocity));
 
-    if (imageType == COLOR)
-    {
-      mColorImageCount++;
-      mShouldRecordColorImage.store(false);
-    }
-    else
-    {
-      mDepthImageCount++;
-      mShouldRecordDepthImage.store(false);
-    }
+  if (maxVelocity > mSettledVelocity)
+    mSettledSince.store(std::numeric_limits<double>::infinity());
+  else if (std::isinf(mSettledSince.load()))
+    mSettledSince.store(msg->header.stamp.toSec());
+}
 
-    if (worked)
-      ROS_INFO_STREAM("image saved to " << imageFile);
-    else
-      ROS_WARN_STREAM("image saving failed");
-  }
+//==============================================================================
+bool DataCollector::isSettledAt(const ros::Time& stamp) const
+{
+  return stamp.toSec() >= mSettledSince.load() + mSettleTime;
 }
 
 //==============================================================================
@@ -223,8 +269,7 @@ DataCollector::DataCollector(
   , mAdaReal(adaReal)
   , mDataCollectionPath{dataCollectionPath}
   , mPerceptionReal{perceptionReal}
-  , mShouldRecordColorImage{false}
-  , mShouldRecordDepthImage{false}
+  , mUseDataset{false}
   , mShouldRecordColorInfo{false}
   , mShouldRecordDepthInfo{false}
   , mCurrentFood{0}
@@ -232,6 +277,7 @@ DataCollector::DataCollector(
   , mCurrentTrial{0}
   , mColorImageCount{0}
   , mDepthImageCount{0}
+  , mSettledSince{0}
 {
   // See if we can save force/torque sensor data as well.
 
@@ -247,9 +293,59 @@ DataCollector::DataCollector(
       = getRosParam<std::vector<double>>("/data/directions", mNodeHandle);
   mAngleNames
       = getRosParam<std::vector<std::string>>("/data/angleNames", mNodeHandle);
+  mNodeHandle.param<bool>("/data/dataset/enabled", mUseDataset, false);
 
   if (mAdaReal || mPerceptionReal)
   {
+    int numWriterThreads;
+    int writerQueueSize;
+    mNodeHandle.param<int>("/data/imageWriter/numThreads", numWriterThreads, 2);
+    mNodeHandle.param<int>("/data/imageWriter/queueSize", writerQueueSize, 8);
+    mImageWriter = std::unique_ptr<ImageWriter>(
+        new ImageWriter(numWriterThreads, writerQueueSize));
+
+    for (const std::string stream : {"color", "depth"})
+    {
+      ImageStreamConfig config;
+      mNodeHandle.param<std::string>(
+          "/data/imageWriter/" + stream + "/format", config.format, "png");
+      mNodeHandle.param<int>(
+          "/data/imageWriter/" + stream + "/compression",
+          config.compression,
+          -1);
+      if (stream == "depth"
+          && (config.format == "jpg" || config.format == "jpeg"))
+      {
+        ROS_WARN_STREAM("Depth images need a lossless format, using png.");
+        config.format = "png";
+      }
+      if (stream == "color" && config.format == depthcodec::FORMAT)
+      {
+        ROS_WARN_STREAM(
+            depthcodec::FORMAT << " only encodes depth images, using png.");
+        config.format = "png";
+      }
+      mImageWriter->setStreamConfig(stream, config);
+    }
+
+    double maxStampDifference;
+    double captureTimeout;
+    std::string jointStateTopic;
+    mNodeHandle.param<double>(
+        "/data/capture/maxStampDifference", maxStampDifference, 0.02);
+    mNodeHandle.param<double>("/data/capture/timeout", captureTimeout, 10.0);
+    mNodeHandle.param<double>(
+        "/data/capture/settledVelocity", mSettledVelocity, 0.01);
+    mNodeHandle.param<double>("/data/capture/settleTime", mSettleTime, 0.2);
+    mNodeHandle.param<std::string>(
+        "/data/capture/jointStateTopic", jointStateTopic, "/joint_states");
+    mCapture = std::unique_ptr<SynchronizedCapture>(
+        new SynchronizedCapture(maxStampDifference));
+    mCaptureTimeout = std::chrono::milliseconds(
+        static_cast<int>(captureTimeout * 1000));
+    mJointStateSub = mNodeHandle.subscribe(
+        jointStateTopic, 10, &DataCollector::jointStateCallback, this);
+
     image_transport::ImageTransport it(mNodeHandle);
     sub = it.subscribe(
         "/camera/color/image_raw",
@@ -267,6 +363,9 @@ DataCollector::DataCollector(
         "/camera/aligned_depth_to_color/camera_info",
         1,
         boost::bind(&DataCollector::infoCallback, this, _1, ImageType::DEPTH));
+
+    mTrialRecorder = std::unique_ptr<TrialRecorder>(
+        new TrialRecorder(mNodeHandle));
   }
 
   mPlanningTimeout
@@ -278,6 +377,20 @@ DataCollector::DataCollector(
       "/planning/endEffectorOffset/positionTolerance", mNodeHandle),
   mEndEffectorOffsetAngularTolerance = getRosParam<double>(
       "/planning/endEffectorOffset/angularTolerance", mNodeHandle);
+
+  mPlanningPortfolio = mFeedingDemo->getPlanningPortfolio();
+  if (!mPlanningPortfolio)
+  {
+    auto workspace = mFeedingDemo->getWorkspace();
+    mPlanningPortfolio = std::make_shared<PlanningPortfolio>(
+        mAda,
+        mFeedingDemo->getCollisionConstraint(),
+        std::vector<dart::dynamics::ConstSkeletonPtr>{
+            workspace->getTable(),
+            workspace->getWorkspaceEnvironment(),
+            workspace->getWheelchair()},
+        mNodeHandle);
+  }
 }
 
 //==============================================================================
@@ -343,8 +456,18 @@ void DataCollector::collect(
   std::string trialName = ActionToString.at(action) + "/" + foodName + "-angle-"
                           + mAngleNames[directionIndex] + "-trial-"
                           + std::to_string(trialIndex);
+  if (mUseDataset)
+  {
+    openDataset(mDataCollectionPath, ActionToString.at(action), trialName);
+    createDirectory(mDataCollectionPath + ActionToString.at(action));
+    openTrialLog(mDataCollectionPath + trialName + ".log.yaml", trialName);
+  }
   mDataCollectionPath += trialName + "/";
-  setupDirectoryPerData(mDataCollectionPath);
+  if (!mUseDataset)
+  {
+    setupDirectoryPerData(mDataCollectionPath);
+    openTrialLog(mDataCollectionPath + "trial_log.yaml", trialName);
+  }
 
   auto foodIndex = std::distance(
       mFoods.begin(), std::find(mFoods.begin(), mFoods.end(), foodName));
@@ -360,6 +483,11 @@ void DataCollector::collect(
 
   setDataCollectionParams(foodIndex, directionIndex, trialIndex);
 
+  if (mTrialRecorder && mDataset)
+    mTrialRecorder->start(mDataset);
+  else if (mTrialRecorder)
+    mTrialRecorder->start(mDataCollectionPath + "ft_joint_states.bin");
+
   ROS_INFO("Starting data collection");
 
   bool result;
@@ -377,6 +505,10 @@ void DataCollector::collect(
     if (!skewer(0, TiltStyle::VERTICAL))
     {
       ROS_INFO_STREAM("Terminating.");
+      if (mTrialRecorder)
+        mTrialRecorder->stop();
+      closeDataset();
+      closeTrialLog();
       return;
     }
   }
@@ -389,6 +521,10 @@ void DataCollector::collect(
     if (!skewer(0, TiltStyle::ANGLED))
     {
       ROS_INFO_STREAM("Terminating.");
+      if (mTrialRecorder)
+        mTrialRecorder->stop();
+      closeDataset();
+      closeTrialLog();
       return;
     }
   }
@@ -397,13 +533,21 @@ void DataCollector::collect(
     mFeedingDemo->scoop();
   }
 
+  if (mTrialRecorder)
+    mTrialRecorder->stop();
+  finishImageWrites();
+
   if (!result)
   {
     ROS_INFO_STREAM("Terminating.");
+    closeDataset();
+    closeTrialLog();
     return;
   }
 
   recordSuccess();
+  closeDataset();
+  closeTrialLog();
 
   ROS_INFO_STREAM("Terminating.");
   return;
@@ -414,13 +558,23 @@ void DataCollector::collect_images(const std::string& foodName)
 {
   ROS_INFO_STREAM("Collect images for " << foodName);
 
-  mDataCollectionPath = mDataCollectionPath + "/" + foodName + "/";
-  setupDirectoryPerData(mDataCollectionPath);
-  setDataCollectionParams(0, 0, 0);
+  if (mUseDataset)
+  {
+    // Every run appends a trial, so images need no numbering from disk.
+    openDataset(
+        mDataCollectionPath, ActionToString.at(IMAGE_ONLY), foodName);
+    setDataCollectionParams(0, 0, 0);
+  }
+  else
+  {
+    mDataCollectionPath = mDataCollectionPath + "/" + foodName + "/";
+    setupDirectoryPerData(mDataCollectionPath);
+    setDataCollectionParams(0, 0, 0);
 
-  ROS_INFO_STREAM("Update image counts");
-  updateImageCounts(mDataCollectionPath, ImageType::COLOR);
-  updateImageCounts(mDataCollectionPath, ImageType::DEPTH);
+    ROS_INFO_STREAM("Update image counts");
+    updateImageCounts(mDataCollectionPath, ImageType::COLOR);
+    updateImageCounts(mDataCollectionPath, ImageType::DEPTH);
+  }
 
   // Move above food (center of plate)
   ROS_INFO_STREAM("Move above food");
@@ -431,6 +585,7 @@ void DataCollector::collect_images(const std::string& foodName)
           TiltStyle::NONE))
   {
     ROS_ERROR("Rotate Forque failed. Restart.");
+    closeDataset();
     return;
   }
 
@@ -448,6 +603,7 @@ void DataCollector::collect_images(const std::string& foodName)
           mEndEffectorOffsetAngularTolerance))
   {
     ROS_ERROR("Rotate Forque failed. Restart.");
+    closeDataset();
     return;
   }
 
@@ -457,26 +613,12 @@ void DataCollector::collect_images(const std::string& foodName)
   // Modification of calibration viewpoints.
   ROS_INFO_STREAM("Rotate around.");
 
+  std::vector<int> steps;
   for (int i = 0; i < 100; i += 10)
-  {
-    auto tsr = getSideViewTSR(i);
-
-    // auto marker = mFeedingDemo->getViewer()->addTSRMarker(tsr);
-    // mFeedingDemo->waitForUser("Check");
-
-    if (!mFeedingDemo->getAda()->moveArmToTSR(
-            tsr,
-            mFeedingDemo->getCollisionConstraint(),
-            mPlanningTimeout,
-            mMaxNumPlanningTrials))
-    {
-      ROS_INFO_STREAM("Fail: Step " << i);
-    }
-    else
-    {
-      captureFrame();
-    }
-  }
+    steps.push_back(i);
+  sweepViews(steps);
+  finishImageWrites();
+  closeDataset();
   return;
 }
 
@@ -491,7 +633,12 @@ bool DataCollector::skewer(float rotateForqueAngle, TiltStyle tiltStyle)
           tiltStyle))
   {
     ROS_ERROR("Rotate Forque failed. Restart.");
-    removeDirectory(mDataCollectionPath);
+    if (mTrialLog)
+      mTrialLog->logOutcome(ros::Time::now().toSec(), "aborted");
+    if (mDataset)
+      mDataset->appendOutcome(ros::Time::now().toSec(), "aborted");
+    else
+      removeDirectory(mDataCollectionPath);
     return false;
   }
   captureFrame();
@@ -510,6 +657,10 @@ bool DataCollector::skewer(float rotateForqueAngle, TiltStyle tiltStyle)
     direction.normalize();
   }
 
+  auto successClassifier = mFeedingDemo->getSkewerSuccessClassifier();
+  if (successClassifier)
+    successClassifier->recordBaseline();
+
   mFeedingDemo->moveInto(TargetItem::FOOD, tiltStyle, direction);
   captureFrame();
 
@@ -537,7 +688,35 @@ void DataCollector::recordSuccess()
 
   std::vector<std::string> optionPrompts{
       "(1) success", "(2) fail", "(3) delete"};
-  auto input = getUserInputWithOptions(optionPrompts, "Did I succeed?");
+
+  int input = 0;
+  auto successClassifier = mFeedingDemo->getSkewerSuccessClassifier();
+  if (successClassifier)
+  {
+    auto result = successClassifier->classify(food);
+    if (result.isConfident)
+      input = result.success ? 1 : 2;
+  }
+  if (input == 0)
+    input = getUserInputWithOptions(optionPrompts, "Did I succeed?");
+
+  if (mTrialLog)
+  {
+    mTrialLog->logOutcome(
+        ros::Time::now().toSec(),
+        input == 1 ? "success" : input == 2 ? "fail" : "deleted");
+  }
+
+  if (mDataset)
+  {
+    // Deleted trials stay in the file, labeled so readers skip them.
+    std::string label
+        = input == 1 ? "success" : input == 2 ? "fail" : "deleted";
+    ROS_INFO_STREAM("Recording " << label);
+    mDataset->appendOutcome(ros::Time::now().toSec(), label);
+    return;
+  }
+
   if (input == 1)
   {
     ROS_INFO("Recording success");
@@ -564,15 +743,284 @@ void DataCollector::recordSuccess()
 }
 
 //==============================================================================
-void DataCollector::captureFrame()
+std::future<CapturedFrames> DataCollector::requestCapture(bool waitUntilSettled)
+{
+  if (!mCapture)
+  {
+    // No camera: nothing to wait for.
+    std::promise<CapturedFrames> promise;
+    promise.set_value(CapturedFrames());
+    return promise.get_future();
+  }
+
+  SynchronizedCapture::ReadyPredicate isReady;
+  if (waitUntilSettled)
+    isReady = [this](const ros::Time& stamp) { return isSettledAt(stamp); };
+
+  return mCapture->request(
+      [this](const CapturedFrames& frames) { return storeFrames(frames); },
+      isReady);
+}
+
+//==============================================================================
+bool DataCollector::captureFrame()
+{
+  auto start = std::chrono::steady_clock::now();
+  auto frames = requestCapture();
+  if (frames.wait_for(mCaptureTimeout) != std::future_status::ready)
+  {
+    mCapture->cancel();
+    ROS_WARN_STREAM(
+        "No synchronized color and depth images within "
+        << mCaptureTimeout.count() << "ms");
+    return false;
+  }
+
+  std::chrono::duration<double, std::milli> captureTime
+      = std::chrono::steady_clock::now() - start;
+  ROS_INFO_STREAM("Captured frame in " << captureTime.count() << "ms");
+  return true;
+}
+
+//==============================================================================
+std::vector<DataCollector::ViewTiming> DataCollector::sweepViews(
+    const std::vector<int>& steps)
+{
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  using PlanResult = std::pair<aikido::trajectory::TrajectoryPtr, Milliseconds>;
+
+  auto arm = mAda->getArm();
+  auto space = arm->getStateSpace();
+  auto order = orderSideViews(
+      steps, mAda->getHand()->getEndEffectorBodyNode()->getTransform());
+
+  auto plan = [this](int step, Eigen::VectorXd start) {
+    auto planStart = Clock::now();
+    auto trajectory = planToView(step, start);
+    return PlanResult(trajectory, Clock::now() - planStart);
+  };
+
+  auto sweepStart = Clock::now();
+  Eigen::VectorXd start = arm->getMetaSkeleton()->getPositions();
+  std::future<PlanResult> nextPlan;
+  if (!order.empty())
+    nextPlan = std::async(std::launch::async, plan, order[0], start);
+
+  std::vector<ViewTiming> timings;
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    ViewTiming timing;
+    timing.step = order[i];
+
+    auto waitStart = Clock::now();
+    auto planned = nextPlan.get();
+    timing.waitTime = Clock::now() - waitStart;
+    timing.planTime = planned.second;
+    auto trajectory = planned.first;
+
+    // The next view starts where this one ends, or where the arm is now if
+    // this one could not be planned.
+    if (trajectory)
+    {
+      auto end = space->createState();
+      trajectory->evaluate(trajectory->getEndTime(), end);
+      space->convertStateToPositions(end, start);
+    }
+    if (i + 1 < order.size())
+      nextPlan = std::async(std::launch::async, plan, order[i + 1], start);
+
+    if (!trajectory)
+    {
+      ROS_INFO_STREAM("Fail: Step " << order[i]);
+      timings.push_back(timing);
+      continue;
+    }
+
+    auto dump = mFeedingDemo->getTrajectoryDump();
+    auto spline = dynamic_cast<const Spline*>(trajectory.get());
+    if (dump && spline)
+      dump->append(
+          *spline,
+          "view " + std::to_string(order[i]),
+          ros::Time::now().toSec());
+
+    auto executionStart = Clock::now();
+    try
+    {
+      mAda->getTrajectoryExecutor()->execute(trajectory).get();
+    }
+    catch (const std::exception& e)
+    {
+      // The plan of the next view assumed this one would be reached.
+      ROS_ERROR_STREAM("Step " << order[i] << " failed: " << e.what());
+      timings.push_back(timing);
+      break;
+    }
+    timing.executionTime = Clock::now() - executionStart;
+
+    auto captureStart = Clock::now();
+    timing.success = captureFrame();
+    timing.captureTime = Clock::now() - captureStart;
+    timings.push_back(timing);
+  }
+
+  Milliseconds sweepTime = Clock::now() - sweepStart;
+  ROS_INFO_STREAM(
+      "Swept " << timings.size() << " views in " << sweepTime.count()
+               << "ms");
+  for (const auto& timing : timings)
+  {
+    ROS_INFO_STREAM(
+        "  step " << timing.step << (timing.success ? "" : " (failed)")
+                  << ": plan " << timing.planTime.count() << "ms (waited "
+                  << timing.waitTime.count() << "ms), move "
+                  << timing.executionTime.count() << "ms, capture "
+                  << timing.captureTime.count() << "ms");
+  }
+  return timings;
+}
+
+//==============================================================================
+aikido::trajectory::TrajectoryPtr DataCollector::planToView(
+    int step, const Eigen::VectorXd& start)
 {
-  std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-  mCallbackLock.lock();
-  mShouldRecordColorImage.store(true);
-  mShouldRecordDepthImage.store(true);
-  mCallbackLock.unlock();
-  std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+  auto metaSkeleton = mAda->getArm()->getMetaSkeleton();
+
+  // The arm is still moving to the previous view, so the plan runs on a
+  // copy of the robot set to where that motion ends.
+  auto result = mPlanningPortfolio->plan(
+      std::vector<TSR>{getSideViewTSR(step)},
+      mPlanningTimeout,
+      mMaxNumPlanningTrials,
+      start);
+  auto interpolated = dynamic_cast<Interpolated*>(result.second.get());
+  if (!interpolated)
+    return nullptr;
+
+  return computeKunzTiming(
+      *interpolated,
+      metaSkeleton->getVelocityUpperLimits(),
+      metaSkeleton->getAccelerationUpperLimits(),
+      KUNZ_MAX_DEVIATION,
+      KUNZ_TIME_STEP);
 }
+
+//==============================================================================
+bool DataCollector::storeFrames(const CapturedFrames& frames)
+{
+  std::lock_guard<std::mutex> lock(mCallbackLock);
+
+  // Both or neither, so the color and depth indices stay aligned.
+  if (mImageWriter->getNumFreeSlots() < 2)
+  {
+    ROS_WARN_STREAM("Image writer is full, waiting for the next frames");
+    return false;
+  }
+
+  auto colorName = mDataCollectionPath + "color/image_"
+                   + std::to_string(mColorImageCount++);
+  auto depthName = mDataCollectionPath + "depth/image_"
+                   + std::to_string(mDepthImageCount++);
+  mImageWriter->tryWrite("color", colorName, frames.color);
+  mImageWriter->tryWrite("depth", depthName, frames.depth);
+  if (mTrialLog)
+  {
+    mTrialLog->logImage(
+        "color", frames.color->header.stamp.toSec(), colorName);
+    mTrialLog->logImage(
+        "depth", frames.depth->header.stamp.toSec(), depthName);
+  }
+  ROS_INFO_STREAM(
+      "Queued frame pair, " << mImageWriter->getQueueDepth()
+                            << " images pending");
+  return true;
+}
+
+//==============================================================================
+void DataCollector::finishImageWrites()
+{
+  if (!mImageWriter)
+    return;
+
+  mImageWriter->flush();
+  for (const std::string stream : {"color", "depth"})
+  {
+    auto statistics = mImageWriter->getStatistics(stream);
+    ROS_INFO_STREAM(
+        stream << " images: " << statistics.numWritten << " written, "
+               << statistics.numFailed << " failed, "
+               << statistics.numRejected << " retried, max queue depth "
+               << statistics.maxQueueDepth << ", encode time mean "
+               << statistics.meanEncodeTime.count() << "ms max "
+               << statistics.maxEncodeTime.count() << "ms");
+  }
+}
+
+//==============================================================================
+void DataCollector::openDataset(
+    const std::string& directory,
+    const std::string& action,
+    const std::string& trialName)
+{
+  createDirectory(directory);
+  auto filename = directory + "/" + action + ".dataset";
+  auto dataset = std::make_shared<DatasetWriter>(filename);
+  dataset->beginTrial(trialName, ros::Time::now().toSec());
+  std::atomic_store(&mDataset, dataset);
+  ROS_INFO_STREAM("Recording trial " << trialName << " to " << filename);
+
+  if (!mImageWriter)
+    return;
+
+  mImageWriter->setSink(
+      [dataset](
+          const std::string& stream,
+          const cv_bridge::CvImage& image,
+          const std::string& format,
+          const std::vector<uchar>& encoded) {
+        dataset->appendFrame(
+            stream, image.header.stamp.toSec(), image.image, format, encoded);
+        return true;
+      });
+}
+
+//==============================================================================
+void DataCollector::closeDataset()
+{
+  auto dataset = std::atomic_load(&mDataset);
+  if (!dataset)
+    return;
+
+  if (mImageWriter)
+  {
+    mImageWriter->flush();
+    mImageWriter->setSink(nullptr);
+  }
+  // The info callback may still hold the dataset; appending to a closed
+  // dataset does nothing.
+  std::atomic_store(&mDataset, std::shared_ptr<DatasetWriter>());
+  dataset->close();
+}
+
+//==============================================================================
+void DataCollector::openTrialLog(
+    const std::string& filename, const std::string& trialName)
+{
+  mTrialLog = std::make_shared<TrialLog>(filename, trialName);
+  mFeedingDemo->setTrialLog(mTrialLog);
+}
+
+//==============================================================================
+void DataCollector::closeTrialLog()
+{
+  if (!mTrialLog)
+    return;
+
+  mFeedingDemo->setTrialLog(nullptr);
+  mTrialLog.reset();
+}
+
 //==============================================================================
 void DataCollector::updateImageCounts(
     const std::string& directory, ImageType imageType)
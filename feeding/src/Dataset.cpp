@@ -0,0 +1,574 @@
+#include "feeding/Dataset.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <opencv2/imgcodecs.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "feeding/DepthCodec.hpp"
+
+namespace feeding {
+
+namespace {
+
+static const std::uint32_t NO_TRIAL = std::numeric_limits<std::uint32_t>::max();
+
+//==============================================================================
+std::size_t padded(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+//==============================================================================
+void copyName(char (&destination)[8], const std::string& name)
+{
+  std::memset(destination, 0, sizeof(destination));
+  std::memcpy(
+      destination, name.data(), std::min(name.size(), sizeof(destination)));
+}
+
+//==============================================================================
+std::string readName(const char (&name)[8])
+{
+  return std::string(name, strnlen(name, sizeof(name)));
+}
+
+//==============================================================================
+/// Maps \c filename read-only. Throws a runtime_error on failure.
+const char* mapFile(const std::string& filename, std::size_t& size)
+{
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Could not open " + filename);
+
+  struct stat fileStat;
+  if (::fstat(fd, &fileStat) != 0
+      || fileStat.st_size < static_cast<off_t>(sizeof(dataset::FileHeader)))
+  {
+    ::close(fd);
+    throw std::runtime_error(filename + " is not a dataset.");
+  }
+  size = static_cast<std::size_t>(fileStat.st_size);
+
+  void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error("Could not map " + filename);
+  return static_cast<const char*>(data);
+}
+
+//==============================================================================
+/// Returns true if \c entry describes a chunk that lies between the file
+/// header and \c indexOffset.
+bool isValidEntry(const dataset::IndexEntry& entry, std::size_t indexOffset)
+{
+  return entry.type >= dataset::TRIAL && entry.type <= dataset::OUTCOME
+         && entry.offset >= sizeof(dataset::FileHeader)
+         && entry.offset <= indexOffset
+         && indexOffset - entry.offset >= sizeof(dataset::ChunkHeader)
+         && entry.size
+                <= indexOffset - entry.offset - sizeof(dataset::ChunkHeader);
+}
+
+} // namespace
+
+namespace dataset {
+
+//==============================================================================
+std::size_t readIndex(
+    const char* data, std::size_t size, std::vector<IndexEntry>& index)
+{
+  index.clear();
+
+  const auto* header = reinterpret_cast<const FileHeader*>(data);
+  if (size < sizeof(FileHeader)
+      || std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0
+      || header->version != VERSION)
+  {
+    throw std::runtime_error("Not a dataset.");
+  }
+
+  // Complete file: use the stored index if every entry lies within the
+  // chunks.
+  if (size >= sizeof(FileHeader) + sizeof(Footer))
+  {
+    const auto* footer
+        = reinterpret_cast<const Footer*>(data + size - sizeof(Footer));
+    if (std::memcmp(footer->magic, FOOTER_MAGIC, sizeof(footer->magic)) == 0
+        && footer->indexOffset >= sizeof(FileHeader)
+        && footer->indexOffset <= size - sizeof(Footer)
+        && footer->numEntries
+               == (size - sizeof(Footer) - footer->indexOffset)
+                      / sizeof(IndexEntry)
+        && (size - sizeof(Footer) - footer->indexOffset) % sizeof(IndexEntry)
+               == 0)
+    {
+      const auto* entries
+          = reinterpret_cast<const IndexEntry*>(data + footer->indexOffset);
+      index.assign(entries, entries + footer->numEntries);
+      if (std::all_of(index.begin(), index.end(), [&](const IndexEntry& entry) {
+            return isValidEntry(entry, footer->indexOffset);
+          }))
+      {
+        return footer->indexOffset;
+      }
+      index.clear();
+    }
+  }
+
+  // No valid footer or index: walk the chunks up to the first incomplete one.
+  std::size_t offset = sizeof(FileHeader);
+  while (offset + sizeof(ChunkHeader) <= size)
+  {
+    const auto* chunk = reinterpret_cast<const ChunkHeader*>(data + offset);
+    std::size_t chunkSize = sizeof(ChunkHeader) + padded(chunk->size);
+    if (chunk->type < TRIAL || chunk->type > OUTCOME
+        || offset + chunkSize > size)
+    {
+      break;
+    }
+
+    IndexEntry entry;
+    entry.offset = offset;
+    entry.size = chunk->size;
+    entry.type = chunk->type;
+    entry.trial = chunk->trial;
+    entry.time = chunk->time;
+    index.push_back(entry);
+    offset += chunkSize;
+  }
+  return offset;
+}
+
+} // namespace dataset
+
+//==============================================================================
+DatasetWriter::DatasetWriter(const std::string& filename)
+  : mFile(nullptr), mOffset(0), mTrial(NO_TRIAL), mNumTrials(0)
+{
+  struct stat fileStat;
+  if (::stat(filename.c_str(), &fileStat) == 0 && fileStat.st_size > 0)
+  {
+    std::size_t size;
+    const char* data = mapFile(filename, size);
+    try
+    {
+      mOffset = dataset::readIndex(data, size, mIndex);
+    }
+    catch (const std::runtime_error&)
+    {
+      ::munmap(const_cast<char*>(data), size);
+      throw std::runtime_error(filename + " is not a dataset.");
+    }
+    ::munmap(const_cast<char*>(data), size);
+
+    for (const auto& entry : mIndex)
+    {
+      if (entry.type == dataset::TRIAL)
+        mNumTrials = std::max(mNumTrials, entry.trial + 1);
+    }
+
+    // Drop the old index (or a partial chunk); it is rewritten on close.
+    if (::truncate(filename.c_str(), mOffset) != 0)
+      throw std::runtime_error("Could not truncate " + filename);
+    mFile = std::fopen(filename.c_str(), "r+b");
+    if (mFile)
+      std::fseek(mFile, mOffset, SEEK_SET);
+  }
+  else
+  {
+    mFile = std::fopen(filename.c_str(), "wb");
+    if (mFile)
+    {
+      dataset::FileHeader header;
+      std::memcpy(header.magic, dataset::MAGIC, sizeof(header.magic));
+      header.version = dataset::VERSION;
+      header.reserved = 0;
+      std::fwrite(&header, sizeof(header), 1, mFile);
+      mOffset = sizeof(header);
+    }
+  }
+
+  if (!mFile)
+    throw std::runtime_error("Could not open " + filename);
+}
+
+//==============================================================================
+DatasetWriter::~DatasetWriter()
+{
+  close();
+}
+
+//==============================================================================
+std::uint32_t DatasetWriter::beginTrial(const std::string& name, double time)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mTrial = mNumTrials++;
+  appendChunk(dataset::TRIAL, time, nullptr, 0, name.data(), name.size());
+  return mTrial;
+}
+
+//==============================================================================
+void DatasetWriter::appendFrame(
+    const std::string& stream,
+    double time,
+    const cv::Mat& image,
+    const std::string& format,
+    const std::vector<uchar>& encoded)
+{
+  dataset::FrameHeader header;
+  copyName(header.stream, stream);
+  copyName(header.format, format);
+  header.width = image.cols;
+  header.height = image.rows;
+  header.cvType = image.type();
+  header.reserved = 0;
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  appendChunk(
+      dataset::FRAME,
+      time,
+      &header,
+      sizeof(header),
+      encoded.data(),
+      encoded.size());
+}
+
+//==============================================================================
+void DatasetWriter::appendCameraInfo(
+    const std::string& stream,
+    double time,
+    const CameraIntrinsics& intrinsics)
+{
+  dataset::CameraInfoRecord record;
+  copyName(record.stream, stream);
+  record.width = intrinsics.width;
+  record.height = intrinsics.height;
+  for (int i = 0; i < 9; ++i)
+    record.K[i] = intrinsics.K(i / 3, i % 3);
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  appendChunk(
+      dataset::CAMERA_INFO, time, &record, sizeof(record), nullptr, 0);
+}
+
+//==============================================================================
+void DatasetWriter::appendSensorRecords(
+    double time, const char* data, std::size_t size)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  appendChunk(dataset::SENSOR_RECORDS, time, nullptr, 0, data, size);
+}
+
+//==============================================================================
+void DatasetWriter::appendOutcome(double time, const std::string& label)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  appendChunk(dataset::OUTCOME, time, nullptr, 0, label.data(), label.size());
+}
+
+//==============================================================================
+void DatasetWriter::close()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mFile)
+    return;
+
+  dataset::Footer footer;
+  footer.indexOffset = mOffset;
+  footer.numEntries = mIndex.size();
+  std::memcpy(footer.magic, dataset::FOOTER_MAGIC, sizeof(footer.magic));
+
+  std::fwrite(
+      mIndex.data(), sizeof(dataset::IndexEntry), mIndex.size(), mFile);
+  std::fwrite(&footer, sizeof(footer), 1, mFile);
+  std::fclose(mFile);
+  mFile = nullptr;
+}
+
+//==============================================================================
+void DatasetWriter::appendChunk(
+    dataset::ChunkType type,
+    double time,
+    const void* header,
+    std::size_t headerSize,
+    const void* data,
+    std::size_t size)
+{
+  if (!mFile)
+    return;
+
+  // Chunks written before the first trial get an unnamed one.
+  if (type != dataset::TRIAL && mTrial == NO_TRIAL)
+  {
+    mTrial = mNumTrials++;
+    appendChunk(dataset::TRIAL, time, nullptr, 0, nullptr, 0);
+  }
+
+  dataset::ChunkHeader chunk;
+  chunk.type = type;
+  chunk.trial = mTrial;
+  chunk.size = headerSize + size;
+  chunk.time = time;
+
+  static const char padding[8] = {0};
+  std::size_t paddingSize = padded(chunk.size) - chunk.size;
+  std::fwrite(&chunk, sizeof(chunk), 1, mFile);
+  if (headerSize > 0)
+    std::fwrite(header, 1, headerSize, mFile);
+  if (size > 0)
+    std::fwrite(data, 1, size, mFile);
+  std::fwrite(padding, 1, paddingSize, mFile);
+
+  dataset::IndexEntry entry;
+  entry.offset = mOffset;
+  entry.size = chunk.size;
+  entry.type = chunk.type;
+  entry.trial = chunk.trial;
+  entry.time = time;
+  mIndex.push_back(entry);
+  mOffset += sizeof(chunk) + chunk.size + paddingSize;
+}
+
+//==============================================================================
+cv::Mat DatasetFrame::decode() const
+{
+  if (format == depthcodec::FORMAT)
+  {
+    cv::Mat image;
+    if (!decodeDepth(data, size, image))
+      return cv::Mat();
+    return image;
+  }
+
+  cv::Mat buffer(1, size, CV_8UC1, const_cast<uchar*>(data));
+  return cv::imdecode(buffer, cv::IMREAD_UNCHANGED);
+}
+
+//==============================================================================
+DatasetReader::DatasetReader(const std::string& filename)
+  : mData(nullptr), mSize(0)
+{
+  mData = mapFile(filename, mSize);
+  try
+  {
+    dataset::readIndex(mData, mSize, mIndex);
+  }
+  catch (const std::runtime_error&)
+  {
+    ::munmap(const_cast<char*>(mData), mSize);
+    throw std::runtime_error(filename + " is not a dataset.");
+  }
+
+  for (std::size_t i = 0; i < mIndex.size(); ++i)
+  {
+    const auto& entry = mIndex[i];
+    if (entry.trial >= mTrials.size())
+      mTrials.resize(entry.trial + 1);
+
+    if (entry.type == dataset::TRIAL)
+      mTrials[entry.trial].name = std::string(getPayload(i), entry.size);
+    else
+      mTrials[entry.trial].chunks.push_back(i);
+  }
+}
+
+//==============================================================================
+DatasetReader::~DatasetReader()
+{
+  ::munmap(const_cast<char*>(mData), mSize);
+}
+
+//==============================================================================
+std::size_t DatasetReader::getNumTrials() const
+{
+  return mTrials.size();
+}
+
+//==============================================================================
+std::string DatasetReader::getTrialName(std::size_t trial) const
+{
+  return mTrials.at(trial).name;
+}
+
+//==============================================================================
+std::string DatasetReader::getOutcome(std::size_t trial) const
+{
+  std::string outcome;
+  for (auto entry : mTrials.at(trial).chunks)
+  {
+    if (mIndex[entry].type == dataset::OUTCOME)
+      outcome = std::string(getPayload(entry), mIndex[entry].size);
+  }
+  return outcome;
+}
+
+//==============================================================================
+std::size_t DatasetReader::getNumFrames(
+    std::size_t trial, const std::string& stream) const
+{
+  return getFrameEntries(trial, stream).size();
+}
+
+//==============================================================================
+DatasetFrame DatasetReader::getFrame(
+    std::size_t trial, const std::string& stream, std::size_t index) const
+{
+  auto entry = getFrameEntries(trial, stream).at(index);
+  const auto* header
+      = reinterpret_cast<const dataset::FrameHeader*>(getPayload(entry));
+
+  DatasetFrame frame;
+  frame.time = mIndex[entry].time;
+  frame.format = readName(header->format);
+  frame.width = header->width;
+  frame.height = header->height;
+  frame.cvType = header->cvType;
+  frame.data = reinterpret_cast<const uchar*>(header + 1);
+  frame.size = mIndex[entry].size - sizeof(dataset::FrameHeader);
+  return frame;
+}
+
+//==============================================================================
+bool DatasetReader::getCameraIntrinsics(
+    std::size_t trial,
+    const std::string& stream,
+    CameraIntrinsics& intrinsics) const
+{
+  bool found = false;
+  for (auto entry : mTrials.at(trial).chunks)
+  {
+    if (mIndex[entry].type != dataset::CAMERA_INFO)
+      continue;
+
+    const auto* record
+        = reinterpret_cast<const dataset::CameraInfoRecord*>(
+            getPayload(entry));
+    if (readName(record->stream) != stream)
+      continue;
+
+    intrinsics.width = record->width;
+    intrinsics.height = record->height;
+    for (int i = 0; i < 9; ++i)
+      intrinsics.K(i / 3, i % 3) = record->K[i];
+    found = true;
+  }
+  return found;
+}
+
+//==============================================================================
+std::vector<FTSample> DatasetReader::getWrenches(std::size_t trial) const
+{
+  std::vector<FTSample> wrenches;
+  for (auto entry : mTrials.at(trial).chunks)
+  {
+    if (mIndex[entry].type != dataset::SENSOR_RECORDS)
+      continue;
+
+    const char* data = getPayload(entry);
+    std::size_t offset = 0;
+    while (offset + sizeof(trialrecord::RecordHeader) <= mIndex[entry].size)
+    {
+      const auto* record
+          = reinterpret_cast<const trialrecord::RecordHeader*>(data + offset);
+      const auto* values = reinterpret_cast<const double*>(record + 1);
+      if (offset + sizeof(trialrecord::RecordHeader)
+              + record->numValues * sizeof(double)
+          > mIndex[entry].size)
+        break;
+
+      if (record->type == trialrecord::WRENCH && record->numValues == 6)
+      {
+        FTSample sample;
+        sample.time = record->time;
+        sample.force = Eigen::Map<const Eigen::Vector3d>(values);
+        sample.torque = Eigen::Map<const Eigen::Vector3d>(values + 3);
+        wrenches.push_back(sample);
+      }
+      offset += sizeof(trialrecord::RecordHeader)
+                + record->numValues * sizeof(double);
+    }
+  }
+  return wrenches;
+}
+
+//==============================================================================
+std::vector<JointStateSample> DatasetReader::getJointStates(
+    std::size_t trial) const
+{
+  std::vector<JointStateSample> jointStates;
+  for (auto entry : mTrials.at(trial).chunks)
+  {
+    if (mIndex[entry].type != dataset::SENSOR_RECORDS)
+      continue;
+
+    const char* data = getPayload(entry);
+    std::size_t offset = 0;
+    while (offset + sizeof(trialrecord::RecordHeader) <= mIndex[entry].size)
+    {
+      const auto* record
+          = reinterpret_cast<const trialrecord::RecordHeader*>(data + offset);
+      const auto* values = reinterpret_cast<const double*>(record + 1);
+      if (offset + sizeof(trialrecord::RecordHeader)
+              + record->numValues * sizeof(double)
+          > mIndex[entry].size)
+        break;
+
+      if (record->type == trialrecord::JOINT_STATE
+          && record->numValues % 3 == 0)
+      {
+        const std::size_t numJoints = record->numValues / 3;
+        JointStateSample sample;
+        sample.time = record->time;
+        sample.positions = Eigen::Map<const Eigen::VectorXd>(values, numJoints);
+        sample.velocities
+            = Eigen::Map<const Eigen::VectorXd>(values + numJoints, numJoints);
+        sample.efforts = Eigen::Map<const Eigen::VectorXd>(
+            values + 2 * numJoints, numJoints);
+        jointStates.push_back(sample);
+      }
+      offset += sizeof(trialrecord::RecordHeader)
+                + record->numValues * sizeof(double);
+    }
+  }
+  return jointStates;
+}
+
+//==============================================================================
+const dataset::ChunkHeader* DatasetReader::getChunk(std::size_t entry) const
+{
+  return reinterpret_cast<const dataset::ChunkHeader*>(
+      mData + mIndex[entry].offset);
+}
+
+//==============================================================================
+const char* DatasetReader::getPayload(std::size_t entry) const
+{
+  return reinterpret_cast<const char*>(getChunk(entry) + 1);
+}
+
+//==============================================================================
+std::vector<std::size_t> DatasetReader::getFrameEntries(
+    std::size_t trial, const std::string& stream) const
+{
+  std::vector<std::size_t> frames;
+  for (auto entry : mTrials.at(trial).chunks)
+  {
+    if (mIndex[entry].type != dataset::FRAME)
+      continue;
+
+    const auto* header
+        = reinterpret_cast<const dataset::FrameHeader*>(getPayload(entry));
+    if (readName(header->stream) == stream)
+      frames.push_back(entry);
+  }
+  return frames;
+}
+
+} // namespace feeding
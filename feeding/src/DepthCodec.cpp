@@ -0,0 +1,273 @@
+#include "feeding/DepthCodec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace feeding {
+namespace {
+
+// Images larger than this are rejected when decoding corrupt headers.
+static const std::size_t MAX_NUM_PIXELS = 1 << 26;
+
+//==============================================================================
+inline std::uint16_t zigzag(std::uint16_t residual)
+{
+  return static_cast<std::uint16_t>((residual << 1) ^ -(residual >> 15));
+}
+
+//==============================================================================
+inline std::uint16_t unzigzag(std::uint16_t value)
+{
+  return static_cast<std::uint16_t>((value >> 1) ^ -(value & 1));
+}
+
+/// Appends bits LSB first.
+class BitWriter
+{
+public:
+  explicit BitWriter(std::vector<uchar>& buffer)
+    : mBuffer(buffer), mBits(0), mNumBits(0)
+  {
+    // Do nothing
+  }
+
+  /// Writes the lowest \c numBits bits of \c value, at most 32.
+  void write(std::uint32_t value, unsigned numBits)
+  {
+    mBits |= static_cast<std::uint64_t>(value) << mNumBits;
+    mNumBits += numBits;
+    if (mNumBits >= 32)
+    {
+      for (int i = 0; i < 4; ++i)
+        mBuffer.push_back(static_cast<uchar>(mBits >> (8 * i)));
+      mBits >>= 32;
+      mNumBits -= 32;
+    }
+  }
+
+  void flush()
+  {
+    for (; mNumBits > 0; mNumBits -= std::min(mNumBits, 8u))
+    {
+      mBuffer.push_back(static_cast<uchar>(mBits));
+      mBits >>= 8;
+    }
+  }
+
+private:
+  std::vector<uchar>& mBuffer;
+  std::uint64_t mBits;
+  unsigned mNumBits;
+};
+
+/// Reads bits written by BitWriter. Reads past the end return zeros and
+/// are reported by isOverrun.
+class BitReader
+{
+public:
+  BitReader(const uchar* data, std::size_t size)
+    : mData(data), mSize(size), mPos(0), mBits(0), mNumBits(0)
+  {
+    // Do nothing
+  }
+
+  std::uint32_t read(unsigned numBits)
+  {
+    if (mNumBits < numBits)
+      refill();
+    auto value = static_cast<std::uint32_t>(
+        mBits & ((std::uint64_t(1) << numBits) - 1));
+    mBits >>= numBits;
+    mNumBits -= numBits;
+    return value;
+  }
+
+  /// Reads a unary number terminated by a zero bit, or \c limit ones.
+  std::uint32_t readUnary(unsigned limit)
+  {
+    if (mNumBits <= limit)
+      refill();
+    unsigned numOnes
+        = __builtin_ctzll(~mBits | (std::uint64_t(1) << limit));
+    unsigned numBits = numOnes < limit ? numOnes + 1 : limit;
+    mBits >>= numBits;
+    mNumBits -= numBits;
+    return numOnes;
+  }
+
+  bool isOverrun() const
+  {
+    return mPos * 8 - mNumBits > mSize * 8;
+  }
+
+private:
+  /// Fills mBits to at least 57 bits.
+  void refill()
+  {
+    if (mPos + 8 <= mSize)
+    {
+      // Assumes a little-endian host, like BitWriter's byte order.
+      std::uint64_t word;
+      std::memcpy(&word, mData + mPos, sizeof(word));
+      unsigned numBytes = (63 - mNumBits) / 8;
+      mBits |= word << mNumBits;
+      mPos += numBytes;
+      mNumBits += numBytes * 8;
+      mBits &= (std::uint64_t(1) << mNumBits) - 1;
+      return;
+    }
+
+    for (; mNumBits <= 56; mNumBits += 8, ++mPos)
+    {
+      std::uint64_t byte = mPos < mSize ? mData[mPos] : 0;
+      mBits |= byte << mNumBits;
+    }
+  }
+
+  const uchar* mData;
+  std::size_t mSize;
+  std::size_t mPos;
+  std::uint64_t mBits;
+  unsigned mNumBits;
+};
+
+} // namespace
+
+//==============================================================================
+bool encodeDepth(const cv::Mat& image, std::vector<uchar>& buffer)
+{
+  using namespace depthcodec;
+
+  if (image.type() != CV_16UC1)
+    return false;
+
+  const std::size_t width = image.cols;
+  const std::size_t height = image.rows;
+  std::vector<std::uint16_t> residuals(width * height);
+  for (std::size_t y = 0; y < height && width > 0; ++y)
+  {
+    const auto* row = image.ptr<std::uint16_t>(y);
+    auto* out = residuals.data() + y * width;
+    if (y == 0)
+    {
+      out[0] = zigzag(row[0]);
+      for (std::size_t x = 1; x < width; ++x)
+        out[x] = zigzag(row[x] - row[x - 1]);
+      continue;
+    }
+
+    const auto* up = image.ptr<std::uint16_t>(y - 1);
+    out[0] = zigzag(row[0] - up[0]);
+    for (std::size_t x = 1; x < width; ++x)
+      out[x] = zigzag(row[x] - row[x - 1] - up[x] + up[x - 1]);
+  }
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+  header.width = width;
+  header.height = height;
+  header.reserved = 0;
+  buffer.resize(sizeof(header));
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  // Depth residuals typically take 2-4 bits per pixel.
+  buffer.reserve(sizeof(header) + residuals.size() / 2);
+
+  BitWriter writer(buffer);
+  for (std::size_t begin = 0; begin < residuals.size(); begin += BLOCK_SIZE)
+  {
+    std::size_t end = std::min(begin + BLOCK_SIZE, residuals.size());
+    std::uint64_t sum = 0;
+    for (std::size_t i = begin; i < end; ++i)
+      sum += residuals[i];
+
+    // Rice parameter close to log2 of the mean residual.
+    unsigned k = 0;
+    std::uint64_t count = end - begin;
+    while (k < 15 && (count << (k + 1)) <= sum)
+      ++k;
+    writer.write(k, 4);
+
+    const std::uint32_t mask = (1u << k) - 1;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      std::uint32_t quotient = residuals[i] >> k;
+      if (quotient < ESCAPE)
+      {
+        writer.write(
+            ((1u << quotient) - 1) | ((residuals[i] & mask) << (quotient + 1)),
+            quotient + 1 + k);
+      }
+      else
+      {
+        writer.write((1u << ESCAPE) - 1, ESCAPE);
+        writer.write(residuals[i], 16);
+      }
+    }
+  }
+  writer.flush();
+  return true;
+}
+
+//==============================================================================
+bool decodeDepth(const uchar* data, std::size_t size, cv::Mat& image)
+{
+  using namespace depthcodec;
+
+  Header header;
+  if (size < sizeof(header))
+    return false;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0)
+    return false;
+
+  const std::size_t width = header.width;
+  const std::size_t height = header.height;
+  if (width * height > MAX_NUM_PIXELS)
+    return false;
+
+  std::vector<std::uint16_t> residuals(width * height);
+  BitReader reader(data + sizeof(header), size - sizeof(header));
+  for (std::size_t begin = 0; begin < residuals.size(); begin += BLOCK_SIZE)
+  {
+    std::size_t end = std::min(begin + BLOCK_SIZE, residuals.size());
+    unsigned k = reader.read(4);
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      std::uint32_t quotient = reader.readUnary(ESCAPE);
+      if (quotient < ESCAPE)
+        residuals[i] = (quotient << k) | reader.read(k);
+      else
+        residuals[i] = reader.read(16);
+    }
+    if (reader.isOverrun())
+      return false;
+  }
+
+  image.create(height, width, CV_16UC1);
+  for (std::size_t y = 0; y < height && width > 0; ++y)
+  {
+    auto* row = image.ptr<std::uint16_t>(y);
+    auto* in = residuals.data() + y * width;
+    if (y == 0)
+    {
+      for (std::size_t x = 0; x < width; ++x)
+        in[x] = unzigzag(in[x]);
+    }
+    else
+    {
+      // Add the vertical gradient first, so that only a prefix sum over
+      // the row remains.
+      const auto* up = image.ptr<std::uint16_t>(y - 1);
+      in[0] = unzigzag(in[0]) + up[0];
+      for (std::size_t x = 1; x < width; ++x)
+        in[x] = unzigzag(in[x]) + up[x] - up[x - 1];
+    }
+
+    row[0] = in[0];
+    for (std::size_t x = 1; x < width; ++x)
+      row[x] = row[x - 1] + in[x];
+  }
+  return true;
+}
+
+} // namespace feeding
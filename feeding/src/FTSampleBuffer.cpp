@@ -0,0 +1,253 @@
+#include "feeding/FTSampleBuffer.hpp"
+
+#include <stdexcept>
+
+namespace feeding {
+
+namespace {
+
+//==============================================================================
+std::size_t nextPowerOfTwo(std::size_t value)
+{
+  std::size_t result = 1;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+//==============================================================================
+// Pushes (index, value) to a monotonically decreasing queue stored in a
+// fixed circular array, evicting entries that left the window.
+double updatePeakQueue(
+    std::vector<std::pair<std::size_t, double>>& queue,
+    std::size_t& begin,
+    std::size_t& end,
+    std::size_t index,
+    double value,
+    std::size_t windowSize)
+{
+  const std::size_t size = queue.size();
+  while (end != begin && queue[begin % size].first + windowSize <= index)
+    ++begin;
+  while (end != begin && queue[(end - 1) % size].second <= value)
+    --end;
+  queue[end % size] = std::make_pair(index, value);
+  ++end;
+  return queue[begin % size].second;
+}
+
+//==============================================================================
+// Windowed Welford update. Replaces \c removed with \c added when the window
+// is full, otherwise just adds \c added.
+void updateMoments(
+    Eigen::Vector3d& mean,
+    Eigen::Vector3d& m2,
+    const Eigen::Vector3d& added,
+    const Eigen::Vector3d* removed,
+    std::size_t count)
+{
+  if (removed)
+  {
+    const Eigen::Vector3d oldMean = mean;
+    mean += (added - *removed) / static_cast<double>(count);
+    m2 += (added - *removed)
+              .cwiseProduct(added - mean + *removed - oldMean);
+    m2 = m2.cwiseMax(0.0);
+  }
+  else
+  {
+    const Eigen::Vector3d delta = added - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta.cwiseProduct(added - mean);
+  }
+}
+
+} // namespace
+
+//==============================================================================
+FTSampleBuffer::FTSampleBuffer(std::size_t capacity, std::size_t windowSize)
+  : mCapacity(nextPowerOfTwo(capacity))
+  , mMask(mCapacity - 1)
+  , mSlots(mCapacity)
+  , mHead(0)
+  , mTail(0)
+  , mNumDropped(0)
+  , mWindowSize(windowSize)
+  , mWindow(windowSize)
+  , mWindowCount(0)
+  , mTotalSamples(0)
+  , mForceMean(Eigen::Vector3d::Zero())
+  , mForceM2(Eigen::Vector3d::Zero())
+  , mTorqueMean(Eigen::Vector3d::Zero())
+  , mTorqueM2(Eigen::Vector3d::Zero())
+  , mForcePeakQueue(windowSize)
+  , mTorquePeakQueue(windowSize)
+  , mForcePeakBegin(0)
+  , mForcePeakEnd(0)
+  , mTorquePeakBegin(0)
+  , mTorquePeakEnd(0)
+  , mStatisticsSequence(0)
+{
+  if (capacity == 0)
+    throw std::invalid_argument("FTSampleBuffer capacity must be positive.");
+  if (windowSize == 0)
+    throw std::invalid_argument("FTSampleBuffer window must be positive.");
+
+  for (auto& field : mStatistics)
+    field.store(0.0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+bool FTSampleBuffer::push(const FTSample& sample)
+{
+  updateWindow(sample);
+  publishStatistics();
+
+  const std::size_t head = mHead.load(std::memory_order_relaxed);
+  if (head - mTail.load(std::memory_order_acquire) >= mCapacity)
+  {
+    mNumDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  mSlots[head & mMask] = sample;
+  mHead.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+//==============================================================================
+std::size_t FTSampleBuffer::pop(std::vector<FTSample>& out)
+{
+  const std::size_t tail = mTail.load(std::memory_order_relaxed);
+  const std::size_t head = mHead.load(std::memory_order_acquire);
+
+  out.reserve(out.size() + (head - tail));
+  for (std::size_t i = tail; i != head; ++i)
+    out.push_back(mSlots[i & mMask]);
+
+  mTail.store(head, std::memory_order_release);
+  return head - tail;
+}
+
+//==============================================================================
+void FTSampleBuffer::discard()
+{
+  mTail.store(mHead.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+//==============================================================================
+FTWindowStatistics FTSampleBuffer::getStatistics() const
+{
+  std::array<double, NUM_STATISTICS_FIELDS> fields;
+  std::size_t before;
+  std::size_t after;
+  do
+  {
+    before = mStatisticsSequence.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < fields.size(); ++i)
+      fields[i] = mStatistics[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = mStatisticsSequence.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+
+  FTWindowStatistics statistics;
+  statistics.numSamples = static_cast<std::size_t>(fields[NUM_SAMPLES]);
+  statistics.totalSamples = static_cast<std::size_t>(fields[TOTAL_SAMPLES]);
+  statistics.latestTime = fields[LATEST_TIME];
+  statistics.forceMean = Eigen::Map<Eigen::Vector3d>(&fields[FORCE_MEAN]);
+  statistics.forceVariance
+      = Eigen::Map<Eigen::Vector3d>(&fields[FORCE_VARIANCE]);
+  statistics.torqueMean = Eigen::Map<Eigen::Vector3d>(&fields[TORQUE_MEAN]);
+  statistics.torqueVariance
+      = Eigen::Map<Eigen::Vector3d>(&fields[TORQUE_VARIANCE]);
+  statistics.forcePeak = fields[FORCE_PEAK];
+  statistics.torquePeak = fields[TORQUE_PEAK];
+  return statistics;
+}
+
+//==============================================================================
+std::size_t FTSampleBuffer::getNumDropped() const
+{
+  return mNumDropped.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+std::size_t FTSampleBuffer::getCapacity() const
+{
+  return mCapacity;
+}
+
+//==============================================================================
+std::size_t FTSampleBuffer::getWindowSize() const
+{
+  return mWindowSize;
+}
+
+//==============================================================================
+void FTSampleBuffer::updateWindow(const FTSample& sample)
+{
+  const std::size_t index = mTotalSamples++;
+  FTSample& slot = mWindow[index % mWindowSize];
+
+  if (mWindowCount == mWindowSize)
+  {
+    const FTSample removed = slot;
+    updateMoments(
+        mForceMean, mForceM2, sample.force, &removed.force, mWindowCount);
+    updateMoments(
+        mTorqueMean, mTorqueM2, sample.torque, &removed.torque, mWindowCount);
+  }
+  else
+  {
+    ++mWindowCount;
+    updateMoments(mForceMean, mForceM2, sample.force, nullptr, mWindowCount);
+    updateMoments(
+        mTorqueMean, mTorqueM2, sample.torque, nullptr, mWindowCount);
+  }
+  slot = sample;
+}
+
+//==============================================================================
+void FTSampleBuffer::publishStatistics()
+{
+  const std::size_t index = mTotalSamples - 1;
+  const FTSample& latest = mWindow[index % mWindowSize];
+  const double forcePeak = updatePeakQueue(
+      mForcePeakQueue,
+      mForcePeakBegin,
+      mForcePeakEnd,
+      index,
+      latest.force.norm(),
+      mWindowSize);
+  const double torquePeak = updatePeakQueue(
+      mTorquePeakQueue,
+      mTorquePeakBegin,
+      mTorquePeakEnd,
+      index,
+      latest.torque.norm(),
+      mWindowSize);
+
+  std::array<double, NUM_STATISTICS_FIELDS> fields;
+  fields[NUM_SAMPLES] = static_cast<double>(mWindowCount);
+  fields[TOTAL_SAMPLES] = static_cast<double>(mTotalSamples);
+  fields[LATEST_TIME] = latest.time;
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    fields[FORCE_MEAN + i] = mForceMean[i];
+    fields[FORCE_VARIANCE + i] = mForceM2[i] / mWindowCount;
+    fields[TORQUE_MEAN + i] = mTorqueMean[i];
+    fields[TORQUE_VARIANCE + i] = mTorqueM2[i] / mWindowCount;
+  }
+  fields[FORCE_PEAK] = forcePeak;
+  fields[TORQUE_PEAK] = torquePeak;
+
+  const std::size_t sequence
+      = mStatisticsSequence.load(std::memory_order_relaxed);
+  mStatisticsSequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (std::size_t i = 0; i < fields.size(); ++i)
+    mStatistics[i].store(fields[i], std::memory_order_relaxed);
+  mStatisticsSequence.store(sequence + 2, std::memory_order_release);
+}
+
+} // namespace feeding
@@ -1,9 +1,10 @@
 #include "feeding/FTThresholdHelper.hpp"
 
-#include <thread>
+#include <chrono>
 
 #include <libada/util.hpp>
 
+#include "feeding/SimulatedMoveUntilTouchExecutor.hpp"
 #include "feeding/util.hpp"
 
 using ada::util::getRosParam;
@@ -12,12 +13,19 @@ namespace feeding {
 
 //==============================================================================
 FTThresholdHelper::FTThresholdHelper(
-    bool useThresholdControl, ros::NodeHandle nodeHandle)
-  : mUseThresholdControl(useThresholdControl), mNodeHandle(nodeHandle)
+    bool useThresholdControl,
+    ros::NodeHandle nodeHandle,
+    std::shared_ptr<ParameterSnapshot> parameters)
+  : mUseThresholdControl(useThresholdControl)
+  , mNodeHandle(nodeHandle)
+  , mParameters(std::move(parameters))
 {
   if (!mUseThresholdControl)
     return;
 
+  if (!mParameters)
+    mParameters = std::make_shared<ParameterSnapshot>(mNodeHandle);
+
 #ifdef REWD_CONTROLLERS_FOUND
   std::string ftThresholdTopic = getRosParam<std::string>(
       "/ftSensor/controllerFTThresholdTopic", mNodeHandle);
@@ -28,12 +36,28 @@ FTThresholdHelper::FTThresholdHelper(
 #endif
 }
 
+//==============================================================================
+FTThresholdHelper::~FTThresholdHelper()
+{
+  stopContactCapture();
+
+  // The controller may outlive this helper.
+  if (mSimulatedController)
+    mSimulatedController->setSampleCallback(nullptr);
+}
+
 //==============================================================================
 void FTThresholdHelper::init()
 {
   if (!mUseThresholdControl)
     return;
 
+  if (mSimulatedController)
+  {
+    setThresholds(STANDARD_FT_THRESHOLD);
+    return;
+  }
+
 #ifdef REWD_CONTROLLERS_FOUND
   auto thresholdPair = getThresholdValues(STANDARD_FT_THRESHOLD);
   mFTThresholdClient->trySetThresholdsRepeatedly(
@@ -52,71 +76,184 @@ void FTThresholdHelper::init()
 void FTThresholdHelper::forceTorqueDataCallback(
     const geometry_msgs::WrenchStamped& msg)
 {
-  std::lock_guard<std::mutex> lock(mDataCollectionMutex);
-  if (mCollectedForces.size() >= mDataPointsToCollect)
-  {
-    return;
-  }
-  Eigen::Vector3d force;
-  Eigen::Vector3d torque;
-  force.x() = msg.wrench.force.x;
-  force.y() = msg.wrench.force.y;
-  force.z() = msg.wrench.force.z;
-  torque.x() = msg.wrench.torque.x;
-  torque.y() = msg.wrench.torque.y;
-  torque.z() = msg.wrench.torque.z;
-  mCollectedForces.push_back(force);
-  mCollectedTorques.push_back(torque);
+  FTSample sample;
+  sample.time = msg.header.stamp.toSec();
+  sample.force.x() = msg.wrench.force.x;
+  sample.force.y() = msg.wrench.force.y;
+  sample.force.z() = msg.wrench.force.z;
+  sample.torque.x() = msg.wrench.torque.x;
+  sample.torque.y() = msg.wrench.torque.y;
+  sample.torque.z() = msg.wrench.torque.z;
+  mSampleBuffer.push(sample);
 }
 
+//==============================================================================
 bool FTThresholdHelper::startDataCollection(int numberOfDataPoints)
 {
   if (!mUseThresholdControl)
     return false;
   std::lock_guard<std::mutex> lock(mDataCollectionMutex);
   mDataPointsToCollect = numberOfDataPoints;
-  mCollectedForces.clear();
-  mCollectedTorques.clear();
+  mSampleBuffer.discard();
+  mCollectedSamples.clear();
   return true;
 }
 
+//==============================================================================
 bool FTThresholdHelper::isDataCollectionFinished(
     Eigen::Vector3d& forces, Eigen::Vector3d& torques)
 {
   std::lock_guard<std::mutex> lock(mDataCollectionMutex);
   forces.fill(0);
   torques.fill(0);
-  if (mCollectedForces.size() < mDataPointsToCollect)
+  drainSampleBuffer();
+  if (mDataPointsToCollect <= 0
+      || mCollectedSamples.size() < mDataPointsToCollect)
   {
     return false;
   }
-  Eigen::Vector3d summedForces, summedTorques;
-  summedForces.fill(0);
-  summedTorques.fill(0);
-  for (int i = 0; i < mCollectedForces.size(); i++)
+  for (int i = 0; i < mDataPointsToCollect; i++)
+  {
+    forces += mCollectedSamples[i].force;
+    torques += mCollectedSamples[i].torque;
+  }
+  forces /= mDataPointsToCollect;
+  torques /= mDataPointsToCollect;
+  return true;
+}
+
+//==============================================================================
+FTWindowStatistics FTThresholdHelper::getWindowStatistics() const
+{
+  return mSampleBuffer.getStatistics();
+}
+
+//==============================================================================
+std::vector<FTSample> FTThresholdHelper::getCollectedSamples()
+{
+  std::lock_guard<std::mutex> lock(mDataCollectionMutex);
+  drainSampleBuffer();
+  return mCollectedSamples;
+}
+
+//==============================================================================
+bool FTThresholdHelper::startContactCapture()
+{
+  if (!mUseThresholdControl)
+    return false;
+
+  stopContactCapture();
   {
-    summedForces = summedForces + mCollectedForces[i];
-    summedTorques = summedTorques + mCollectedTorques[i];
+    std::lock_guard<std::mutex> lock(mDataCollectionMutex);
+    // Earlier samples still count for a running data collection.
+    drainSampleBuffer();
+    mCapturedSamples.clear();
+    mIsCapturing = true;
   }
-  forces.x() = summedForces.x() / mCollectedForces.size();
-  forces.y() = summedForces.y() / mCollectedForces.size();
-  forces.z() = summedForces.z() / mCollectedForces.size();
-  torques.x() = summedTorques.x() / mCollectedForces.size();
-  torques.y() = summedTorques.y() / mCollectedForces.size();
-  torques.z() = summedTorques.z() / mCollectedForces.size();
+
+  mStopCapture = false;
+  mCaptureThread = std::thread([this] {
+    // Well below the time the sensor needs to fill the sample buffer.
+    while (!mStopCapture)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mDataCollectionMutex);
+        drainSampleBuffer();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  });
   return true;
 }
 
+//==============================================================================
+std::vector<FTSample> FTThresholdHelper::stopContactCapture()
+{
+  if (mCaptureThread.joinable())
+  {
+    mStopCapture = true;
+    mCaptureThread.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mDataCollectionMutex);
+  if (!mIsCapturing)
+    return std::vector<FTSample>();
+  drainSampleBuffer();
+  mIsCapturing = false;
+  std::vector<FTSample> samples;
+  samples.swap(mCapturedSamples);
+  return samples;
+}
+
+//==============================================================================
+void FTThresholdHelper::drainSampleBuffer()
+{
+  std::vector<FTSample> samples;
+  mSampleBuffer.pop(samples);
+  if (mDataPointsToCollect > 0)
+  {
+    mCollectedSamples.insert(
+        mCollectedSamples.end(), samples.begin(), samples.end());
+  }
+  if (mIsCapturing)
+  {
+    mCapturedSamples.insert(
+        mCapturedSamples.end(), samples.begin(), samples.end());
+  }
+}
+
+//==============================================================================
+std::size_t FTThresholdHelper::getNumDroppedSamples() const
+{
+  return mSampleBuffer.getNumDropped();
+}
+
+//==============================================================================
+void FTThresholdHelper::setSimulatedController(
+    std::shared_ptr<SimulatedMoveUntilTouchExecutor> controller)
+{
+  if (mSimulatedController)
+    mSimulatedController->setSampleCallback(nullptr);
+
+  mSimulatedController = std::move(controller);
+  if (!mSimulatedController)
+    return;
+
+  mUseThresholdControl = true;
+  if (!mParameters)
+    mParameters = std::make_shared<ParameterSnapshot>(mNodeHandle);
+  mSimulatedController->setSampleCallback(
+      [this](const FTSample& sample) { mSampleBuffer.push(sample); });
+}
+
+//==============================================================================
+std::shared_ptr<SimulatedMoveUntilTouchExecutor>
+FTThresholdHelper::getSimulatedController() const
+{
+  return mSimulatedController;
+}
+
 //==============================================================================
 bool FTThresholdHelper::setThresholds(FTThreshold threshold)
 {
   if (!mUseThresholdControl)
     return true;
 
+  if (mSimulatedController)
+  {
+    auto thresholdPair = getThresholdValues(threshold);
+    return setThresholds(thresholdPair.first, thresholdPair.second);
+  }
+
 #ifdef REWD_CONTROLLERS_FOUND
   auto thresholdPair = getThresholdValues(threshold);
   ROS_INFO_STREAM(
       "Set thresholds " << thresholdPair.first << " " << thresholdPair.second);
+  if (auto trialLog = std::atomic_load(&mTrialLog))
+  {
+    trialLog->logThresholds(
+        ros::Time::now().toSec(), thresholdPair.first, thresholdPair.second);
+  }
   return mFTThresholdClient->setThresholds(
       thresholdPair.first, thresholdPair.second);
 #endif
@@ -131,8 +268,19 @@ bool FTThresholdHelper::setThresholds(double forces, double torques)
   if (!mUseThresholdControl)
     return true;
 
+  if (mSimulatedController)
+  {
+    ROS_INFO_STREAM("Set simulated thresholds " << forces << " " << torques);
+    if (auto trialLog = std::atomic_load(&mTrialLog))
+      trialLog->logThresholds(ros::Time::now().toSec(), forces, torques);
+    mSimulatedController->setThresholds(forces, torques);
+    return true;
+  }
+
 #ifdef REWD_CONTROLLERS_FOUND
   ROS_INFO_STREAM("Set thresholds " << forces << " " << torques);
+  if (auto trialLog = std::atomic_load(&mTrialLog))
+    trialLog->logThresholds(ros::Time::now().toSec(), forces, torques);
   return mFTThresholdClient->setThresholds(forces, torques);
 #endif
 
@@ -140,42 +288,36 @@ bool FTThresholdHelper::setThresholds(double forces, double torques)
   return true;
 }
 
+//==============================================================================
+void FTThresholdHelper::setTrialLog(std::shared_ptr<TrialLog> trialLog)
+{
+  std::atomic_store(&mTrialLog, std::move(trialLog));
+}
+
 //==============================================================================
 std::pair<double, double> FTThresholdHelper::getThresholdValues(
     FTThreshold threshold)
 {
-  double forceThreshold = 0;
-  double torqueThreshold = 0;
+  auto parameters = mParameters->get();
+  FTThresholdValues values;
   switch (threshold)
   {
     case STANDARD_FT_THRESHOLD:
-      forceThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/standard/force", mNodeHandle);
-      torqueThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/standard/torque", mNodeHandle);
+      values = parameters->standardThreshold;
       break;
     case GRAB_FOOD_FT_THRESHOLD:
-      forceThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/grabFood/force", mNodeHandle);
-      torqueThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/grabFood/torque", mNodeHandle);
+      values = parameters->grabFoodThreshold;
       break;
     case AFTER_GRAB_FOOD_FT_THRESHOLD:
-      forceThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/afterGrabFood/force", mNodeHandle);
-      torqueThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/afterGrabFood/torque", mNodeHandle);
+      values = parameters->afterGrabFoodThreshold;
       break;
     case PUSH_FOOD_FT_THRESHOLD:
-      forceThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/pushFood/force", mNodeHandle);
-      torqueThreshold = getRosParam<double>(
-          "/ftSensor/thresholds/pushFood/torque", mNodeHandle);
+      values = parameters->pushFoodThreshold;
       break;
     default:
       throw std::runtime_error(
           "Unknown F/T Threshold type: " + std::to_string(threshold));
   }
-  return std::pair<double, double>(forceThreshold, torqueThreshold);
+  return std::pair<double, double>(values.force, values.torque);
 }
 } // namespace feeding
@@ -1,5 +1,6 @@
 #include "feeding/FeedingDemo.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -10,6 +11,7 @@
 #include <libada/util.hpp>
 
 #include "feeding/FoodItem.hpp"
+#include "feeding/SimulatedMoveUntilTouchExecutor.hpp"
 #include "feeding/util.hpp"
 
 using ada::util::createIsometry;
@@ -31,15 +33,20 @@ FeedingDemo::FeedingDemo(
     bool useVisualServo,
     bool allowFreeRotation,
     std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
-    bool autoContinueDemo)
+    bool autoContinueDemo,
+    std::shared_ptr<ParameterSnapshot> parameters)
   : mAdaReal(adaReal)
   , mNodeHandle(nodeHandle)
+  , mParameters(std::move(parameters))
   , mFTThresholdHelper(ftThresholdHelper)
   , mVisualServo(useVisualServo)
   , mAllowRotationFree(allowFreeRotation)
   , mAutoContinueDemo(autoContinueDemo)
   , mIsFTSensingEnabled(useFTSensingToStopTrajectories)
 {
+  if (!mParameters)
+    mParameters = std::make_shared<ParameterSnapshot>(*mNodeHandle);
+
   mWorld = std::make_shared<aikido::planner::World>("feeding");
 
   std::string armTrajectoryExecutor = mIsFTSensingEnabled
@@ -185,6 +192,98 @@ FeedingDemo::FeedingDemo(
   mVelocityLimits
       = getRosParam<std::vector<double>>("/study/velocityLimits", *mNodeHandle);
   mTableHeight = getRosParam<double>("/study/tableHeight", *mNodeHandle);
+
+  if (mFTThresholdHelper)
+  {
+    mSkewerSuccessClassifier = std::make_shared<SkewerSuccessClassifier>(
+        mFTThresholdHelper, *mNodeHandle);
+  }
+
+  double grabFoodTorque;
+  mNodeHandle->param<double>(
+      "/ftSensor/thresholds/grabFood/torque", grabFoodTorque, 2.0);
+  mSkewerThresholdAdapter = std::make_shared<SkewerThresholdAdapter>(
+      mFoodSkeweringForces, grabFoodTorque, *mNodeHandle);
+
+  mNodeHandle->param<std::string>(
+      "/trialRecorder/directory", mTrialRecordDirectory, "");
+  if (!mTrialRecordDirectory.empty())
+    mTrialRecorder = std::make_shared<TrialRecorder>(*mNodeHandle);
+
+  bool useGoalSeeds;
+  mNodeHandle->param<bool>("/goalSeeds/enabled", useGoalSeeds, false);
+  if (useGoalSeeds)
+    mGoalSeedCache = std::make_shared<GoalSeedCache>(*mNodeHandle);
+
+  std::string roadmapFile;
+  mNodeHandle->param<std::string>("/roadmap/file", roadmapFile, "");
+  if (!roadmapFile.empty())
+  {
+    mRoadmap = std::make_shared<Roadmap>(
+        mAda->getArm()->getMetaSkeleton()->getNumDofs(), *mNodeHandle);
+    mRoadmap->setGoalSeedCache(mGoalSeedCache);
+  }
+
+  bool useLookahead;
+  mNodeHandle->param<bool>("/lookahead/enabled", useLookahead, false);
+  if (useLookahead)
+    mLookaheadPlanner = std::make_shared<LookaheadPlanner>(mAda, *mNodeHandle);
+
+  bool usePlanningPortfolio;
+  mNodeHandle->param<bool>(
+      "/planningPortfolio/enabled", usePlanningPortfolio, false);
+  if (usePlanningPortfolio)
+  {
+    mPlanningPortfolio = std::make_shared<PlanningPortfolio>(
+        mAda,
+        mCollisionFreeConstraint,
+        std::vector<dart::dynamics::ConstSkeletonPtr>{
+            mWorkspace->getTable(),
+            mWorkspace->getWorkspaceEnvironment(),
+            mWorkspace->getWheelchair()},
+        *mNodeHandle);
+  }
+
+  bool useRetimer;
+  mNodeHandle->param<bool>("/retimer/enabled", useRetimer, false);
+  if (useRetimer)
+    mRetimer = std::make_shared<Retimer>(*mNodeHandle);
+
+  bool useTrajectoryCache;
+  mNodeHandle->param<bool>(
+      "/trajectoryCache/enabled", useTrajectoryCache, false);
+  if (useTrajectoryCache)
+  {
+    mTrajectoryCache = std::make_shared<TrajectoryCache>(
+        mAda->getArm()->getStateSpace(), *mNodeHandle);
+  }
+
+  std::string trajectoryDumpFile;
+  mNodeHandle->param<std::string>(
+      "/trajectoryDump/file", trajectoryDumpFile, "");
+  if (!trajectoryDumpFile.empty())
+  {
+    double timeStep;
+    mNodeHandle->param<double>("/trajectoryDump/timeStep", timeStep, 0.01);
+    mTrajectoryDump
+        = std::make_shared<TrajectoryDumpWriter>(trajectoryDumpFile, timeStep);
+  }
+
+  bool simulateContact;
+  mNodeHandle->param<bool>("/simulatedContact/enabled", simulateContact, false);
+  if (!mAdaReal && simulateContact && mFTThresholdHelper)
+  {
+    auto contactModel = std::unique_ptr<SimulatedContactModel>(
+        new SimulatedContactModel(
+            mWorkspace->getPlate()->getRootBodyNode()->getWorldTransform(),
+            *mNodeHandle));
+    mFTThresholdHelper->setSimulatedController(
+        std::make_shared<SimulatedMoveUntilTouchExecutor>(
+            mAda->getArm()->getMetaSkeleton(),
+            mAda->getHand()->getEndEffectorBodyNode(),
+            std::move(contactModel),
+            *mNodeHandle));
+  }
 }
 
 //==============================================================================
@@ -260,6 +359,17 @@ aikido::rviz::InteractiveMarkerViewerPtr FeedingDemo::getViewer()
   return mViewer;
 }
 
+//==============================================================================
+void FeedingDemo::waitForUser(const std::string& prompt)
+{
+  if (mAutoContinueDemo)
+  {
+    ROS_INFO_STREAM(prompt);
+    return;
+  }
+  waitForOperator(prompt);
+}
+
 //==============================================================================
 void FeedingDemo::reset()
 {
@@ -272,6 +382,94 @@ std::shared_ptr<FTThresholdHelper> FeedingDemo::getFTThresholdHelper()
   return mFTThresholdHelper;
 }
 
+//==============================================================================
+std::shared_ptr<ParameterSnapshot> FeedingDemo::getParameters()
+{
+  return mParameters;
+}
+
+//==============================================================================
+std::shared_ptr<SkewerSuccessClassifier>
+FeedingDemo::getSkewerSuccessClassifier()
+{
+  return mSkewerSuccessClassifier;
+}
+
+//==============================================================================
+std::shared_ptr<SkewerThresholdAdapter>
+FeedingDemo::getSkewerThresholdAdapter()
+{
+  return mSkewerThresholdAdapter;
+}
+
+//==============================================================================
+std::shared_ptr<TrialRecorder> FeedingDemo::getTrialRecorder()
+{
+  return mTrialRecorder;
+}
+
+//==============================================================================
+const std::string& FeedingDemo::getTrialRecordDirectory() const
+{
+  return mTrialRecordDirectory;
+}
+
+//==============================================================================
+void FeedingDemo::setTrialLog(std::shared_ptr<TrialLog> trialLog)
+{
+  mTrialLog = trialLog;
+  if (mFTThresholdHelper)
+    mFTThresholdHelper->setTrialLog(std::move(trialLog));
+}
+
+//==============================================================================
+std::shared_ptr<TrialLog> FeedingDemo::getTrialLog()
+{
+  return mTrialLog;
+}
+
+//==============================================================================
+std::shared_ptr<Roadmap> FeedingDemo::getRoadmap()
+{
+  return mRoadmap;
+}
+
+//==============================================================================
+std::shared_ptr<LookaheadPlanner> FeedingDemo::getLookaheadPlanner()
+{
+  return mLookaheadPlanner;
+}
+
+//==============================================================================
+std::shared_ptr<PlanningPortfolio> FeedingDemo::getPlanningPortfolio()
+{
+  return mPlanningPortfolio;
+}
+
+//==============================================================================
+std::shared_ptr<GoalSeedCache> FeedingDemo::getGoalSeedCache()
+{
+  return mGoalSeedCache;
+}
+
+//==============================================================================
+std::shared_ptr<Retimer> FeedingDemo::getRetimer()
+{
+  return mRetimer;
+}
+
+//==============================================================================
+std::shared_ptr<TrajectoryCache> FeedingDemo::getTrajectoryCache()
+{
+  return mTrajectoryCache;
+}
+
+//==============================================================================
+std::shared_ptr<TrajectoryDumpWriter> FeedingDemo::getTrajectoryDump()
+{
+  return mTrajectoryDump;
+}
+
 //==============================================================================
 Eigen::Isometry3d FeedingDemo::getPlateEndEffectorTransform() const
 {
@@ -285,4 +483,11 @@ Eigen::Isometry3d FeedingDemo::getPlateEndEffectorTransform() const
 
   return eeTransform;
 }
+
+//==============================================================================
+bool FeedingDemo::isTiltFood(const std::string& foodName) const
+{
+  return std::find(mTiltFoodNames.begin(), mTiltFoodNames.end(), foodName)
+         != mTiltFoodNames.end();
+}
 } // namespace feeding
@@ -0,0 +1,416 @@
+#include "feeding/GoalSeedCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+#include <aikido/constraint/dart/InverseKinematicsSampleable.hpp>
+#include <aikido/constraint/dart/JointStateSpaceHelpers.hpp>
+#include <dart/dynamics/InverseKinematics.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include "feeding/util.hpp"
+
+using aikido::constraint::SampleGenerator;
+using aikido::constraint::Sampleable;
+using aikido::constraint::dart::InverseKinematicsSampleable;
+using aikido::constraint::dart::TSR;
+using aikido::constraint::dart::createSampleableBounds;
+using aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr;
+using aikido::statespace::dart::MetaSkeletonStateSpace;
+
+namespace feeding {
+
+namespace {
+
+/// Samples the seeds in order, then from the fallback.
+class SeedSampleGenerator : public SampleGenerator
+{
+public:
+  SeedSampleGenerator(
+      ConstMetaSkeletonStateSpacePtr space,
+      const std::vector<Eigen::VectorXd>& seeds,
+      std::unique_ptr<SampleGenerator> fallback)
+    : mSpace(std::move(space))
+    , mSeeds(seeds)
+    , mFallback(std::move(fallback))
+    , mNextSeed(0)
+  {
+    // Do nothing
+  }
+
+  aikido::statespace::ConstStateSpacePtr getStateSpace() const override
+  {
+    return mSpace;
+  }
+
+  bool sample(aikido::statespace::StateSpace::State* state) override
+  {
+    if (mNextSeed < mSeeds.size())
+    {
+      mSpace->convertPositionsToState(
+          mSeeds[mNextSeed++],
+          static_cast<aikido::statespace::dart::MetaSkeletonStateSpace::State*>(
+              state));
+      return true;
+    }
+    return mFallback->sample(state);
+  }
+
+  int getNumSamplesRemaining() const override
+  {
+    int numRemaining = mFallback->getNumSamplesRemaining();
+    if (numRemaining == NO_LIMIT)
+      return NO_LIMIT;
+    return numRemaining + static_cast<int>(mSeeds.size() - mNextSeed);
+  }
+
+  bool canSample() const override
+  {
+    return mNextSeed < mSeeds.size() || mFallback->canSample();
+  }
+
+private:
+  ConstMetaSkeletonStateSpacePtr mSpace;
+  std::vector<Eigen::VectorXd> mSeeds;
+  std::unique_ptr<SampleGenerator> mFallback;
+  std::size_t mNextSeed;
+};
+
+class SeedSampleable : public Sampleable
+{
+public:
+  SeedSampleable(
+      ConstMetaSkeletonStateSpacePtr space,
+      std::vector<Eigen::VectorXd> seeds,
+      std::shared_ptr<Sampleable> fallback)
+    : mSpace(std::move(space))
+    , mSeeds(std::move(seeds))
+    , mFallback(std::move(fallback))
+  {
+    // Do nothing
+  }
+
+  aikido::statespace::ConstStateSpacePtr getStateSpace() const override
+  {
+    return mSpace;
+  }
+
+  std::unique_ptr<SampleGenerator> createSampleGenerator() const override
+  {
+    return std::unique_ptr<SampleGenerator>(new SeedSampleGenerator(
+        mSpace, mSeeds, mFallback->createSampleGenerator()));
+  }
+
+private:
+  ConstMetaSkeletonStateSpacePtr mSpace;
+  std::vector<Eigen::VectorXd> mSeeds;
+  std::shared_ptr<Sampleable> mFallback;
+};
+
+/// Writes \c value quantized to \c resolution, or "inf" if it is unbounded.
+void appendQuantized(std::ostringstream& key, double value, double resolution)
+{
+  if (std::abs(value) >= std::numeric_limits<double>::max())
+    key << " " << (value > 0 ? "inf" : "-inf");
+  else
+    key << " " << std::lround(value / resolution);
+}
+
+} // namespace
+
+//==============================================================================
+GoalSeedCache::GoalSeedCache(ros::NodeHandle nodeHandle) : mIsModified(false)
+{
+  int maxSeedsPerBin;
+  double saveInterval;
+  nodeHandle.param<std::string>("/goalSeeds/file", mFilename, "");
+  nodeHandle.param<double>(
+      "/goalSeeds/positionResolution", mPositionResolution, 0.02);
+  nodeHandle.param<double>("/goalSeeds/angleResolution", mAngleResolution, 0.2);
+  nodeHandle.param<int>("/goalSeeds/maxSeedsPerBin", maxSeedsPerBin, 3);
+  nodeHandle.param<double>("/goalSeeds/saveInterval", saveInterval, 10.0);
+  mMaxSeedsPerBin = std::max(maxSeedsPerBin, 1);
+
+  if (!mFilename.empty())
+  {
+    load(mFilename);
+    mSaveThread.reset(new aikido::common::ExecutorThread(
+        [this] { saveIfModified(); },
+        std::chrono::milliseconds(
+            static_cast<long>(std::max(saveInterval, 0.1) * 1e3))));
+  }
+}
+
+//==============================================================================
+GoalSeedCache::~GoalSeedCache()
+{
+  mSaveThread.reset();
+  saveIfModified();
+}
+
+//==============================================================================
+std::vector<Eigen::VectorXd> GoalSeedCache::getSeeds(const TSR& tsr) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mSeeds.find(getKey(tsr));
+  if (it == mSeeds.end())
+    return std::vector<Eigen::VectorXd>();
+  return std::vector<Eigen::VectorXd>(it->second.begin(), it->second.end());
+}
+
+//==============================================================================
+void GoalSeedCache::addSeed(
+    const TSR& tsr, const Eigen::VectorXd& configuration)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& seeds = mSeeds[getKey(tsr)];
+    // A seed close to a known one adds nothing but moves it to the front.
+    for (auto it = seeds.begin(); it != seeds.end(); ++it)
+    {
+      if ((*it - configuration).cwiseAbs().maxCoeff() < mAngleResolution)
+      {
+        seeds.erase(it);
+        break;
+      }
+    }
+    seeds.push_front(configuration);
+    if (seeds.size() > mMaxSeedsPerBin)
+      seeds.pop_back();
+    mIsModified = true;
+  }
+}
+
+//==============================================================================
+aikido::distance::ConfigurationRankerPtr GoalSeedCache::getConfigurationRanker(
+    const std::shared_ptr<ada::Ada>& ada, const TSR& tsr) const
+{
+  auto space = ada->getArm()->getStateSpace();
+  auto metaSkeleton = ada->getArm()->getMetaSkeleton();
+  auto seeds = getSeeds(tsr);
+  if (seeds.empty()
+      || seeds.front().size()
+             != static_cast<int>(metaSkeleton->getNumDofs()))
+    return feeding::getConfigurationRanker(space, metaSkeleton);
+  return feeding::getConfigurationRanker(space, metaSkeleton, seeds.front());
+}
+
+//==============================================================================
+aikido::constraint::SampleablePtr GoalSeedCache::createSeedSampleable(
+    const ConstMetaSkeletonStateSpacePtr& space,
+    const TSR& tsr,
+    std::unique_ptr<aikido::common::RNG> rng) const
+{
+  std::vector<Eigen::VectorXd> seeds;
+  for (const auto& seed : getSeeds(tsr))
+  {
+    if (seed.size() == static_cast<int>(space->getDimension()))
+      seeds.push_back(seed);
+  }
+  std::shared_ptr<Sampleable> bounds
+      = createSampleableBounds(space, std::move(rng));
+  return std::make_shared<SeedSampleable>(
+      space, std::move(seeds), std::move(bounds));
+}
+
+//==============================================================================
+aikido::trajectory::TrajectoryPtr GoalSeedCache::planToTSR(
+    const std::shared_ptr<ada::Ada>& ada,
+    const TSR& tsr,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+    double timelimit,
+    int maxNumTrials,
+    const aikido::distance::ConfigurationRankerPtr& ranker) const
+{
+  // Same as planning to a TSR from scratch, with seeded goal sampling.
+  auto arm = ada->getArm();
+  auto space = arm->getStateSpace();
+  auto metaSkeleton = arm->getMetaSkeleton();
+  auto ik = dart::dynamics::InverseKinematics::create(
+      ada->getHand()->getEndEffectorBodyNode());
+  ik->setDofs(metaSkeleton->getDofs());
+  auto rng = std::unique_ptr<aikido::common::RNG>(
+      new aikido::common::RNGWrapper<std::mt19937>(std::random_device()()));
+  auto goalSampleable = std::make_shared<InverseKinematicsSampleable>(
+      space,
+      metaSkeleton,
+      std::make_shared<TSR>(tsr),
+      createSeedSampleable(space, tsr, std::move(rng)),
+      ik,
+      maxNumTrials);
+  auto generator = goalSampleable->createSampleGenerator();
+
+  std::vector<MetaSkeletonStateSpace::ScopedState> goals;
+  for (int i = 0; i < maxNumTrials && generator->canSample(); ++i)
+  {
+    auto goal = space->createState();
+    if (!generator->sample(goal))
+      continue;
+    if (collisionFree && !collisionFree->isSatisfied(goal))
+      continue;
+    goals.emplace_back(std::move(goal));
+  }
+
+  std::vector<aikido::statespace::CartesianProduct::State*> rankedGoals;
+  for (auto& goal : goals)
+    rankedGoals.push_back(goal.getState());
+  if (ranker)
+    ranker->rankConfigurations(rankedGoals);
+
+  Eigen::VectorXd positions;
+  for (auto goal : rankedGoals)
+  {
+    space->convertStateToPositions(
+        static_cast<MetaSkeletonStateSpace::State*>(goal), positions);
+    auto trajectory = ada->planToConfiguration(
+        space, metaSkeleton, positions, collisionFree, timelimit);
+    if (trajectory)
+      return trajectory;
+  }
+  return nullptr;
+}
+
+//==============================================================================
+bool GoalSeedCache::moveArmToTSR(
+    const std::shared_ptr<ada::Ada>& ada,
+    const TSR& tsr,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+    double timelimit,
+    int maxNumTrials,
+    const aikido::distance::ConfigurationRankerPtr& ranker,
+    const std::vector<double>& velocityLimits) const
+{
+  auto trajectory
+      = planToTSR(ada, tsr, collisionFree, timelimit, maxNumTrials, ranker);
+  return trajectory
+         && ada->moveArmOnTrajectory(
+             trajectory,
+             collisionFree,
+             ::ada::TrajectoryPostprocessType::KUNZ,
+             velocityLimits);
+}
+
+//==============================================================================
+bool GoalSeedCache::load(const std::string& filename)
+{
+  YAML::Node root;
+  try
+  {
+    root = YAML::LoadFile(filename);
+  }
+  catch (const YAML::Exception& e)
+  {
+    ROS_INFO_STREAM("No goal seeds loaded from " << filename);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::size_t numSeeds = 0;
+  for (const auto& entry : root)
+  {
+    auto& seeds = mSeeds[entry.first.as<std::string>()];
+    for (const auto& seedNode : entry.second)
+    {
+      if (seeds.size() >= mMaxSeedsPerBin)
+        break;
+      auto positions = seedNode.as<std::vector<double>>();
+      seeds.emplace_back(
+          Eigen::Map<Eigen::VectorXd>(positions.data(), positions.size()));
+      ++numSeeds;
+    }
+  }
+  ROS_INFO_STREAM("Loaded " << numSeeds << " goal seeds from " << filename);
+  return true;
+}
+
+//==============================================================================
+bool GoalSeedCache::save(const std::string& filename) const
+{
+  YAML::Node root;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& entry : mSeeds)
+    {
+      for (const auto& seed : entry.second)
+      {
+        YAML::Node seedNode;
+        for (int i = 0; i < seed.size(); ++i)
+          seedNode.push_back(seed[i]);
+        seedNode.SetStyle(YAML::EmitterStyle::Flow);
+        root[entry.first].push_back(seedNode);
+      }
+    }
+  }
+
+  // Write to a temporary file first so a crash never leaves a broken file.
+  const std::string tmpFilename = filename + ".tmp";
+  {
+    std::ofstream outFile(tmpFilename);
+    outFile << root;
+    if (!outFile)
+    {
+      ROS_WARN_STREAM("Failed to write goal seeds to " << filename);
+      return false;
+    }
+  }
+  return std::rename(tmpFilename.c_str(), filename.c_str()) == 0;
+}
+
+//==============================================================================
+bool GoalSeedCache::save() const
+{
+  if (mFilename.empty())
+    return false;
+  return save(mFilename);
+}
+
+//==============================================================================
+void GoalSeedCache::saveIfModified()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mIsModified)
+      return;
+    mIsModified = false;
+  }
+  if (!save())
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mIsModified = true;
+  }
+}
+
+//==============================================================================
+std::string GoalSeedCache::getKey(const TSR& tsr) const
+{
+  const Eigen::Isometry3d& origin = tsr.mT0_w;
+  double yaw = std::atan2(origin.linear()(1, 0), origin.linear()(0, 0));
+  Eigen::AngleAxisd offsetRotation(tsr.mTw_e.linear());
+  Eigen::Vector3d offsetAxis = offsetRotation.angle() * offsetRotation.axis();
+
+  std::ostringstream key;
+  key << "origin";
+  for (int i = 0; i < 3; ++i)
+    key << " " << std::lround(origin.translation()[i] / mPositionResolution);
+  key << " " << std::lround(yaw / mAngleResolution) << " offset";
+  for (int i = 0; i < 3; ++i)
+    key << " " << std::lround(tsr.mTw_e.translation()[i] / mPositionResolution);
+  for (int i = 0; i < 3; ++i)
+    key << " " << std::lround(offsetAxis[i] / mAngleResolution);
+  key << " bounds";
+  for (int i = 0; i < 6; ++i)
+  {
+    double resolution = i < 3 ? mPositionResolution : mAngleResolution;
+    appendQuantized(key, tsr.mBw(i, 0), resolution);
+    appendQuantized(key, tsr.mBw(i, 1), resolution);
+  }
+  return key.str();
+}
+
+} // namespace feeding
@@ -0,0 +1,234 @@
+#include "feeding/ImageWriter.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include <opencv2/imgcodecs.hpp>
+#include <ros/ros.h>
+
+#include "feeding/DepthCodec.hpp"
+
+namespace feeding {
+
+//==============================================================================
+ImageWriter::ImageWriter(std::size_t numThreads, std::size_t maxQueueSize)
+  : mMaxQueueSize(std::max<std::size_t>(1, maxQueueSize))
+  , mNumInProgress(0)
+  , mStop(false)
+{
+  for (std::size_t i = 0; i < std::max<std::size_t>(1, numThreads); ++i)
+    mWorkers.emplace_back(&ImageWriter::workerLoop, this);
+}
+
+//==============================================================================
+ImageWriter::~ImageWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mJobAvailable.notify_all();
+  mSpaceAvailable.notify_all();
+  for (auto& worker : mWorkers)
+    worker.join();
+}
+
+//==============================================================================
+void ImageWriter::setStreamConfig(
+    const std::string& stream, const ImageStreamConfig& config)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStreamConfigs[stream] = config;
+}
+
+//==============================================================================
+void ImageWriter::setSink(Sink sink)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mSink = std::move(sink);
+}
+
+//==============================================================================
+std::string ImageWriter::getExtension(const std::string& stream) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mStreamConfigs.find(stream);
+  return "." + (it == mStreamConfigs.end() ? ImageStreamConfig().format
+                                           : it->second.format);
+}
+
+//==============================================================================
+bool ImageWriter::tryWrite(
+    const std::string& stream,
+    const std::string& filename,
+    cv_bridge::CvImageConstPtr image)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mQueue.size() >= mMaxQueueSize)
+  {
+    ++mStatistics[stream].numRejected;
+    return false;
+  }
+  enqueue(stream, filename, std::move(image));
+  return true;
+}
+
+//==============================================================================
+void ImageWriter::write(
+    const std::string& stream,
+    const std::string& filename,
+    cv_bridge::CvImageConstPtr image)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mSpaceAvailable.wait(
+      lock, [this] { return mStop || mQueue.size() < mMaxQueueSize; });
+  if (mStop)
+    return;
+  enqueue(stream, filename, std::move(image));
+}
+
+//==============================================================================
+void ImageWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mIdle.wait(lock, [this] { return mQueue.empty() && mNumInProgress == 0; });
+}
+
+//==============================================================================
+std::size_t ImageWriter::getQueueDepth() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mQueue.size() + mNumInProgress;
+}
+
+//==============================================================================
+std::size_t ImageWriter::getNumFreeSlots() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mMaxQueueSize - std::min(mMaxQueueSize, mQueue.size());
+}
+
+//==============================================================================
+ImageWriterStatistics ImageWriter::getStatistics(
+    const std::string& stream) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mStatistics.find(stream);
+  if (it == mStatistics.end())
+    return ImageWriterStatistics();
+  return it->second;
+}
+
+//==============================================================================
+void ImageWriter::enqueue(
+    const std::string& stream,
+    const std::string& filename,
+    cv_bridge::CvImageConstPtr image)
+{
+  Job job;
+  job.stream = stream;
+  job.config = mStreamConfigs[stream];
+  job.filename = filename + "." + job.config.format;
+  job.image = std::move(image);
+  job.sink = mSink;
+  mQueue.push_back(std::move(job));
+
+  auto& statistics = mStatistics[stream];
+  ++statistics.numQueued;
+  statistics.maxQueueDepth
+      = std::max(statistics.maxQueueDepth, mQueue.size() + mNumInProgress);
+  mJobAvailable.notify_one();
+}
+
+//==============================================================================
+void ImageWriter::workerLoop()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true)
+  {
+    mJobAvailable.wait(lock, [this] { return mStop || !mQueue.empty(); });
+    // Drain the queue before stopping so no captured image is lost.
+    if (mQueue.empty())
+      return;
+
+    Job job = std::move(mQueue.front());
+    mQueue.pop_front();
+    ++mNumInProgress;
+    mSpaceAvailable.notify_one();
+    lock.unlock();
+
+    auto start = std::chrono::steady_clock::now();
+    bool success = encodeAndWrite(job);
+    std::chrono::duration<double, std::milli> encodeTime
+        = std::chrono::steady_clock::now() - start;
+
+    if (!success)
+      ROS_WARN_STREAM("Failed to write " << job.filename);
+
+    lock.lock();
+    auto& statistics = mStatistics[job.stream];
+    if (success)
+      ++statistics.numWritten;
+    else
+      ++statistics.numFailed;
+    auto numEncoded = statistics.numWritten + statistics.numFailed;
+    statistics.meanEncodeTime
+        += (encodeTime - statistics.meanEncodeTime) / numEncoded;
+    statistics.maxEncodeTime = std::max(statistics.maxEncodeTime, encodeTime);
+
+    --mNumInProgress;
+    if (mQueue.empty() && mNumInProgress == 0)
+      mIdle.notify_all();
+  }
+}
+
+//==============================================================================
+bool ImageWriter::encodeAndWrite(const Job& job) const
+{
+  std::vector<int> params;
+  if (job.config.compression >= 0)
+  {
+    if (job.config.format == "png")
+    {
+      params = {cv::IMWRITE_PNG_COMPRESSION, job.config.compression};
+    }
+    else if (job.config.format == "jpg" || job.config.format == "jpeg")
+    {
+      params = {cv::IMWRITE_JPEG_QUALITY, job.config.compression};
+    }
+  }
+
+  std::vector<uchar> buffer;
+  if (job.config.format == depthcodec::FORMAT)
+  {
+    if (!encodeDepth(job.image->image, buffer))
+    {
+      ROS_ERROR_STREAM(
+          "Encoding " << job.filename << " failed: not a 16UC1 image");
+      return false;
+    }
+  }
+  else
+  {
+    try
+    {
+      if (!cv::imencode(
+              "." + job.config.format, job.image->image, buffer, params))
+        return false;
+    }
+    catch (const cv::Exception& e)
+    {
+      ROS_ERROR_STREAM("Encoding " << job.filename << " failed: " << e.what());
+      return false;
+    }
+  }
+
+  if (job.sink)
+    return job.sink(job.stream, *job.image, job.config.format, buffer);
+
+  std::ofstream file(job.filename, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  return static_cast<bool>(file);
+}
+
+} // namespace feeding
@@ -0,0 +1,215 @@
+#include "feeding/LookaheadPlanner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include <aikido/constraint/dart/JointStateSpaceHelpers.hpp>
+#include <aikido/robot/util.hpp>
+#include <aikido/statespace/GeodesicInterpolator.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSaver.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
+#include <aikido/trajectory/Spline.hpp>
+#include <aikido/trajectory/util.hpp>
+
+using aikido::constraint::dart::createTestableBounds;
+using aikido::statespace::GeodesicInterpolator;
+using aikido::statespace::dart::MetaSkeletonStateSaver;
+using aikido::statespace::dart::MetaSkeletonStateSpace;
+using aikido::trajectory::Interpolated;
+
+namespace feeding {
+
+//==============================================================================
+LookaheadPlanner::LookaheadPlanner(
+    std::shared_ptr<ada::Ada> ada, ros::NodeHandle nodeHandle)
+  : mAda(std::move(ada))
+{
+  nodeHandle.param<double>("/lookahead/startTolerance", mStartTolerance, 0.01);
+  nodeHandle.param<double>(
+      "/lookahead/collisionCheckResolution", mCollisionCheckResolution, 0.02);
+
+  auto arm = mAda->getArm()->getMetaSkeleton();
+  auto robot = arm->getBodyNode(0)->getSkeleton();
+  std::lock_guard<std::mutex> lock(robot->getMutex());
+  mSkeleton = robot->cloneSkeleton(robot->getName() + "_lookahead");
+
+  std::vector<dart::dynamics::DegreeOfFreedom*> dofs;
+  for (auto dof : arm->getDofs())
+    dofs.push_back(mSkeleton->getDof(dof->getName()));
+  mArm = dart::dynamics::Group::create("lookaheadArm", dofs);
+  mArmSpace = std::make_shared<MetaSkeletonStateSpace>(mArm.get());
+  mEndEffector = mSkeleton->getBodyNode(
+      mAda->getHand()->getEndEffectorBodyNode()->getName());
+}
+
+//==============================================================================
+LookaheadPlanner::~LookaheadPlanner()
+{
+  if (mPlan.valid())
+    mPlan.wait();
+}
+
+//==============================================================================
+void LookaheadPlanner::planEndEffectorOffset(
+    const Eigen::VectorXd& start,
+    const Eigen::Vector3d& direction,
+    double length,
+    double planningTimeout,
+    double endEffectorOffsetPositionTolerance,
+    double endEffectorOffsetAngularTolerance)
+{
+  if (mPlan.valid())
+    mPlan.wait();
+
+  // The copy is only used by the pending plan, which is done. Planning on it
+  // leaves the robot to the executor and the joint state updates.
+  {
+    auto arm = mAda->getArm()->getMetaSkeleton();
+    auto robot = arm->getBodyNode(0)->getSkeleton();
+    std::lock_guard<std::mutex> lock(robot->getMutex());
+    mSkeleton->setPositions(robot->getPositions());
+  }
+  mArm->setPositions(start);
+
+  mStart = start;
+  mPlan = std::async(std::launch::async, [=] {
+    try
+    {
+      // Joint limits only, like offsets planned without a collision
+      // constraint. Self collision is checked on the robot afterwards.
+      auto path = aikido::robot::util::planToEndEffectorOffset(
+          mArmSpace,
+          mArm,
+          mEndEffector,
+          createTestableBounds(mArmSpace),
+          direction,
+          length,
+          planningTimeout,
+          endEffectorOffsetPositionTolerance,
+          endEffectorOffsetAngularTolerance);
+      return path ? convertPath(*path) : nullptr;
+    }
+    catch (const std::exception& e)
+    {
+      ROS_WARN_STREAM("Lookahead planning failed: " << e.what());
+      return aikido::trajectory::TrajectoryPtr();
+    }
+  });
+}
+
+//==============================================================================
+Eigen::VectorXd LookaheadPlanner::getCurrentConfiguration() const
+{
+  auto metaSkeleton = mAda->getArm()->getMetaSkeleton();
+  auto skeleton = metaSkeleton->getBodyNode(0)->getSkeleton();
+  std::lock_guard<std::mutex> lock(skeleton->getMutex());
+  return metaSkeleton->getPositions();
+}
+
+//==============================================================================
+bool LookaheadPlanner::startsAtCurrentConfiguration() const
+{
+  if (!mPlan.valid())
+    return false;
+
+  Eigen::VectorXd current = getCurrentConfiguration();
+  return current.size() == mStart.size()
+         && (current - mStart).cwiseAbs().maxCoeff() <= mStartTolerance;
+}
+
+//==============================================================================
+aikido::trajectory::TrajectoryPtr LookaheadPlanner::getPath()
+{
+  if (!mPlan.valid())
+    return nullptr;
+
+  bool startsAtCurrent = startsAtCurrentConfiguration();
+  auto path = mPlan.get();
+  if (path && !startsAtCurrent)
+  {
+    ROS_INFO_STREAM("Arm is not where the lookahead plan starts");
+    return nullptr;
+  }
+  return path;
+}
+
+//==============================================================================
+Eigen::VectorXd LookaheadPlanner::getEndConfiguration(
+    const aikido::trajectory::Trajectory& path) const
+{
+  auto space = mAda->getArm()->getStateSpace();
+  auto state = space->createState();
+  path.evaluate(path.getEndTime(), state);
+
+  Eigen::VectorXd positions;
+  space->convertStateToPositions(state, positions);
+  return positions;
+}
+
+//==============================================================================
+aikido::trajectory::TrajectoryPtr LookaheadPlanner::convertPath(
+    const aikido::trajectory::Trajectory& path) const
+{
+  // The vector field planner returns splines; only the geometry is needed.
+  aikido::trajectory::UniqueInterpolatedPtr converted;
+  auto interpolated = dynamic_cast<const Interpolated*>(&path);
+  if (!interpolated)
+  {
+    auto spline = dynamic_cast<const aikido::trajectory::Spline*>(&path);
+    if (!spline)
+      return nullptr;
+    converted = aikido::trajectory::convertToInterpolated(
+        *spline, std::make_shared<GeodesicInterpolator>(mArmSpace));
+    interpolated = converted.get();
+  }
+  if (interpolated->getNumWaypoints() == 0)
+    return nullptr;
+
+  std::vector<Eigen::VectorXd> waypoints(interpolated->getNumWaypoints());
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    mArmSpace->convertStateToPositions(
+        static_cast<const MetaSkeletonStateSpace::State*>(
+            interpolated->getWaypoint(i)),
+        waypoints[i]);
+  }
+
+  auto arm = mAda->getArm();
+  auto space = arm->getStateSpace();
+  auto metaSkeleton = arm->getMetaSkeleton();
+  auto trajectory = std::make_shared<Interpolated>(
+      space, std::make_shared<GeodesicInterpolator>(space));
+  auto state = space->createState();
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    space->convertPositionsToState(waypoints[i], state);
+    trajectory->addWaypoint(i, state);
+  }
+
+  // Only the checks lock the robot, not the planning.
+  auto constraint
+      = mAda->getFullCollisionConstraint(space, metaSkeleton, nullptr);
+  auto skeleton = metaSkeleton->getBodyNode(0)->getSkeleton();
+  std::lock_guard<std::mutex> lock(skeleton->getMutex());
+  MetaSkeletonStateSaver saver(metaSkeleton);
+  for (std::size_t i = 1; i < waypoints.size(); ++i)
+  {
+    double distance
+        = (waypoints[i] - waypoints[i - 1]).cwiseAbs().maxCoeff();
+    int numSteps = std::max(
+        1, static_cast<int>(std::ceil(distance / mCollisionCheckResolution)));
+    for (int j = 1; j <= numSteps; ++j)
+    {
+      trajectory->evaluate(i - 1 + static_cast<double>(j) / numSteps, state);
+      if (!constraint->isSatisfied(state))
+      {
+        ROS_INFO_STREAM("Lookahead path is in self collision");
+        return nullptr;
+      }
+    }
+  }
+  return trajectory;
+}
+
+} // namespace feeding
@@ -0,0 +1,138 @@
+#include "feeding/OperatorInput.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <yaml-cpp/yaml.h>
+
+#include "std_msgs/String.h"
+
+namespace feeding {
+
+//==============================================================================
+std::string TtyOperatorInput::ask(const std::string& prompt)
+{
+  std::cout << "> " << std::flush;
+  std::string answer;
+  std::cin.clear();
+  if (!std::getline(std::cin, answer))
+  {
+    ROS_WARN_STREAM("No console input for " << prompt);
+    return "";
+  }
+  return answer;
+}
+
+//==============================================================================
+TopicOperatorInput::TopicOperatorInput(ros::NodeHandle nodeHandle)
+  : mAnswers(
+        nodeHandle,
+        nodeHandle.param<std::string>(
+            "/operatorInput/answerTopic", "/operator_input/answer"))
+{
+  std::string promptTopic;
+  nodeHandle.param<std::string>(
+      "/operatorInput/promptTopic", promptTopic, "/operator_input/prompt");
+  nodeHandle.param<double>("/operatorInput/timeout", mTimeout, 0.0);
+  mPromptPub = nodeHandle.advertise<std_msgs::String>(promptTopic, 1, true);
+}
+
+//==============================================================================
+std::string TopicOperatorInput::ask(const std::string& prompt)
+{
+  // Only answers sent after the prompt count.
+  auto answer = mAnswers.receive(ros::Time::now());
+  std_msgs::String msg;
+  msg.data = prompt;
+  mPromptPub.publish(msg);
+
+  if (mTimeout > 0
+      && answer.wait_for(std::chrono::duration<double>(mTimeout))
+             != std::future_status::ready)
+  {
+    mAnswers.cancel();
+    ROS_WARN_STREAM("No answer for " << prompt);
+    return "";
+  }
+  return answer.get();
+}
+
+//==============================================================================
+ScriptedOperatorInput::ScriptedOperatorInput(
+    const std::string& filename, const std::string& defaultAnswer)
+  : mDefaultAnswer(defaultAnswer)
+{
+  YAML::Node root;
+  try
+  {
+    root = YAML::LoadFile(filename);
+  }
+  catch (const YAML::Exception& e)
+  {
+    ROS_ERROR_STREAM("Cannot load operator answers from " << filename);
+    return;
+  }
+
+  for (const auto& node : root)
+  {
+    Entry entry;
+    entry.prompt = node["prompt"].as<std::string>("");
+    entry.answer = node["answer"].as<std::string>("");
+    entry.delay = node["delay"].as<double>(0.0);
+    entry.repeat = node["repeat"].as<bool>(false);
+    mEntries.push_back(entry);
+  }
+  ROS_INFO_STREAM(
+      "Loaded " << mEntries.size() << " operator answers from " << filename);
+}
+
+//==============================================================================
+std::string ScriptedOperatorInput::ask(const std::string& prompt)
+{
+  auto it = mEntries.begin();
+  while (it != mEntries.end() && prompt.find(it->prompt) == std::string::npos)
+    ++it;
+
+  if (it == mEntries.end())
+  {
+    ROS_WARN_STREAM(
+        "No scripted answer for " << prompt << ", answering \""
+                                  << mDefaultAnswer << "\"");
+    return mDefaultAnswer;
+  }
+
+  Entry entry = *it;
+  if (!entry.repeat)
+    mEntries.erase(it);
+  std::this_thread::sleep_for(std::chrono::duration<double>(entry.delay));
+  ROS_INFO_STREAM("Scripted answer to " << prompt << ": " << entry.answer);
+  return entry.answer;
+}
+
+//==============================================================================
+std::unique_ptr<OperatorInput> createOperatorInput(ros::NodeHandle nodeHandle)
+{
+  std::string backend;
+  nodeHandle.param<std::string>("/operatorInput/backend", backend, "tty");
+
+  if (backend == "topic")
+    return std::unique_ptr<OperatorInput>(new TopicOperatorInput(nodeHandle));
+
+  if (backend == "script")
+  {
+    std::string scriptFile;
+    std::string defaultAnswer;
+    nodeHandle.param<std::string>("/operatorInput/scriptFile", scriptFile, "");
+    nodeHandle.param<std::string>(
+        "/operatorInput/defaultAnswer", defaultAnswer, "");
+    return std::unique_ptr<OperatorInput>(
+        new ScriptedOperatorInput(scriptFile, defaultAnswer));
+  }
+
+  if (backend != "tty")
+    ROS_WARN_STREAM("Unknown operator input " << backend << ", using tty");
+  return std::unique_ptr<OperatorInput>(new TtyOperatorInput);
+}
+
+} // namespace feeding
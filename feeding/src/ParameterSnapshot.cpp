@@ -0,0 +1,142 @@
+#include "feeding/ParameterSnapshot.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include <libada/util.hpp>
+
+using ada::util::getRosParam;
+
+namespace feeding {
+
+namespace {
+
+//==============================================================================
+FTThresholdValues readThreshold(
+    const std::string& name, const ros::NodeHandle& nodeHandle)
+{
+  FTThresholdValues values;
+  values.force = getRosParam<double>(
+      "/ftSensor/thresholds/" + name + "/force", nodeHandle);
+  values.torque = getRosParam<double>(
+      "/ftSensor/thresholds/" + name + "/torque", nodeHandle);
+  return values;
+}
+
+} // namespace
+
+//==============================================================================
+ParameterSnapshot::ParameterSnapshot(ros::NodeHandle nodeHandle)
+  : mNodeHandle(nodeHandle)
+{
+  std::atomic_store(&mParameters, read());
+
+  std::string updateTopic;
+  mNodeHandle.param<std::string>(
+      "/parameterSnapshot/updateTopic",
+      updateTopic,
+      "/feeding/parameter_updates");
+  mUpdateSub = mNodeHandle.subscribe(
+      updateTopic, 1, &ParameterSnapshot::updateCallback, this);
+}
+
+//==============================================================================
+std::shared_ptr<const FeedingParameters> ParameterSnapshot::get() const
+{
+  return std::atomic_load(&mParameters);
+}
+
+//==============================================================================
+bool ParameterSnapshot::reload()
+{
+  std::shared_ptr<const FeedingParameters> parameters;
+  try
+  {
+    parameters = read();
+  }
+  catch (const std::runtime_error& e)
+  {
+    ROS_WARN_STREAM("Keeping previous parameters: " << e.what());
+    return false;
+  }
+
+  std::atomic_store(&mParameters, parameters);
+  ROS_INFO_STREAM("Reloaded feeding parameters.");
+  return true;
+}
+
+//==============================================================================
+std::shared_ptr<const FeedingParameters> ParameterSnapshot::read() const
+{
+  auto parameters = std::make_shared<FeedingParameters>();
+
+  // The human study and face parameters are optional and keep the
+  // defaults of FeedingParameters.
+  mNodeHandle.param<bool>(
+      "/humanStudy/autoAcquisition",
+      parameters->autoAcquisition,
+      parameters->autoAcquisition);
+  mNodeHandle.param<bool>(
+      "/humanStudy/autoTiming", parameters->autoTiming, parameters->autoTiming);
+  mNodeHandle.param<bool>(
+      "/humanStudy/autoTransfer",
+      parameters->autoTransfer,
+      parameters->autoTransfer);
+  mNodeHandle.param<bool>(
+      "/humanStudy/createError",
+      parameters->createError,
+      parameters->createError);
+  mNodeHandle.param<std::string>(
+      "/humanStudy/actionTopic",
+      parameters->actionTopic,
+      parameters->actionTopic);
+  mNodeHandle.param<std::string>(
+      "/humanStudy/foodTopic", parameters->foodTopic, parameters->foodTopic);
+  mNodeHandle.param<double>(
+      "/topicInput/maxAge",
+      parameters->topicInputMaxAge,
+      parameters->topicInputMaxAge);
+  mNodeHandle.param<double>(
+      "/feedingDemo/fixedFaceY",
+      parameters->fixedFaceY,
+      parameters->fixedFaceY);
+  mNodeHandle.param<double>(
+      "/lookahead/approachReplanDistance",
+      parameters->approachReplanDistance,
+      parameters->approachReplanDistance);
+
+  std::vector<double> tiltOffsetVector;
+  if (mNodeHandle.getParam("/study/tiltOffset", tiltOffsetVector))
+  {
+    if (tiltOffsetVector.size() != 3)
+      throw std::runtime_error("/study/tiltOffset needs 3 entries.");
+    parameters->tiltOffset = Eigen::Vector3d(
+        tiltOffsetVector[0], tiltOffsetVector[1], tiltOffsetVector[2]);
+  }
+
+  parameters->standardThreshold = readThreshold("standard", mNodeHandle);
+  parameters->grabFoodThreshold = readThreshold("grabFood", mNodeHandle);
+  parameters->afterGrabFoodThreshold
+      = readThreshold("afterGrabFood", mNodeHandle);
+
+  // Only the data collection config defines pushFood.
+  parameters->pushFoodThreshold = parameters->standardThreshold;
+  mNodeHandle.param<double>(
+      "/ftSensor/thresholds/pushFood/force",
+      parameters->pushFoodThreshold.force,
+      parameters->pushFoodThreshold.force);
+  mNodeHandle.param<double>(
+      "/ftSensor/thresholds/pushFood/torque",
+      parameters->pushFoodThreshold.torque,
+      parameters->pushFoodThreshold.torque);
+
+  return parameters;
+}
+
+//==============================================================================
+void ParameterSnapshot::updateCallback(const std_msgs::Empty::ConstPtr& /*msg*/)
+{
+  reload();
+}
+
+} // namespace feeding
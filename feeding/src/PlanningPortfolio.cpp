@@ -0,0 +1,231 @@
+#include "feeding/PlanningPortfolio.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <aikido/common/RNG.hpp>
+#include <aikido/constraint/TestableIntersection.hpp>
+#include <aikido/constraint/dart/JointStateSpaceHelpers.hpp>
+#include <aikido/robot/util.hpp>
+#include <aikido/statespace/GeodesicInterpolator.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSaver.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
+#include <dart/collision/fcl/fcl.hpp>
+
+#include "feeding/util.hpp"
+
+using aikido::constraint::TestableIntersection;
+using aikido::constraint::TestablePtr;
+using aikido::constraint::dart::CollisionFree;
+using aikido::constraint::dart::TSR;
+using aikido::constraint::dart::createTestableBounds;
+using aikido::statespace::GeodesicInterpolator;
+using aikido::statespace::dart::MetaSkeletonStateSaver;
+using aikido::statespace::dart::MetaSkeletonStateSpace;
+using aikido::trajectory::Interpolated;
+
+namespace feeding {
+
+//==============================================================================
+PlanningPortfolio::PlanningPortfolio(
+    std::shared_ptr<ada::Ada> ada,
+    aikido::constraint::dart::CollisionFreePtr collisionFree,
+    std::vector<dart::dynamics::ConstSkeletonPtr> environment,
+    ros::NodeHandle nodeHandle)
+  : mAda(std::move(ada))
+  , mCollisionFree(std::move(collisionFree))
+  , mEnvironment(std::move(environment))
+{
+  int maxNumCopies;
+  nodeHandle.param<int>("/planningPortfolio/numCopies", maxNumCopies, 4);
+  nodeHandle.param<double>(
+      "/planningPortfolio/collisionCheckResolution",
+      mCollisionCheckResolution,
+      0.02);
+  mMaxNumCopies = std::max(maxNumCopies, 1);
+}
+
+//==============================================================================
+PlanningPortfolio::~PlanningPortfolio()
+{
+  for (auto& copy : mCopies)
+  {
+    if (copy->mPlan.valid())
+      copy->mPlan.wait();
+  }
+}
+
+//==============================================================================
+aikido::constraint::dart::CollisionFreePtr
+PlanningPortfolio::getCollisionConstraint() const
+{
+  return mCollisionFree;
+}
+
+//==============================================================================
+std::pair<std::size_t, aikido::trajectory::TrajectoryPtr>
+PlanningPortfolio::plan(
+    const std::vector<aikido::constraint::dart::TSR>& tsrs,
+    double timelimit,
+    int maxNumTrials,
+    const Eigen::VectorXd& start)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  const std::size_t numPlans = std::min(tsrs.size(), mMaxNumCopies);
+  updateCopies(numPlans);
+  if (start.size() > 0)
+  {
+    for (std::size_t i = 0; i < numPlans; ++i)
+      mCopies[i]->mArm->setPositions(start);
+  }
+
+  std::random_device seeds;
+  for (std::size_t i = 0; i < numPlans; ++i)
+  {
+    Copy* copy = mCopies[i].get();
+    auto tsr = std::make_shared<TSR>(tsrs[i]);
+    auto seed = seeds();
+    copy->mPlan = std::async(std::launch::async, [=] {
+      aikido::common::RNGWrapper<std::mt19937> rng(seed);
+      try
+      {
+        return aikido::robot::util::planToTSR(
+            copy->mArmSpace,
+            copy->mArm,
+            copy->mEndEffector,
+            tsr,
+            copy->mConstraint,
+            &rng,
+            timelimit,
+            maxNumTrials,
+            getConfigurationRanker(copy->mArmSpace, copy->mArm));
+      }
+      catch (const std::exception& e)
+      {
+        ROS_WARN_STREAM("Portfolio planner failed: " << e.what());
+        return aikido::trajectory::TrajectoryPtr();
+      }
+    });
+  }
+
+  // Planners for looser TSRs keep running if a tighter one succeeded;
+  // they are waited for before their copies are used again.
+  for (std::size_t i = 0; i < numPlans; ++i)
+  {
+    auto path = mCopies[i]->mPlan.get();
+    auto trajectory = path ? convertPath(*mCopies[i], *path) : nullptr;
+    if (trajectory)
+      return std::make_pair(i, trajectory);
+  }
+  return std::make_pair(numPlans, aikido::trajectory::TrajectoryPtr());
+}
+
+//==============================================================================
+void PlanningPortfolio::updateCopies(std::size_t numCopies)
+{
+  for (auto& copy : mCopies)
+  {
+    if (copy->mPlan.valid())
+      copy->mPlan.wait();
+  }
+
+  auto arm = mAda->getArm()->getMetaSkeleton();
+  auto robot = arm->getBodyNode(0)->getSkeleton();
+  std::lock_guard<std::mutex> lock(robot->getMutex());
+  while (mCopies.size() < numCopies)
+  {
+    std::unique_ptr<Copy> copy(new Copy);
+    copy->mSkeleton = robot->cloneSkeleton(
+        robot->getName() + "_portfolio" + std::to_string(mCopies.size()));
+
+    std::vector<dart::dynamics::DegreeOfFreedom*> dofs;
+    for (auto dof : arm->getDofs())
+      dofs.push_back(copy->mSkeleton->getDof(dof->getName()));
+    copy->mArm = dart::dynamics::Group::create("portfolioArm", dofs);
+    copy->mArmSpace
+        = std::make_shared<MetaSkeletonStateSpace>(copy->mArm.get());
+    copy->mEndEffector = copy->mSkeleton->getBodyNode(
+        mAda->getHand()->getEndEffectorBodyNode()->getName());
+
+    // Same checks as the mirrored constraint, with a detector of its own.
+    auto collisionDetector = dart::collision::FCLCollisionDetector::create();
+    auto armCollisionGroup = collisionDetector->createCollisionGroup(
+        copy->mSkeleton.get(), copy->mEndEffector.get());
+    auto envCollisionGroup = collisionDetector->createCollisionGroup();
+    for (const auto& skeleton : mEnvironment)
+      envCollisionGroup->addShapeFramesOf(skeleton.get());
+    auto collisionFree = std::make_shared<CollisionFree>(
+        copy->mArmSpace, copy->mArm, collisionDetector);
+    collisionFree->addPairwiseCheck(armCollisionGroup, envCollisionGroup);
+
+    copy->mConstraint = std::make_shared<TestableIntersection>(
+        copy->mArmSpace,
+        std::vector<TestablePtr>{collisionFree,
+                                 createTestableBounds(copy->mArmSpace)});
+    mCopies.push_back(std::move(copy));
+  }
+
+  const Eigen::VectorXd positions = robot->getPositions();
+  for (std::size_t i = 0; i < numCopies; ++i)
+    mCopies[i]->mSkeleton->setPositions(positions);
+}
+
+//==============================================================================
+aikido::trajectory::TrajectoryPtr PlanningPortfolio::convertPath(
+    const Copy& copy, const aikido::trajectory::Trajectory& path) const
+{
+  auto interpolated = dynamic_cast<const Interpolated*>(&path);
+  if (!interpolated || interpolated->getNumWaypoints() == 0)
+    return nullptr;
+
+  std::vector<Eigen::VectorXd> waypoints(interpolated->getNumWaypoints());
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    copy.mArmSpace->convertStateToPositions(
+        static_cast<const MetaSkeletonStateSpace::State*>(
+            interpolated->getWaypoint(i)),
+        waypoints[i]);
+  }
+
+  auto arm = mAda->getArm();
+  auto space = arm->getStateSpace();
+  auto metaSkeleton = arm->getMetaSkeleton();
+  auto trajectory = std::make_shared<Interpolated>(
+      space, std::make_shared<GeodesicInterpolator>(space));
+  auto state = space->createState();
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    space->convertPositionsToState(waypoints[i], state);
+    trajectory->addWaypoint(i, state);
+  }
+
+  // The copies do not check self collision; the robot does.
+  auto constraint
+      = mAda->getFullCollisionConstraint(space, metaSkeleton, mCollisionFree);
+  auto skeleton = metaSkeleton->getBodyNode(0)->getSkeleton();
+  std::lock_guard<std::mutex> lock(skeleton->getMutex());
+  MetaSkeletonStateSaver saver(metaSkeleton);
+  for (std::size_t i = 1; i < waypoints.size(); ++i)
+  {
+    // Wrapping joints move less than this, so this checks at least as
+    // finely as the resolution.
+    double distance
+        = (waypoints[i] - waypoints[i - 1]).cwiseAbs().maxCoeff();
+    int numSteps = std::max(
+        1, static_cast<int>(std::ceil(distance / mCollisionCheckResolution)));
+    for (int j = 1; j <= numSteps; ++j)
+    {
+      trajectory->evaluate(i - 1 + static_cast<double>(j) / numSteps, state);
+      if (!constraint->isSatisfied(state))
+      {
+        ROS_INFO_STREAM("Portfolio path is in collision on the robot");
+        return nullptr;
+      }
+    }
+  }
+  return trajectory;
+}
+
+} // namespace feeding
@@ -0,0 +1,326 @@
+#include "feeding/Retimer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <sstream>
+
+#include <aikido/planner/kunzretimer/KunzRetimer.hpp>
+#include <aikido/planner/parabolic/ParabolicTimer.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSaver.hpp>
+
+using aikido::planner::kunzretimer::computeKunzTiming;
+using aikido::planner::parabolic::computeParabolicTiming;
+using aikido::statespace::dart::MetaSkeletonStateSaver;
+using aikido::trajectory::Interpolated;
+using aikido::trajectory::Spline;
+using aikido::trajectory::UniqueSplinePtr;
+
+namespace feeding {
+
+namespace {
+
+/// Time step of the limit check, in seconds.
+const double LIMIT_CHECK_TIME_STEP = 0.01;
+
+//==============================================================================
+Retimer::Option createKunzOption(double maxDeviation, double timeStep)
+{
+  std::ostringstream name;
+  name << "kunz " << maxDeviation << "/" << timeStep;
+  return Retimer::Option{name.str(), true, maxDeviation, timeStep};
+}
+
+} // namespace
+
+//==============================================================================
+std::vector<Retimer::Option> Retimer::getDefaultOptions()
+{
+  return std::vector<Option>{
+      Option{"parabolic", false, 0, 0},
+      createKunzOption(KUNZ_MAX_DEVIATION, KUNZ_TIME_STEP),
+      createKunzOption(KUNZ_MAX_DEVIATION, KUNZ_COARSE_TIME_STEP)};
+}
+
+//==============================================================================
+Retimer::Retimer(ros::NodeHandle nodeHandle)
+{
+  std::vector<double> kunzSettings;
+  nodeHandle.param<std::vector<double>>(
+      "/retimer/kunzSettings", kunzSettings, std::vector<double>());
+  nodeHandle.param<double>("/retimer/limitTolerance", mLimitTolerance, 0.05);
+  nodeHandle.param<int>("/retimer/reevaluateEvery", mReevaluateEvery, 20);
+  nodeHandle.param<double>(
+      "/retimer/collisionCheckResolution", mCollisionCheckResolution, 0.02);
+
+  if (kunzSettings.empty())
+  {
+    mOptions = getDefaultOptions();
+    return;
+  }
+  mOptions.push_back(Option{"parabolic", false, 0, 0});
+  for (std::size_t i = 0; i + 1 < kunzSettings.size(); i += 2)
+    mOptions.push_back(createKunzOption(kunzSettings[i], kunzSettings[i + 1]));
+}
+
+//==============================================================================
+Retimer::Retimer(
+    std::vector<Option> options, double limitTolerance, int reevaluateEvery)
+  : mOptions(std::move(options))
+  , mLimitTolerance(limitTolerance)
+  , mReevaluateEvery(reevaluateEvery)
+  , mCollisionCheckResolution(0.02)
+{
+  // Do nothing
+}
+
+//==============================================================================
+const std::vector<Retimer::Option>& Retimer::getOptions() const
+{
+  return mOptions;
+}
+
+//==============================================================================
+std::vector<Retimer::Result> Retimer::compare(
+    const Interpolated& path,
+    const Eigen::VectorXd& velocityLimits,
+    const Eigen::VectorXd& accelerationLimits) const
+{
+  std::vector<Result> results;
+  for (std::size_t i = 0; i < mOptions.size(); ++i)
+  {
+    Result result;
+    result.option = i;
+    auto start = std::chrono::steady_clock::now();
+    result.trajectory
+        = retime(mOptions[i], path, velocityLimits, accelerationLimits);
+    std::chrono::duration<double> computeTime
+        = std::chrono::steady_clock::now() - start;
+    result.computeTime = computeTime.count();
+    result.duration = result.trajectory
+                          ? result.trajectory->getDuration()
+                          : std::numeric_limits<double>::infinity();
+    result.isWithinLimits
+        = result.trajectory
+          && isWithinLimits(
+              *result.trajectory, velocityLimits, accelerationLimits);
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+//==============================================================================
+UniqueSplinePtr Retimer::retime(
+    const std::string& motion,
+    const Interpolated& path,
+    const Eigen::VectorXd& velocityLimits,
+    const Eigen::VectorXd& accelerationLimits,
+    const std::function<bool(const Spline&)>& isValid)
+{
+  std::size_t option = mOptions.size();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mChoices.find(motion);
+    if (it != mChoices.end() && it->second.numUses < mReevaluateEvery)
+    {
+      ++it->second.numUses;
+      option = it->second.option;
+    }
+  }
+
+  if (option < mOptions.size())
+  {
+    auto trajectory
+        = retime(mOptions[option], path, velocityLimits, accelerationLimits);
+    if (trajectory
+        && isWithinLimits(*trajectory, velocityLimits, accelerationLimits)
+        && (!isValid || isValid(*trajectory)))
+      return trajectory;
+    ROS_INFO_STREAM(
+        mOptions[option].name << " failed for " << motion
+                              << ", comparing all retimers");
+  }
+
+  auto results = compare(path, velocityLimits, accelerationLimits);
+  std::vector<Result*> candidates;
+  for (auto& result : results)
+  {
+    if (result.isWithinLimits)
+      candidates.push_back(&result);
+  }
+  std::sort(
+      candidates.begin(),
+      candidates.end(),
+      [](const Result* lhs, const Result* rhs) {
+        return lhs->duration < rhs->duration;
+      });
+  // Only as many candidates are checked as it takes to find a valid one.
+  Result* best = nullptr;
+  for (auto candidate : candidates)
+  {
+    if (!isValid || isValid(*candidate->trajectory))
+    {
+      best = candidate;
+      break;
+    }
+    ROS_INFO_STREAM(
+        mOptions[candidate->option].name << " is invalid for " << motion);
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!best)
+  {
+    ROS_WARN_STREAM("No retimer timed " << motion << " within the limits");
+    mChoices.erase(motion);
+    return nullptr;
+  }
+  ROS_INFO_STREAM(
+      "Retiming " << motion << " with " << mOptions[best->option].name << " ("
+                  << best->duration << "s)");
+  mChoices[motion] = Choice{best->option, 1};
+  return std::move(best->trajectory);
+}
+
+//==============================================================================
+bool Retimer::moveArm(
+    const std::shared_ptr<ada::Ada>& ada,
+    const std::string& motion,
+    const aikido::trajectory::TrajectoryPtr& path,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+    const std::vector<double>& velocityLimits,
+    const std::shared_ptr<TrajectoryDumpWriter>& dump)
+{
+  auto interpolated = dynamic_cast<const Interpolated*>(path.get());
+  if (!interpolated)
+  {
+    return ada->moveArmOnTrajectory(
+        path,
+        collisionFree,
+        ::ada::TrajectoryPostprocessType::KUNZ,
+        velocityLimits);
+  }
+
+  auto metaSkeleton = ada->getArm()->getMetaSkeleton();
+  Eigen::VectorXd velocityUpperLimits = metaSkeleton->getVelocityUpperLimits();
+  if (velocityLimits.size() == velocityUpperLimits.size())
+  {
+    velocityUpperLimits = Eigen::Map<const Eigen::VectorXd>(
+        velocityLimits.data(), velocityLimits.size());
+  }
+
+  aikido::trajectory::TrajectoryPtr trajectory = retime(
+      motion,
+      *interpolated,
+      velocityUpperLimits,
+      metaSkeleton->getAccelerationUpperLimits(),
+      [&](const Spline& spline) {
+        return isCollisionFree(ada, spline, collisionFree, velocityUpperLimits);
+      });
+  if (!trajectory)
+    return false;
+
+  auto spline = static_cast<const Spline*>(trajectory.get());
+  if (dump)
+    dump->append(*spline, motion, ros::Time::now().toSec());
+
+  try
+  {
+    ada->getTrajectoryExecutor()->execute(trajectory).get();
+  }
+  catch (const std::exception& e)
+  {
+    ROS_WARN_STREAM("Execution of " << motion << " failed: " << e.what());
+    return false;
+  }
+  return true;
+}
+
+//==============================================================================
+std::size_t Retimer::getChoice(const std::string& motion) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mChoices.find(motion);
+  return it == mChoices.end() ? mOptions.size() : it->second.option;
+}
+
+//==============================================================================
+bool Retimer::isWithinLimits(
+    const Spline& trajectory,
+    const Eigen::VectorXd& velocityLimits,
+    const Eigen::VectorXd& accelerationLimits) const
+{
+  const Eigen::VectorXd maxVelocities
+      = velocityLimits.cwiseAbs() * (1 + mLimitTolerance);
+  const Eigen::VectorXd maxAccelerations
+      = accelerationLimits.cwiseAbs() * (1 + mLimitTolerance);
+
+  Eigen::VectorXd velocity;
+  Eigen::VectorXd acceleration;
+  for (double t = trajectory.getStartTime(); t <= trajectory.getEndTime();
+       t += LIMIT_CHECK_TIME_STEP)
+  {
+    trajectory.evaluateDerivative(t, 1, velocity);
+    trajectory.evaluateDerivative(t, 2, acceleration);
+    if ((velocity.cwiseAbs().array() > maxVelocities.array()).any()
+        || (acceleration.cwiseAbs().array() > maxAccelerations.array()).any())
+      return false;
+  }
+  return true;
+}
+
+//==============================================================================
+bool Retimer::isCollisionFree(
+    const std::shared_ptr<ada::Ada>& ada,
+    const Spline& trajectory,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+    const Eigen::VectorXd& velocityLimits) const
+{
+  if (!collisionFree)
+    return true;
+
+  // The trajectory is within the velocity limits, so no joint moves more
+  // than the resolution (plus the limit tolerance) between checks.
+  double timeStep = mCollisionCheckResolution
+                    / std::max(velocityLimits.cwiseAbs().maxCoeff(), 1e-6);
+  auto metaSkeleton = ada->getArm()->getMetaSkeleton();
+  auto skeleton = metaSkeleton->getBodyNode(0)->getSkeleton();
+  auto state = trajectory.getStateSpace()->createState();
+  std::lock_guard<std::mutex> lock(skeleton->getMutex());
+  MetaSkeletonStateSaver saver(metaSkeleton);
+  for (double t = trajectory.getStartTime();; t += timeStep)
+  {
+    trajectory.evaluate(std::min(t, trajectory.getEndTime()), state);
+    if (!collisionFree->isSatisfied(state))
+      return false;
+    if (t >= trajectory.getEndTime())
+      return true;
+  }
+}
+
+//==============================================================================
+UniqueSplinePtr Retimer::retime(
+    const Option& option,
+    const Interpolated& path,
+    const Eigen::VectorXd& velocityLimits,
+    const Eigen::VectorXd& accelerationLimits) const
+{
+  try
+  {
+    if (!option.kunz)
+      return computeParabolicTiming(path, velocityLimits, accelerationLimits);
+    return computeKunzTiming(
+        path,
+        velocityLimits,
+        accelerationLimits,
+        option.maxDeviation,
+        option.timeStep);
+  }
+  catch (const std::exception& e)
+  {
+    ROS_DEBUG_STREAM(option.name << " failed: " << e.what());
+    return nullptr;
+  }
+}
+
+} // namespace feeding
@@ -0,0 +1,613 @@
+#include "feeding/Roadmap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <set>
+
+#include <aikido/common/RNG.hpp>
+#include <aikido/constraint/dart/InverseKinematicsSampleable.hpp>
+#include <aikido/constraint/dart/JointStateSpaceHelpers.hpp>
+#include <aikido/statespace/GeodesicInterpolator.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSaver.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
+#include <dart/dynamics/InverseKinematics.hpp>
+
+using aikido::constraint::dart::InverseKinematicsSampleable;
+using aikido::constraint::dart::TSR;
+using aikido::constraint::dart::createSampleableBounds;
+using aikido::statespace::GeodesicInterpolator;
+using aikido::statespace::dart::MetaSkeletonStateSaver;
+using aikido::trajectory::Interpolated;
+
+namespace feeding {
+
+namespace {
+
+static const char MAGIC[8] = {'F', 'E', 'E', 'D', 'P', 'R', 'M', '\0'};
+static const std::uint32_t VERSION = 1;
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t dimension;
+  std::uint32_t numNodes;
+  std::uint32_t numEdges;
+};
+
+} // namespace
+
+//==============================================================================
+Roadmap::Roadmap(std::size_t numDofs, ros::NodeHandle nodeHandle)
+  : mNumDofs(numDofs)
+{
+  int numNodes, numNeighbors, numGoals, maxNumSearches, seed;
+  nodeHandle.param<std::string>("/roadmap/file", mFilename, "");
+  nodeHandle.param<int>("/roadmap/numNodes", numNodes, 3000);
+  nodeHandle.param<int>("/roadmap/numNeighbors", numNeighbors, 10);
+  nodeHandle.param<int>("/roadmap/numGoals", numGoals, 5);
+  nodeHandle.param<int>("/roadmap/maxNumGoalTrials", mMaxNumGoalTrials, 50);
+  nodeHandle.param<int>("/roadmap/maxNumSearches", maxNumSearches, 20);
+  nodeHandle.param<double>(
+      "/roadmap/collisionCheckResolution", mCollisionCheckResolution, 0.02);
+  nodeHandle.param<int>("/roadmap/seed", seed, 0);
+  mNumNodes = numNodes;
+  mNumNeighbors = numNeighbors;
+  mNumGoals = numGoals;
+  mMaxNumSearches = maxNumSearches;
+  mSeed = seed;
+  mGoalRandom.seed(mSeed);
+
+  if (!mFilename.empty())
+    load(mFilename);
+}
+
+//==============================================================================
+bool Roadmap::isEmpty() const
+{
+  return mNodes.empty();
+}
+
+//==============================================================================
+void Roadmap::setGoalSeedCache(std::shared_ptr<GoalSeedCache> goalSeeds)
+{
+  mGoalSeeds = std::move(goalSeeds);
+}
+
+//==============================================================================
+void Roadmap::build(
+    const std::shared_ptr<ada::Ada>& ada,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree)
+{
+  auto arm = ada->getArm();
+  auto metaSkeleton = arm->getMetaSkeleton();
+  auto skeleton = metaSkeleton->getBodyNode(0)->getSkeleton();
+  std::lock_guard<std::mutex> lock(skeleton->getMutex());
+  MetaSkeletonStateSaver saver(metaSkeleton);
+
+  const Eigen::VectorXd lowerLimits = metaSkeleton->getPositionLowerLimits();
+  const Eigen::VectorXd upperLimits = metaSkeleton->getPositionUpperLimits();
+  const std::size_t dimension = lowerLimits.size();
+  mIsCyclic.resize(dimension);
+  std::vector<std::uniform_real_distribution<double>> distributions;
+  for (std::size_t i = 0; i < dimension; ++i)
+  {
+    mIsCyclic[i] = std::isinf(lowerLimits[i]) || std::isinf(upperLimits[i]);
+    if (mIsCyclic[i])
+      distributions.emplace_back(-M_PI, M_PI);
+    else
+      distributions.emplace_back(lowerLimits[i], upperLimits[i]);
+  }
+
+  mNodes.clear();
+  mEdges.clear();
+
+  auto space = arm->getStateSpace();
+  auto state = space->createState();
+  std::mt19937 rng(mSeed);
+  std::size_t numSamples = 0;
+  while (mNodes.size() < mNumNodes && numSamples < 100 * mNumNodes)
+  {
+    ++numSamples;
+    Eigen::VectorXd positions(dimension);
+    for (std::size_t i = 0; i < dimension; ++i)
+      positions[i] = distributions[i](rng);
+
+    space->convertPositionsToState(positions, state);
+    if (!collisionFree || collisionFree->isSatisfied(state))
+      mNodes.push_back(positions);
+  }
+  ROS_INFO_STREAM(
+      "Sampled " << mNodes.size() << " roadmap nodes out of " << numSamples
+                 << " configurations");
+
+  // Edges are undirected, so each pair of nodes is only checked once.
+  std::set<Edge> checkedEdges;
+  for (std::size_t i = 0; i < mNodes.size(); ++i)
+  {
+    // The node itself is the nearest one.
+    for (auto j : getNearestNodes(mNodes[i], mNumNeighbors + 1))
+    {
+      Edge edge(std::min(i, j), std::max(i, j));
+      if (j == i || !checkedEdges.insert(edge).second)
+        continue;
+
+      if (isMotionCollisionFree(ada, mNodes[i], mNodes[j], collisionFree))
+        mEdges.push_back(edge);
+    }
+
+    if ((i + 1) % (mNodes.size() / 10 + 1) == 0)
+    {
+      ROS_INFO_STREAM(
+          "Connected " << i + 1 << " of " << mNodes.size() << " nodes, "
+                       << mEdges.size() << " edges");
+    }
+  }
+  updateAdjacency();
+}
+
+//==============================================================================
+aikido::trajectory::TrajectoryPtr Roadmap::planToTSR(
+    const std::shared_ptr<ada::Ada>& ada,
+    const aikido::constraint::dart::TSR& tsr,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree) const
+{
+  auto arm = ada->getArm();
+  auto metaSkeleton = arm->getMetaSkeleton();
+  if (mNodes.empty() || metaSkeleton->getNumDofs() != mIsCyclic.size())
+    return nullptr;
+
+  std::vector<Eigen::VectorXd> path;
+  {
+    // Sampling and checking set the positions of the arm, which joint state
+    // updates write as well.
+    auto skeleton = metaSkeleton->getBodyNode(0)->getSkeleton();
+    std::lock_guard<std::mutex> lock(skeleton->getMutex());
+    MetaSkeletonStateSaver saver(metaSkeleton);
+
+    const Eigen::VectorXd start = metaSkeleton->getPositions();
+    auto goals = sampleGoals(ada, tsr, collisionFree);
+    if (goals.empty())
+      return nullptr;
+
+    // Vertices are the roadmap nodes followed by the goals.
+    const std::size_t numNodes = mNodes.size();
+    const std::size_t numVertices = numNodes + goals.size();
+    const std::size_t none = numVertices;
+    auto isMotionFree = [&](const Eigen::VectorXd& from,
+                            const Eigen::VectorXd& to) {
+      return isMotionCollisionFree(ada, from, to, collisionFree);
+    };
+
+    std::vector<std::pair<std::size_t, double>> startEdges;
+    for (std::size_t i = 0; i < goals.size(); ++i)
+    {
+      if (isMotionFree(start, goals[i]))
+        startEdges.emplace_back(numNodes + i, getDistance(start, goals[i]));
+    }
+    for (auto node : getNearestNodes(start, mNumNeighbors))
+    {
+      if (isMotionFree(start, mNodes[node]))
+        startEdges.emplace_back(node, getDistance(start, mNodes[node]));
+    }
+
+    std::vector<std::vector<std::pair<std::size_t, double>>> goalEdges(
+        numNodes);
+    for (std::size_t i = 0; i < goals.size(); ++i)
+    {
+      for (auto node : getNearestNodes(goals[i], mNumNeighbors))
+      {
+        if (isMotionFree(mNodes[node], goals[i]))
+        {
+          goalEdges[node].emplace_back(
+              numNodes + i, getDistance(mNodes[node], goals[i]));
+        }
+      }
+    }
+
+    // Roadmap edges were checked against the static workspace only; they
+    // are checked against collisionFree once they are on a path.
+    std::vector<char> isEdgeChecked(mEdges.size(), false);
+    std::vector<char> isEdgeBlocked(mEdges.size(), false);
+    for (std::size_t search = 0; search < mMaxNumSearches; ++search)
+    {
+      std::vector<double> costs(
+          numVertices, std::numeric_limits<double>::infinity());
+      std::vector<std::size_t> previous(numVertices, none);
+      std::vector<std::size_t> previousEdge(numVertices, mEdges.size());
+      using Entry = std::pair<double, std::size_t>;
+      std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+          queue;
+      for (const auto& edge : startEdges)
+      {
+        costs[edge.first] = std::min(costs[edge.first], edge.second);
+        queue.emplace(edge.second, edge.first);
+      }
+
+      std::size_t goal = none;
+      while (!queue.empty())
+      {
+        auto entry = queue.top();
+        queue.pop();
+        std::size_t vertex = entry.second;
+        if (entry.first > costs[vertex])
+          continue;
+        if (vertex >= numNodes)
+        {
+          goal = vertex;
+          break;
+        }
+
+        auto relax = [&](std::size_t next, double cost, std::size_t edge) {
+          if (costs[vertex] + cost < costs[next])
+          {
+            costs[next] = costs[vertex] + cost;
+            previous[next] = vertex;
+            previousEdge[next] = edge;
+            queue.emplace(costs[next], next);
+          }
+        };
+        for (const auto& neighbor : mAdjacency[vertex])
+        {
+          if (!isEdgeBlocked[neighbor.second])
+          {
+            relax(
+                neighbor.first,
+                getDistance(mNodes[vertex], mNodes[neighbor.first]),
+                neighbor.second);
+          }
+        }
+        for (const auto& edge : goalEdges[vertex])
+          relax(edge.first, edge.second, mEdges.size());
+      }
+
+      if (goal == none)
+        return nullptr;
+
+      std::vector<std::size_t> vertices;
+      for (auto vertex = goal; vertex != none; vertex = previous[vertex])
+        vertices.push_back(vertex);
+      std::reverse(vertices.begin(), vertices.end());
+
+      bool isBlocked = false;
+      for (auto vertex : vertices)
+      {
+        auto edge = previousEdge[vertex];
+        if (edge == mEdges.size() || isEdgeChecked[edge])
+          continue;
+
+        isEdgeChecked[edge] = true;
+        if (!isMotionFree(
+                mNodes[mEdges[edge].first], mNodes[mEdges[edge].second]))
+        {
+          isEdgeBlocked[edge] = true;
+          isBlocked = true;
+        }
+      }
+      if (isBlocked)
+        continue;
+
+      path.push_back(start);
+      for (auto vertex : vertices)
+      {
+        path.push_back(
+            vertex < numNodes ? mNodes[vertex] : goals[vertex - numNodes]);
+      }
+      break;
+    }
+    if (path.empty())
+      return nullptr;
+
+    // Shortcut greedily to the furthest waypoint that can be reached
+    // directly.
+    std::vector<Eigen::VectorXd> shortcut{path.front()};
+    for (std::size_t i = 0; i + 1 < path.size();)
+    {
+      std::size_t j = path.size() - 1;
+      while (j > i + 1 && !isMotionFree(path[i], path[j]))
+        --j;
+      shortcut.push_back(path[j]);
+      i = j;
+    }
+    path = std::move(shortcut);
+  }
+
+  auto space = arm->getStateSpace();
+  auto trajectory = std::make_shared<Interpolated>(
+      space, std::make_shared<GeodesicInterpolator>(space));
+  auto state = space->createState();
+  for (std::size_t i = 0; i < path.size(); ++i)
+  {
+    space->convertPositionsToState(path[i], state);
+    trajectory->addWaypoint(i, state);
+  }
+  return trajectory;
+}
+
+//==============================================================================
+bool Roadmap::moveArmToTSR(
+    const std::shared_ptr<ada::Ada>& ada,
+    const aikido::constraint::dart::TSR& tsr,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+    double planningTimeout,
+    int maxNumTrials,
+    const aikido::distance::ConfigurationRankerPtr& ranker,
+    const std::vector<double>& velocityLimits) const
+{
+  auto trajectory = planToTSR(ada, tsr, collisionFree);
+  if (!trajectory)
+  {
+    ROS_INFO_STREAM("No roadmap path, planning from scratch");
+    if (mGoalSeeds)
+    {
+      trajectory = mGoalSeeds->planToTSR(
+          ada, tsr, collisionFree, planningTimeout, maxNumTrials, ranker);
+    }
+    else
+    {
+      trajectory = ada->planArmToTSR(
+          tsr, collisionFree, planningTimeout, maxNumTrials, ranker);
+    }
+  }
+
+  return trajectory
+         && ada->moveArmOnTrajectory(
+             trajectory,
+             collisionFree,
+             ::ada::TrajectoryPostprocessType::KUNZ,
+             velocityLimits);
+}
+
+//==============================================================================
+bool Roadmap::load(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  FileHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+      || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+      || header.version != VERSION)
+  {
+    ROS_INFO_STREAM("No roadmap loaded from " << filename);
+    return false;
+  }
+  if (header.dimension != mNumDofs)
+  {
+    ROS_WARN_STREAM(
+        "Roadmap " << filename << " has dimension " << header.dimension
+                   << " but the arm has " << mNumDofs << " dofs");
+    return false;
+  }
+
+  // Check the size before allocating, so that a corrupt header cannot
+  // request huge vectors.
+  const std::uint64_t expectedSize
+      = sizeof(header) + header.dimension
+        + static_cast<std::uint64_t>(header.numNodes) * header.dimension
+              * sizeof(double)
+        + static_cast<std::uint64_t>(header.numEdges)
+              * (sizeof(Edge::first_type) + sizeof(Edge::second_type));
+  const std::streampos dataStart = file.tellg();
+  file.seekg(0, std::ios::end);
+  const std::uint64_t fileSize = static_cast<std::uint64_t>(file.tellg());
+  file.seekg(dataStart);
+  if (!file || fileSize < expectedSize)
+  {
+    ROS_WARN_STREAM("Roadmap " << filename << " is truncated");
+    return false;
+  }
+
+  std::vector<std::uint8_t> isCyclic(header.dimension);
+  std::vector<Eigen::VectorXd> nodes(
+      header.numNodes, Eigen::VectorXd(header.dimension));
+  std::vector<Edge> edges(header.numEdges);
+  file.read(reinterpret_cast<char*>(isCyclic.data()), isCyclic.size());
+  for (auto& node : nodes)
+  {
+    file.read(
+        reinterpret_cast<char*>(node.data()),
+        header.dimension * sizeof(double));
+  }
+  for (auto& edge : edges)
+  {
+    file.read(reinterpret_cast<char*>(&edge.first), sizeof(edge.first));
+    file.read(reinterpret_cast<char*>(&edge.second), sizeof(edge.second));
+  }
+  if (!file)
+  {
+    ROS_WARN_STREAM("Roadmap " << filename << " is truncated");
+    return false;
+  }
+  for (const auto& edge : edges)
+  {
+    if (edge.first >= header.numNodes || edge.second >= header.numNodes)
+    {
+      ROS_WARN_STREAM("Roadmap " << filename << " has invalid edges");
+      return false;
+    }
+  }
+
+  mIsCyclic.assign(isCyclic.begin(), isCyclic.end());
+  mNodes = std::move(nodes);
+  mEdges = std::move(edges);
+  updateAdjacency();
+  ROS_INFO_STREAM(
+      "Loaded roadmap with " << mNodes.size() << " nodes and "
+                             << mEdges.size() << " edges from " << filename);
+  return true;
+}
+
+//==============================================================================
+bool Roadmap::save(const std::string& filename) const
+{
+  FileHeader header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.dimension = mIsCyclic.size();
+  header.numNodes = mNodes.size();
+  header.numEdges = mEdges.size();
+
+  // Write to a temporary file first so a crash never leaves a broken file.
+  const std::string tmpFilename = filename + ".tmp";
+  {
+    std::ofstream outFile(tmpFilename, std::ios::binary);
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<std::uint8_t> isCyclic(mIsCyclic.begin(), mIsCyclic.end());
+    outFile.write(
+        reinterpret_cast<const char*>(isCyclic.data()), isCyclic.size());
+    for (const auto& node : mNodes)
+    {
+      outFile.write(
+          reinterpret_cast<const char*>(node.data()),
+          node.size() * sizeof(double));
+    }
+    for (const auto& edge : mEdges)
+    {
+      outFile.write(
+          reinterpret_cast<const char*>(&edge.first), sizeof(edge.first));
+      outFile.write(
+          reinterpret_cast<const char*>(&edge.second), sizeof(edge.second));
+    }
+    if (!outFile)
+    {
+      ROS_WARN_STREAM("Failed to write roadmap to " << filename);
+      return false;
+    }
+  }
+  return std::rename(tmpFilename.c_str(), filename.c_str()) == 0;
+}
+
+//==============================================================================
+bool Roadmap::save() const
+{
+  if (mFilename.empty())
+    return false;
+  return save(mFilename);
+}
+
+//==============================================================================
+Eigen::VectorXd Roadmap::getDifference(
+    const Eigen::VectorXd& from, const Eigen::VectorXd& to) const
+{
+  Eigen::VectorXd difference = to - from;
+  for (std::size_t i = 0; i < mIsCyclic.size(); ++i)
+  {
+    if (mIsCyclic[i])
+      difference[i] = std::remainder(difference[i], 2 * M_PI);
+  }
+  return difference;
+}
+
+//==============================================================================
+double Roadmap::getDistance(
+    const Eigen::VectorXd& from, const Eigen::VectorXd& to) const
+{
+  return getDifference(from, to).norm();
+}
+
+//==============================================================================
+std::vector<std::size_t> Roadmap::getNearestNodes(
+    const Eigen::VectorXd& positions, std::size_t numNeighbors) const
+{
+  std::vector<std::pair<double, std::size_t>> distances(mNodes.size());
+  for (std::size_t i = 0; i < mNodes.size(); ++i)
+    distances[i] = std::make_pair(getDistance(positions, mNodes[i]), i);
+
+  numNeighbors = std::min(numNeighbors, distances.size());
+  std::partial_sort(
+      distances.begin(), distances.begin() + numNeighbors, distances.end());
+
+  std::vector<std::size_t> nearest(numNeighbors);
+  for (std::size_t i = 0; i < numNeighbors; ++i)
+    nearest[i] = distances[i].second;
+  return nearest;
+}
+
+//==============================================================================
+bool Roadmap::isMotionCollisionFree(
+    const std::shared_ptr<ada::Ada>& ada,
+    const Eigen::VectorXd& from,
+    const Eigen::VectorXd& to,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree) const
+{
+  if (!collisionFree)
+    return true;
+
+  auto space = ada->getArm()->getStateSpace();
+  auto state = space->createState();
+  Eigen::VectorXd difference = getDifference(from, to);
+  int numSteps = std::max(
+      1,
+      static_cast<int>(std::ceil(
+          difference.cwiseAbs().maxCoeff() / mCollisionCheckResolution)));
+  for (int i = 1; i <= numSteps; ++i)
+  {
+    space->convertPositionsToState(from + difference * i / numSteps, state);
+    if (!collisionFree->isSatisfied(state))
+      return false;
+  }
+  return true;
+}
+
+//==============================================================================
+std::vector<Eigen::VectorXd> Roadmap::sampleGoals(
+    const std::shared_ptr<ada::Ada>& ada,
+    const aikido::constraint::dart::TSR& tsr,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree) const
+{
+  // Same goal sampling as planning to a TSR from scratch.
+  auto arm = ada->getArm();
+  auto space = arm->getStateSpace();
+  auto metaSkeleton = arm->getMetaSkeleton();
+  auto ik = dart::dynamics::InverseKinematics::create(
+      ada->getHand()->getEndEffectorBodyNode());
+  ik->setDofs(metaSkeleton->getDofs());
+  auto rng = std::unique_ptr<aikido::common::RNG>(
+      new aikido::common::RNGWrapper<std::mt19937>(mGoalRandom()));
+  auto goalSampleable = std::make_shared<InverseKinematicsSampleable>(
+      space,
+      metaSkeleton,
+      std::make_shared<TSR>(tsr),
+      mGoalSeeds ? mGoalSeeds->createSeedSampleable(space, tsr, std::move(rng))
+                 : createSampleableBounds(space, std::move(rng)),
+      ik,
+      mMaxNumGoalTrials);
+  auto generator = goalSampleable->createSampleGenerator();
+
+  std::vector<Eigen::VectorXd> goals;
+  auto state = space->createState();
+  for (int i = 0; i < mMaxNumGoalTrials && goals.size() < mNumGoals
+                  && generator->canSample();
+       ++i)
+  {
+    if (!generator->sample(state))
+      continue;
+    if (collisionFree && !collisionFree->isSatisfied(state))
+      continue;
+
+    Eigen::VectorXd positions;
+    space->convertStateToPositions(state, positions);
+    goals.push_back(positions);
+  }
+  return goals;
+}
+
+//==============================================================================
+void Roadmap::updateAdjacency()
+{
+  mAdjacency.assign(mNodes.size(), {});
+  for (std::size_t i = 0; i < mEdges.size(); ++i)
+  {
+    mAdjacency[mEdges[i].first].emplace_back(mEdges[i].second, i);
+    mAdjacency[mEdges[i].second].emplace_back(mEdges[i].first, i);
+  }
+}
+
+} // namespace feeding
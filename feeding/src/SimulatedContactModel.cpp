@@ -0,0 +1,78 @@
+#include "feeding/SimulatedContactModel.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace feeding {
+
+//==============================================================================
+SimulatedContactModel::SimulatedContactModel(
+    const Eigen::Isometry3d& platePose, ros::NodeHandle nodeHandle)
+  : mIsPierced(false), mRandom(std::random_device{}()), mNoise(0, 1)
+{
+  double plateHeight;
+  std::vector<double> sensorToTip;
+  nodeHandle.param<double>("/simulatedContact/plateHeight", plateHeight, 0.01);
+  nodeHandle.param<double>("/simulatedContact/plateRadius", mPlateRadius, 0.1);
+  nodeHandle.param<double>(
+      "/simulatedContact/plateStiffness", mPlateStiffness, 5000);
+  nodeHandle.param<double>("/simulatedContact/foodHeight", mFoodHeight, 0.02);
+  nodeHandle.param<double>(
+      "/simulatedContact/foodStiffness", mFoodStiffness, 600);
+  nodeHandle.param<double>(
+      "/simulatedContact/piercingForce", mPiercingForce, 8);
+  nodeHandle.param<double>("/simulatedContact/foodFriction", mFoodFriction, 2);
+  nodeHandle.param<std::vector<double>>(
+      "/simulatedContact/sensorToTip",
+      sensorToTip,
+      std::vector<double>{0, 0, 0.1});
+  nodeHandle.param<double>("/simulatedContact/forceNoise", mForceNoise, 0.05);
+  nodeHandle.param<double>(
+      "/simulatedContact/torqueNoise", mTorqueNoise, 0.005);
+
+  mPlateCenter = platePose.translation() + Eigen::Vector3d(0, 0, plateHeight);
+  mSensorToTip = Eigen::Vector3d::Zero();
+  for (std::size_t i = 0; i < 3 && i < sensorToTip.size(); ++i)
+    mSensorToTip[i] = sensorToTip[i];
+}
+
+//==============================================================================
+FTSample SimulatedContactModel::getWrench(
+    const Eigen::Isometry3d& endEffectorPose)
+{
+  const Eigen::Vector3d tip = endEffectorPose.translation();
+  const double depth = mPlateCenter.z() + mFoodHeight - tip.z();
+
+  double contactForce = 0;
+  if (depth <= 0
+      || (tip - mPlateCenter).head<2>().norm() > mPlateRadius)
+  {
+    mIsPierced = false;
+  }
+  else
+  {
+    if (!mIsPierced)
+    {
+      contactForce = mFoodStiffness * std::min(depth, mFoodHeight);
+      mIsPierced = contactForce >= mPiercingForce;
+    }
+    if (mIsPierced)
+      contactForce = mFoodFriction;
+    if (depth > mFoodHeight)
+      contactForce += mPlateStiffness * (depth - mFoodHeight);
+  }
+
+  const Eigen::Vector3d force = endEffectorPose.linear().transpose()
+                                * Eigen::Vector3d(0, 0, contactForce);
+  FTSample sample;
+  for (int i = 0; i < 3; ++i)
+  {
+    sample.force[i] = mForceNoise * mNoise(mRandom);
+    sample.torque[i] = mTorqueNoise * mNoise(mRandom);
+  }
+  sample.force += force;
+  sample.torque += mSensorToTip.cross(force);
+  return sample;
+}
+
+} // namespace feeding
@@ -0,0 +1,169 @@
+#include "feeding/SimulatedMoveUntilTouchExecutor.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+
+using aikido::statespace::dart::MetaSkeletonStateSpace;
+
+namespace feeding {
+
+//==============================================================================
+SimulatedMoveUntilTouchExecutor::SimulatedMoveUntilTouchExecutor(
+    dart::dynamics::MetaSkeletonPtr metaSkeleton,
+    dart::dynamics::BodyNodePtr endEffector,
+    std::unique_ptr<SimulatedContactModel> contactModel,
+    ros::NodeHandle nodeHandle)
+  : mMetaSkeleton(std::move(metaSkeleton))
+  , mEndEffector(std::move(endEffector))
+  , mContactModel(std::move(contactModel))
+  , mForceThreshold(std::numeric_limits<double>::infinity())
+  , mTorqueThreshold(std::numeric_limits<double>::infinity())
+  , mStoppedOnContact(false)
+{
+  double stepPeriod;
+  nodeHandle.param<double>("/simulatedContact/timeScale", mTimeScale, 1.0);
+  nodeHandle.param<double>("/simulatedContact/stepPeriod", stepPeriod, 0.005);
+  if (mTimeScale <= 0)
+    throw std::invalid_argument("/simulatedContact/timeScale must be positive");
+
+  mThread.reset(new aikido::common::ExecutorThread(
+      [this] { step(std::chrono::system_clock::now()); },
+      std::chrono::microseconds(
+          static_cast<long>(std::max(stepPeriod, 1e-4) * 1e6))));
+}
+
+//==============================================================================
+SimulatedMoveUntilTouchExecutor::~SimulatedMoveUntilTouchExecutor()
+{
+  // Stop stepping before cancelling, so no step sees a half-destroyed object.
+  mThread.reset();
+  cancel();
+}
+
+//==============================================================================
+void SimulatedMoveUntilTouchExecutor::validate(
+    const aikido::trajectory::Trajectory* trajectory)
+{
+  if (!trajectory)
+    throw std::invalid_argument("Trajectory is null.");
+
+  auto space = dynamic_cast<const MetaSkeletonStateSpace*>(
+      trajectory->getStateSpace().get());
+  if (!space)
+    throw std::invalid_argument("Trajectory is not in a MetaSkeleton space.");
+  if (space->getDimension() != mMetaSkeleton->getNumDofs())
+    throw std::invalid_argument("Trajectory does not match the arm.");
+}
+
+//==============================================================================
+std::future<void> SimulatedMoveUntilTouchExecutor::execute(
+    const aikido::trajectory::ConstTrajectoryPtr& trajectory)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mTrajectory)
+    throw std::runtime_error("Another trajectory is in execution.");
+
+  // Reset before validating, so that a rejected trajectory does not report
+  // the contact of the previous one.
+  mStoppedOnContact = false;
+  validate(trajectory.get());
+
+  mTrajectory = trajectory;
+  mPromise.reset(new std::promise<void>());
+  mStartTime = std::chrono::system_clock::now();
+  return mPromise->get_future();
+}
+
+//==============================================================================
+void SimulatedMoveUntilTouchExecutor::step(
+    const std::chrono::system_clock::time_point& timepoint)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto skeleton = mMetaSkeleton->getBodyNode(0)->getSkeleton();
+
+  bool isFinished = false;
+  Eigen::Isometry3d endEffectorPose;
+  {
+    std::lock_guard<std::mutex> skeletonLock(skeleton->getMutex());
+    if (mTrajectory)
+    {
+      std::chrono::duration<double> elapsed = timepoint - mStartTime;
+      double t = mTrajectory->getStartTime() + mTimeScale * elapsed.count();
+      isFinished = t >= mTrajectory->getEndTime();
+
+      auto space = static_cast<const MetaSkeletonStateSpace*>(
+          mTrajectory->getStateSpace().get());
+      auto state = space->createState();
+      mTrajectory->evaluate(std::min(t, mTrajectory->getEndTime()), state);
+      space->setState(mMetaSkeleton.get(), state);
+    }
+    endEffectorPose = mEndEffector->getWorldTransform();
+  }
+
+  // The sensor streams whether or not the arm moves.
+  FTSample sample = mContactModel->getWrench(endEffectorPose);
+  sample.time = ros::Time::now().toSec();
+  if (mSampleCallback)
+    mSampleCallback(sample);
+
+  if (!mTrajectory)
+    return;
+
+  if (sample.force.norm() > mForceThreshold
+      || sample.torque.norm() > mTorqueThreshold)
+  {
+    ROS_INFO_STREAM(
+        "Simulated contact stopped the trajectory at force "
+        << sample.force.norm() << ", torque " << sample.torque.norm());
+    mStoppedOnContact = true;
+    mPromise->set_exception(std::make_exception_ptr(
+        std::runtime_error("Force/torque thresholds exceeded.")));
+    mTrajectory.reset();
+  }
+  else if (isFinished)
+  {
+    mPromise->set_value();
+    mTrajectory.reset();
+  }
+}
+
+//==============================================================================
+void SimulatedMoveUntilTouchExecutor::cancel()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mTrajectory)
+    return;
+
+  mPromise->set_exception(
+      std::make_exception_ptr(std::runtime_error("Trajectory canceled.")));
+  mTrajectory.reset();
+}
+
+//==============================================================================
+void SimulatedMoveUntilTouchExecutor::setThresholds(double force, double torque)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mForceThreshold = force;
+  mTorqueThreshold = torque;
+}
+
+//==============================================================================
+void SimulatedMoveUntilTouchExecutor::setSampleCallback(
+    std::function<void(const FTSample&)> callback)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mSampleCallback = std::move(callback);
+}
+
+//==============================================================================
+bool SimulatedMoveUntilTouchExecutor::hasStoppedOnContact() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStoppedOnContact;
+}
+
+} // namespace feeding
@@ -0,0 +1,116 @@
+#include "feeding/SkewerSuccessClassifier.hpp"
+
+#include <cmath>
+
+#include "feeding/util.hpp"
+
+namespace feeding {
+
+//==============================================================================
+SkewerSuccessClassifier::SkewerSuccessClassifier(
+    std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
+    ros::NodeHandle nodeHandle)
+  : mFTThresholdHelper(std::move(ftThresholdHelper)), mHasBaseline(false)
+{
+  nodeHandle.param<double>(
+      "/acquisitionDetection/defaultLoad", mDefaultLoadThreshold, 0.05);
+  nodeHandle.param<double>(
+      "/acquisitionDetection/loadScale", mLoadScale, 0.02);
+  nodeHandle.param<double>(
+      "/acquisitionDetection/confidenceThreshold", mConfidenceThreshold, 0.9);
+
+  std::vector<std::string> foodNames;
+  std::vector<double> foodLoads;
+  nodeHandle.getParam("/foodItems/names", foodNames);
+  nodeHandle.getParam("/foodItems/successLoads", foodLoads);
+  if (!foodLoads.empty() && foodLoads.size() != foodNames.size())
+  {
+    ROS_WARN_STREAM(
+        "/foodItems/successLoads has " << foodLoads.size()
+                                       << " entries, expected "
+                                       << foodNames.size()
+                                       << ". Using default load.");
+    foodLoads.clear();
+  }
+  for (std::size_t i = 0; i < foodLoads.size(); ++i)
+    mFoodLoadThresholds[foodNames[i]] = foodLoads[i];
+}
+
+//==============================================================================
+bool SkewerSuccessClassifier::recordBaseline()
+{
+  if (!mFTThresholdHelper)
+    return false;
+
+  mBaseline = mFTThresholdHelper->getWindowStatistics();
+  mHasBaseline = mBaseline.numSamples > 0;
+  return mHasBaseline;
+}
+
+//==============================================================================
+SkewerClassification SkewerSuccessClassifier::classify(
+    const std::string& foodName) const
+{
+  SkewerClassification result;
+  if (!mFTThresholdHelper || !mHasBaseline)
+    return result;
+
+  auto current = mFTThresholdHelper->getWindowStatistics();
+  if (current.numSamples == 0
+      || current.totalSamples <= mBaseline.totalSamples)
+  {
+    ROS_WARN_STREAM("No new F/T data since the baseline.");
+    return result;
+  }
+
+  result.load = (current.forceMean - mBaseline.forceMean).norm();
+
+  // Standard deviation of the difference of the two window means.
+  double noise = std::sqrt(
+      current.forceVariance.sum() / current.numSamples
+      + mBaseline.forceVariance.sum() / mBaseline.numSamples);
+  double scale = std::sqrt(mLoadScale * mLoadScale + noise * noise);
+
+  double probability = 1.0
+                       / (1.0 + std::exp(
+                                    -(result.load - getLoadThreshold(foodName))
+                                    / scale));
+
+  result.success = probability >= 0.5;
+  result.confidence = result.success ? probability : 1.0 - probability;
+  result.isConfident = result.confidence >= mConfidenceThreshold;
+
+  ROS_INFO_STREAM(
+      "Skewer classification for " << foodName << ": load " << result.load
+                                   << "N, success " << result.success
+                                   << ", confidence " << result.confidence);
+  return result;
+}
+
+//==============================================================================
+double SkewerSuccessClassifier::getLoadThreshold(
+    const std::string& foodName) const
+{
+  auto it = mFoodLoadThresholds.find(foodName);
+  if (it == mFoodLoadThresholds.end())
+    return mDefaultLoadThreshold;
+  return it->second;
+}
+
+//==============================================================================
+bool isSkewerSuccessful(
+    const std::shared_ptr<SkewerSuccessClassifier>& classifier,
+    const std::string& foodName,
+    const std::vector<std::string>& optionPrompts)
+{
+  if (classifier)
+  {
+    auto result = classifier->classify(foodName);
+    if (result.isConfident)
+      return result.success;
+  }
+
+  return getUserInputWithOptions(optionPrompts, "Did I succeed?") == 1;
+}
+
+} // namespace feeding
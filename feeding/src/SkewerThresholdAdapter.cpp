@@ -0,0 +1,243 @@
+#include "feeding/SkewerThresholdAdapter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include <yaml-cpp/yaml.h>
+
+namespace feeding {
+
+namespace {
+
+// A stop counts as caused by the force threshold above this fraction of it.
+static const double STOPPED_BY_THRESHOLD_RATIO = 0.9;
+
+// Below this ratio of steady to peak force, the peak is a spike from
+// hitting the plate rather than the food's resistance.
+static const double PLATE_SPIKE_RATIO = 0.6;
+
+// Fraction of the peak above which a sample counts as being in contact.
+static const double CONTACT_RATIO = 0.2;
+
+} // namespace
+
+//==============================================================================
+SkewerContact SkewerContact::fromSamples(const std::vector<FTSample>& samples)
+{
+  SkewerContact contact;
+  contact.numSamples = samples.size();
+  if (samples.empty())
+    return contact;
+
+  const std::size_t numBaselineSamples
+      = std::max<std::size_t>(1, std::min<std::size_t>(10, samples.size() / 4));
+  Eigen::Vector3d baselineForce = Eigen::Vector3d::Zero();
+  Eigen::Vector3d baselineTorque = Eigen::Vector3d::Zero();
+  for (std::size_t i = 0; i < numBaselineSamples; ++i)
+  {
+    baselineForce += samples[i].force;
+    baselineTorque += samples[i].torque;
+  }
+  baselineForce /= numBaselineSamples;
+  baselineTorque /= numBaselineSamples;
+
+  std::vector<double> forces(samples.size());
+  for (std::size_t i = 0; i < samples.size(); ++i)
+  {
+    forces[i] = (samples[i].force - baselineForce).norm();
+    contact.peakForce = std::max(contact.peakForce, forces[i]);
+    contact.peakTorque = std::max(
+        contact.peakTorque, (samples[i].torque - baselineTorque).norm());
+  }
+
+  // The median of the in-contact samples is robust to a short plate spike.
+  std::vector<double> inContact;
+  for (double force : forces)
+  {
+    if (force >= CONTACT_RATIO * contact.peakForce)
+      inContact.push_back(force);
+  }
+  auto median = inContact.begin() + inContact.size() / 2;
+  std::nth_element(inContact.begin(), median, inContact.end());
+  contact.steadyForce = *median;
+  return contact;
+}
+
+//==============================================================================
+SkewerThresholdAdapter::SkewerThresholdAdapter(
+    const std::unordered_map<std::string, double>& initialForces,
+    double initialTorque,
+    ros::NodeHandle nodeHandle)
+  : mDefaultTorque(initialTorque)
+{
+  nodeHandle.param<std::string>("/skewerThresholds/file", mFilename, "");
+  nodeHandle.param<double>(
+      "/skewerThresholds/learningRate", mLearningRate, 0.3);
+  nodeHandle.param<double>("/skewerThresholds/margin", mMargin, 0.15);
+  nodeHandle.param<double>("/skewerThresholds/minForce", mMinForce, 3.0);
+  nodeHandle.param<double>("/skewerThresholds/maxForce", mMaxForce, 40.0);
+  nodeHandle.param<double>("/skewerThresholds/minTorque", mMinTorque, 0.5);
+  nodeHandle.param<double>("/skewerThresholds/maxTorque", mMaxTorque, 4.0);
+
+  mDefaultForce = mMaxForce;
+  for (const auto& entry : initialForces)
+  {
+    mThresholds[entry.first]
+        = FoodThresholds{entry.second, initialTorque, 0, 0};
+    mDefaultForce = std::min(mDefaultForce, entry.second);
+  }
+
+  if (!mFilename.empty())
+    load(mFilename);
+}
+
+//==============================================================================
+std::pair<double, double> SkewerThresholdAdapter::getThresholds(
+    const std::string& foodName) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mThresholds.find(foodName);
+  if (it == mThresholds.end())
+    return std::make_pair(mDefaultForce, mDefaultTorque);
+  return std::make_pair(it->second.force, it->second.torque);
+}
+
+//==============================================================================
+void SkewerThresholdAdapter::update(
+    const std::string& foodName, const SkewerContact& contact, bool success)
+{
+  if (contact.numSamples == 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto& thresholds = getFoodThresholds(foodName);
+  const double oldForce = thresholds.force;
+
+  if (success)
+  {
+    ++thresholds.numSuccesses;
+    thresholds.force
+        += mLearningRate
+           * (contact.peakForce * (1 + mMargin) - thresholds.force);
+    thresholds.torque
+        += mLearningRate
+           * (contact.peakTorque * (1 + mMargin) - thresholds.torque);
+  }
+  else
+  {
+    ++thresholds.numFailures;
+    bool stoppedByThreshold
+        = contact.peakForce >= STOPPED_BY_THRESHOLD_RATIO * thresholds.force;
+    if (stoppedByThreshold
+        && contact.steadyForce >= PLATE_SPIKE_RATIO * contact.peakForce)
+    {
+      // Still pushing into the food when we stopped.
+      thresholds.force *= 1 + mLearningRate;
+    }
+    else if (stoppedByThreshold)
+    {
+      // Went through the food into the plate.
+      thresholds.force
+          += mLearningRate
+             * (contact.steadyForce * (1 + mMargin) - thresholds.force);
+    }
+  }
+
+  thresholds.force = std::min(std::max(thresholds.force, mMinForce), mMaxForce);
+  thresholds.torque
+      = std::min(std::max(thresholds.torque, mMinTorque), mMaxTorque);
+
+  ROS_INFO_STREAM(
+      "Skewer threshold for " << foodName << ": " << oldForce << "N -> "
+                              << thresholds.force << "N (peak "
+                              << contact.peakForce << "N, steady "
+                              << contact.steadyForce << "N, "
+                              << (success ? "success" : "fail") << ")");
+}
+
+//==============================================================================
+bool SkewerThresholdAdapter::load(const std::string& filename)
+{
+  YAML::Node root;
+  try
+  {
+    root = YAML::LoadFile(filename);
+  }
+  catch (const YAML::Exception& e)
+  {
+    ROS_INFO_STREAM("No skewer thresholds loaded from " << filename);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (const auto& entry : root)
+  {
+    auto& thresholds = getFoodThresholds(entry.first.as<std::string>());
+    thresholds.force = entry.second["force"].as<double>(thresholds.force);
+    thresholds.torque = entry.second["torque"].as<double>(thresholds.torque);
+    thresholds.numSuccesses
+        = entry.second["successes"].as<std::size_t>(thresholds.numSuccesses);
+    thresholds.numFailures
+        = entry.second["failures"].as<std::size_t>(thresholds.numFailures);
+  }
+  ROS_INFO_STREAM("Loaded skewer thresholds from " << filename);
+  return true;
+}
+
+//==============================================================================
+bool SkewerThresholdAdapter::save(const std::string& filename) const
+{
+  YAML::Node root;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& entry : mThresholds)
+    {
+      YAML::Node node;
+      node["force"] = entry.second.force;
+      node["torque"] = entry.second.torque;
+      node["successes"] = entry.second.numSuccesses;
+      node["failures"] = entry.second.numFailures;
+      root[entry.first] = node;
+    }
+  }
+
+  // Write to a temporary file first so a crash never leaves a broken file.
+  const std::string tmpFilename = filename + ".tmp";
+  {
+    std::ofstream outFile(tmpFilename);
+    outFile << root;
+    if (!outFile)
+    {
+      ROS_WARN_STREAM("Failed to write skewer thresholds to " << filename);
+      return false;
+    }
+  }
+  return std::rename(tmpFilename.c_str(), filename.c_str()) == 0;
+}
+
+//==============================================================================
+bool SkewerThresholdAdapter::save() const
+{
+  if (mFilename.empty())
+    return false;
+  return save(mFilename);
+}
+
+//==============================================================================
+SkewerThresholdAdapter::FoodThresholds&
+SkewerThresholdAdapter::getFoodThresholds(const std::string& foodName)
+{
+  auto it = mThresholds.find(foodName);
+  if (it == mThresholds.end())
+  {
+    it = mThresholds
+             .emplace(
+                 foodName,
+                 FoodThresholds{mDefaultForce, mDefaultTorque, 0, 0})
+             .first;
+  }
+  return it->second;
+}
+
+} // namespace feeding
@@ -0,0 +1,173 @@
+#include "feeding/Speech.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+#include "std_msgs/String.h"
+
+namespace feeding {
+
+//==============================================================================
+void SwiftSpeechBackend::speak(const std::string& statement)
+{
+  // The statement is spoken by a shell; only plain text gets through.
+  std::string quoted;
+  for (char c : statement)
+  {
+    if (c == '"' || c == '\\' || c == '$' || c == '`')
+      quoted += '\\';
+    quoted += c;
+  }
+  std::string cmd = "aoss swift \"" + quoted + "\"";
+  if (std::system(cmd.c_str()) != 0)
+    ROS_WARN_STREAM("Failed to say \"" << statement << "\"");
+}
+
+//==============================================================================
+void NullSpeechBackend::speak(const std::string& statement)
+{
+  ROS_INFO_STREAM("Saying \"" << statement << "\"");
+}
+
+//==============================================================================
+SpeechQueue::SpeechQueue(
+    std::unique_ptr<SpeechBackend> backend, ros::NodeHandle nodeHandle)
+  : mBackend(std::move(backend))
+{
+  double maxAge;
+  int maxQueueSize;
+  nodeHandle.param<double>("/speech/maxAge", maxAge, 2.0);
+  nodeHandle.param<int>("/speech/maxQueueSize", maxQueueSize, 10);
+  mMaxAge = std::chrono::duration<double>(maxAge);
+  mMaxQueueSize = std::max(maxQueueSize, 1);
+
+  // Latched so that the web page gets the last statement when it connects,
+  // instead of waiting for it before publishing.
+  mTalkPub = nodeHandle.advertise<std_msgs::String>("/talk_pub", 100, true);
+  mWorker = std::thread(&SpeechQueue::run, this);
+}
+
+//==============================================================================
+SpeechQueue::~SpeechQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRunning = false;
+    while (!mQueue.empty())
+      drop(mQueue.begin());
+  }
+  mCondition.notify_all();
+  mWorker.join();
+}
+
+//==============================================================================
+std::shared_future<bool> SpeechQueue::say(
+    const std::string& statement, Priority priority)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = std::find_if(
+      mQueue.begin(), mQueue.end(), [&](const Queue::value_type& entry) {
+        return entry.second.statement == statement;
+      });
+  if (it != mQueue.end())
+  {
+    // Merged with the queued statement, which is not stale anymore.
+    it->second.queueTime = std::chrono::steady_clock::now();
+    if (it->second.priority >= priority)
+      return it->second.future;
+
+    // Queued again with the higher priority.
+    Utterance utterance = std::move(it->second);
+    mQueue.erase(it);
+    utterance.priority = priority;
+    auto future = utterance.future;
+    mQueue.emplace(
+        Key(-static_cast<int>(priority), mNextSequence++),
+        std::move(utterance));
+    return future;
+  }
+
+  if (priority == Priority::LOW)
+  {
+    auto low = std::find_if(
+        mQueue.begin(), mQueue.end(), [](const Queue::value_type& entry) {
+          return entry.second.priority == Priority::LOW;
+        });
+    if (low != mQueue.end())
+      drop(low);
+  }
+
+  Utterance utterance;
+  utterance.statement = statement;
+  utterance.priority = priority;
+  utterance.queueTime = std::chrono::steady_clock::now();
+  utterance.promise = std::make_shared<std::promise<bool>>();
+  utterance.future = utterance.promise->get_future().share();
+  auto future = utterance.future;
+  mQueue.emplace(
+      Key(-static_cast<int>(priority), mNextSequence++), std::move(utterance));
+
+  // The last entry has the lowest priority and the newest of those is
+  // kept.
+  while (mQueue.size() > mMaxQueueSize)
+  {
+    auto oldest = std::prev(mQueue.end());
+    while (oldest != mQueue.begin()
+           && std::prev(oldest)->first.first == oldest->first.first)
+      --oldest;
+    drop(oldest);
+  }
+
+  mCondition.notify_one();
+  return future;
+}
+
+//==============================================================================
+void SpeechQueue::clear()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  while (!mQueue.empty())
+    drop(mQueue.begin());
+}
+
+//==============================================================================
+void SpeechQueue::run()
+{
+  while (true)
+  {
+    Utterance utterance;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this] { return !mRunning || !mQueue.empty(); });
+      if (!mRunning)
+        return;
+
+      auto it = mQueue.begin();
+      if (it->second.priority == Priority::LOW
+          && std::chrono::steady_clock::now() - it->second.queueTime > mMaxAge)
+      {
+        drop(it);
+        continue;
+      }
+      utterance = std::move(it->second);
+      mQueue.erase(it);
+    }
+
+    std_msgs::String msg;
+    msg.data = utterance.statement;
+    mTalkPub.publish(msg);
+    mBackend->speak(utterance.statement);
+    utterance.promise->set_value(true);
+  }
+}
+
+//==============================================================================
+void SpeechQueue::drop(Queue::iterator it)
+{
+  ROS_INFO_STREAM("Dropped statement \"" << it->second.statement << "\"");
+  it->second.promise->set_value(false);
+  mQueue.erase(it);
+}
+
+} // namespace feeding
@@ -0,0 +1,92 @@
+#include "feeding/SynchronizedCapture.hpp"
+
+#include <cmath>
+
+namespace feeding {
+
+//==============================================================================
+SynchronizedCapture::SynchronizedCapture(double maxStampDifference)
+  : mMaxStampDifference(maxStampDifference)
+{
+  // Do nothing
+}
+
+//==============================================================================
+std::future<CapturedFrames> SynchronizedCapture::request(
+    Handler handler, ReadyPredicate isReady)
+{
+  Request request;
+  request.time = ros::Time::now();
+  request.handler = std::move(handler);
+  request.isReady = std::move(isReady);
+  auto future = request.promise.get_future();
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  mRequests.push_back(std::move(request));
+  return future;
+}
+
+//==============================================================================
+bool SynchronizedCapture::isPending() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return !mRequests.empty();
+}
+
+//==============================================================================
+void SynchronizedCapture::cancel()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mRequests.clear();
+}
+
+//==============================================================================
+void SynchronizedCapture::addColor(cv_bridge::CvImageConstPtr image)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  add(std::move(image), mLatestColor, mLatestDepth);
+}
+
+//==============================================================================
+void SynchronizedCapture::addDepth(cv_bridge::CvImageConstPtr image)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  add(std::move(image), mLatestDepth, mLatestColor);
+}
+
+//==============================================================================
+void SynchronizedCapture::add(
+    cv_bridge::CvImageConstPtr image,
+    cv_bridge::CvImageConstPtr& latest,
+    const cv_bridge::CvImageConstPtr& other)
+{
+  if (mRequests.empty())
+    return;
+
+  auto& request = mRequests.front();
+  const ros::Time& stamp = image->header.stamp;
+  if (stamp <= request.time || (request.isReady && !request.isReady(stamp)))
+    return;
+
+  latest = std::move(image);
+  if (!other || other->header.stamp <= request.time)
+    return;
+
+  double difference = (latest->header.stamp - other->header.stamp).toSec();
+  if (std::abs(difference) > mMaxStampDifference)
+    return;
+
+  CapturedFrames frames;
+  frames.color = mLatestColor;
+  frames.depth = mLatestDepth;
+  if (!request.handler(frames))
+    return;
+
+  // Later requests need frames newer than this pair.
+  mLatestColor.reset();
+  mLatestDepth.reset();
+  request.promise.set_value(frames);
+  mRequests.pop_front();
+}
+
+} // namespace feeding
@@ -0,0 +1,93 @@
+#include "feeding/TopicInput.hpp"
+
+namespace feeding {
+
+//==============================================================================
+TopicInput::TopicInput(
+    ros::NodeHandle nodeHandle,
+    const std::string& topic,
+    std::size_t maxQueueSize)
+  : mMaxQueueSize(maxQueueSize)
+{
+  mSubscriber = nodeHandle.subscribe(
+      topic, maxQueueSize, &TopicInput::callback, this);
+}
+
+//==============================================================================
+TopicInput::~TopicInput()
+{
+  mSubscriber.shutdown();
+  cancel();
+}
+
+//==============================================================================
+std::future<std::string> TopicInput::receive(
+    const ros::Time& newerThan, std::size_t* id)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  while (!mQueue.empty() && mQueue.front().stamp <= newerThan)
+    mQueue.pop_front();
+
+  Request request;
+  request.id = mNextRequestId++;
+  request.newerThan = newerThan;
+  if (id)
+    *id = request.id;
+  auto future = request.promise.get_future();
+  if (!mQueue.empty())
+  {
+    request.promise.set_value(mQueue.front().data);
+    mQueue.pop_front();
+  }
+  else
+  {
+    mRequests.push_back(std::move(request));
+  }
+  return future;
+}
+
+//==============================================================================
+void TopicInput::cancel(std::size_t id)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (auto it = mRequests.begin(); it != mRequests.end(); ++it)
+  {
+    if (it->id == id)
+    {
+      it->promise.set_value("");
+      mRequests.erase(it);
+      return;
+    }
+  }
+}
+
+//==============================================================================
+void TopicInput::cancel()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (auto& request : mRequests)
+    request.promise.set_value("");
+  mRequests.clear();
+}
+
+//==============================================================================
+void TopicInput::callback(const std_msgs::String::ConstPtr& msg)
+{
+  ros::Time stamp = ros::Time::now();
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mRequests.empty() && stamp > mRequests.front().newerThan)
+  {
+    mRequests.front().promise.set_value(msg->data);
+    mRequests.pop_front();
+    return;
+  }
+
+  if (mQueue.size() >= mMaxQueueSize)
+  {
+    ROS_WARN_STREAM("Input queue is full, dropped " << mQueue.front().data);
+    mQueue.pop_front();
+  }
+  mQueue.push_back(Message{msg->data, stamp});
+}
+
+} // namespace feeding
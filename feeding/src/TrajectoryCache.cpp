@@ -0,0 +1,404 @@
+#include "feeding/TrajectoryCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <aikido/statespace/GeodesicInterpolator.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSaver.hpp>
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+#include <aikido/trajectory/Interpolated.hpp>
+#include <yaml-cpp/yaml.h>
+
+using aikido::statespace::GeodesicInterpolator;
+using aikido::statespace::dart::MetaSkeletonStateSaver;
+using aikido::statespace::dart::MetaSkeletonStateSpace;
+using aikido::trajectory::Interpolated;
+
+namespace feeding {
+
+//==============================================================================
+double TrajectoryCache::Statistics::getHitRate() const
+{
+  std::size_t numCalls = numHits + numMisses + numRejected;
+  return numCalls == 0 ? 0 : static_cast<double>(numHits) / numCalls;
+}
+
+//==============================================================================
+TrajectoryCache::TrajectoryCache(
+    aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr space,
+    ros::NodeHandle nodeHandle)
+  : mSpace(std::move(space)), mIsModified(false)
+{
+  double saveInterval;
+  nodeHandle.param<std::string>("/trajectoryCache/file", mFilename, "");
+  nodeHandle.param<double>("/trajectoryCache/resolution", mResolution, 0.05);
+  nodeHandle.param<double>(
+      "/trajectoryCache/collisionCheckResolution",
+      mCollisionCheckResolution,
+      0.02);
+  nodeHandle.param<double>(
+      "/trajectoryCache/saveInterval", saveInterval, 10.0);
+
+  if (!mFilename.empty())
+  {
+    load(mFilename);
+    mSaveThread.reset(new aikido::common::ExecutorThread(
+        [this] { saveIfModified(); },
+        std::chrono::milliseconds(
+            static_cast<long>(std::max(saveInterval, 0.1) * 1e3))));
+  }
+}
+
+//==============================================================================
+TrajectoryCache::~TrajectoryCache()
+{
+  mSaveThread.reset();
+  saveIfModified();
+}
+
+//==============================================================================
+bool TrajectoryCache::moveArm(
+    const std::shared_ptr<ada::Ada>& ada,
+    const std::string& goal,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+    const Planner& plan,
+    const std::vector<double>& velocityLimits)
+{
+  auto trajectory = findPath(ada, goal, collisionFree);
+  if (!trajectory)
+  {
+    trajectory = plan();
+    auto interpolated = dynamic_cast<const Interpolated*>(trajectory.get());
+    if (interpolated)
+    {
+      auto space = ada->getArm()->getStateSpace();
+      Path path(interpolated->getNumWaypoints());
+      for (std::size_t i = 0; i < path.size(); ++i)
+      {
+        space->convertStateToPositions(
+            static_cast<const MetaSkeletonStateSpace::State*>(
+                interpolated->getWaypoint(i)),
+            path[i]);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto key = getKey(goal, path.front());
+        mGoals[key] = goal;
+        mPaths[key] = std::move(path);
+        mIsModified = true;
+      }
+    }
+  }
+
+  auto statistics = getStatistics(goal);
+  ROS_INFO_STREAM(
+      "Trajectory cache hit rate for " << goal << ": "
+                                       << statistics.getHitRate() << " ("
+                                       << statistics.numHits << " hits, "
+                                       << statistics.numMisses << " misses, "
+                                       << statistics.numRejected
+                                       << " rejected)");
+
+  if (!trajectory)
+    return false;
+
+  return ada->moveArmOnTrajectory(
+      trajectory,
+      collisionFree,
+      ::ada::TrajectoryPostprocessType::KUNZ,
+      velocityLimits);
+}
+
+//==============================================================================
+bool TrajectoryCache::moveArmToConfiguration(
+    const std::shared_ptr<ada::Ada>& ada,
+    const std::string& name,
+    const Eigen::VectorXd& configuration,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree,
+    double timelimit,
+    const std::vector<double>& velocityLimits)
+{
+  auto arm = ada->getArm();
+  return moveArm(
+      ada,
+      getGoalName(
+          name,
+          std::vector<double>(
+              configuration.data(),
+              configuration.data() + configuration.size())),
+      collisionFree,
+      [&] {
+        return ada->planToConfiguration(
+            arm->getStateSpace(),
+            arm->getMetaSkeleton(),
+            configuration,
+            collisionFree,
+            timelimit);
+      },
+      velocityLimits);
+}
+
+//==============================================================================
+TrajectoryCache::Statistics TrajectoryCache::getStatistics() const
+{
+  Statistics total;
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (const auto& entry : mStatistics)
+  {
+    total.numHits += entry.second.numHits;
+    total.numMisses += entry.second.numMisses;
+    total.numRejected += entry.second.numRejected;
+  }
+  return total;
+}
+
+//==============================================================================
+TrajectoryCache::Statistics TrajectoryCache::getStatistics(
+    const std::string& goal) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mStatistics.find(goal);
+  return it == mStatistics.end() ? Statistics() : it->second;
+}
+
+//==============================================================================
+bool TrajectoryCache::load(const std::string& filename)
+{
+  YAML::Node root;
+  try
+  {
+    root = YAML::LoadFile(filename);
+  }
+  catch (const YAML::Exception& e)
+  {
+    ROS_INFO_STREAM("No cached trajectories loaded from " << filename);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (const auto& entry : root)
+  {
+    auto goal = entry.first.as<std::string>();
+    for (const auto& pathNode : entry.second)
+    {
+      Path path;
+      for (const auto& waypoint : pathNode)
+      {
+        auto positions = waypoint.as<std::vector<double>>();
+        path.emplace_back(
+            Eigen::Map<Eigen::VectorXd>(positions.data(), positions.size()));
+      }
+      if (path.empty())
+        continue;
+
+      auto key = getKey(goal, path.front());
+      mGoals[key] = goal;
+      mPaths[key] = std::move(path);
+    }
+  }
+  ROS_INFO_STREAM(
+      "Loaded " << mPaths.size() << " cached trajectories from " << filename);
+  return true;
+}
+
+//==============================================================================
+bool TrajectoryCache::save(const std::string& filename) const
+{
+  YAML::Node root;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& entry : mPaths)
+    {
+      YAML::Node pathNode;
+      for (const auto& waypoint : entry.second)
+      {
+        YAML::Node waypointNode;
+        for (int i = 0; i < waypoint.size(); ++i)
+          waypointNode.push_back(waypoint[i]);
+        waypointNode.SetStyle(YAML::EmitterStyle::Flow);
+        pathNode.push_back(waypointNode);
+      }
+      root[mGoals.at(entry.first)].push_back(pathNode);
+    }
+  }
+
+  // Write to a temporary file first so a crash never leaves a broken file.
+  const std::string tmpFilename = filename + ".tmp";
+  {
+    std::ofstream outFile(tmpFilename);
+    outFile << root;
+    if (!outFile)
+    {
+      ROS_WARN_STREAM("Failed to write cached trajectories to " << filename);
+      return false;
+    }
+  }
+  return std::rename(tmpFilename.c_str(), filename.c_str()) == 0;
+}
+
+//==============================================================================
+bool TrajectoryCache::save() const
+{
+  if (mFilename.empty())
+    return false;
+  return save(mFilename);
+}
+
+//==============================================================================
+void TrajectoryCache::saveIfModified()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mIsModified)
+      return;
+    mIsModified = false;
+  }
+  if (!save())
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mIsModified = true;
+  }
+}
+
+//==============================================================================
+std::string TrajectoryCache::getGoalName(
+    const std::string& name, const std::vector<double>& values)
+{
+  std::ostringstream goal;
+  goal << name << std::fixed << std::setprecision(4);
+  for (std::size_t i = 0; i < values.size(); ++i)
+    goal << (i == 0 ? " " : ",") << values[i];
+  return goal.str();
+}
+
+//==============================================================================
+std::string TrajectoryCache::getKey(
+    const std::string& goal, const Eigen::VectorXd& start) const
+{
+  // Converting to a state and back wraps the continuous joints.
+  Eigen::VectorXd positions = start;
+  if (start.size() == static_cast<int>(mSpace->getDimension()))
+  {
+    auto state = mSpace->createState();
+    mSpace->convertPositionsToState(start, state);
+    mSpace->convertStateToPositions(state, positions);
+  }
+
+  std::ostringstream key;
+  key << goal << " from";
+  for (int i = 0; i < positions.size(); ++i)
+    key << " " << std::lround(positions[i] / mResolution);
+  return key.str();
+}
+
+//==============================================================================
+aikido::trajectory::TrajectoryPtr TrajectoryCache::findPath(
+    const std::shared_ptr<ada::Ada>& ada,
+    const std::string& goal,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree)
+{
+  Eigen::VectorXd start = ada->getArm()->getMetaSkeleton()->getPositions();
+  const std::string key = getKey(goal, start);
+
+  Path path;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mPaths.find(key);
+    if (it == mPaths.end())
+    {
+      ++mStatistics[goal].numMisses;
+      return nullptr;
+    }
+    path = it->second;
+  }
+
+  // The cached path starts within the resolution of the current
+  // configuration.
+  path.front() = start;
+  auto trajectory = createTrajectory(path);
+  if (!isCollisionFree(ada, *trajectory, collisionFree))
+  {
+    ROS_INFO_STREAM("Cached trajectory to " << goal << " is in collision");
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPaths.erase(key);
+    mGoals.erase(key);
+    ++mStatistics[goal].numRejected;
+    mIsModified = true;
+    return nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mStatistics[goal].numHits;
+  }
+  return trajectory;
+}
+
+//==============================================================================
+std::shared_ptr<Interpolated> TrajectoryCache::createTrajectory(
+    const Path& path) const
+{
+  auto trajectory = std::make_shared<Interpolated>(
+      mSpace, std::make_shared<GeodesicInterpolator>(mSpace));
+  auto state = mSpace->createState();
+  for (std::size_t i = 0; i < path.size(); ++i)
+  {
+    mSpace->convertPositionsToState(path[i], state);
+    trajectory->addWaypoint(i, state);
+  }
+  return trajectory;
+}
+
+//==============================================================================
+bool TrajectoryCache::isCollisionFree(
+    const std::shared_ptr<ada::Ada>& ada,
+    const Interpolated& trajectory,
+    const aikido::constraint::dart::CollisionFreePtr& collisionFree) const
+{
+  if (!collisionFree)
+    return true;
+
+  auto metaSkeleton = ada->getArm()->getMetaSkeleton();
+
+  // Checking sets the positions of the arm, which joint state updates
+  // write as well.
+  auto skeleton = metaSkeleton->getBodyNode(0)->getSkeleton();
+  std::lock_guard<std::mutex> lock(skeleton->getMutex());
+  MetaSkeletonStateSaver saver(metaSkeleton);
+
+  // Checks the trajectory the arm executes, whose geodesic interpolation
+  // takes continuous joints the short way around.
+  auto state = mSpace->createState();
+  auto inverse = mSpace->createState();
+  auto difference = mSpace->createState();
+  Eigen::VectorXd tangent;
+  trajectory.evaluate(trajectory.getStartTime(), state);
+  if (!collisionFree->isSatisfied(state))
+    return false;
+
+  for (std::size_t i = 1; i < trajectory.getNumWaypoints(); ++i)
+  {
+    mSpace->getInverse(trajectory.getWaypoint(i - 1), inverse);
+    mSpace->compose(inverse, trajectory.getWaypoint(i), difference);
+    mSpace->logMap(difference, tangent);
+    int numSteps = std::max(
+        1,
+        static_cast<int>(std::ceil(
+            tangent.cwiseAbs().maxCoeff() / mCollisionCheckResolution)));
+    for (int j = 1; j <= numSteps; ++j)
+    {
+      trajectory.evaluate(i - 1 + static_cast<double>(j) / numSteps, state);
+      if (!collisionFree->isSatisfied(state))
+        return false;
+    }
+  }
+  return true;
+}
+
+} // namespace feeding
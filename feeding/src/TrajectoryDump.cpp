@@ -0,0 +1,379 @@
+#include "feeding/TrajectoryDump.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <ros/ros.h>
+#include <unistd.h>
+
+namespace feeding {
+
+namespace {
+
+//==============================================================================
+std::size_t getPaddedSize(std::size_t size)
+{
+  return (size + 7) & ~std::size_t(7);
+}
+
+//==============================================================================
+std::size_t getRecordSize(const trajectorydump::RecordHeader& header)
+{
+  return sizeof(header) + getPaddedSize(header.labelSize)
+         + sizeof(double) * header.numSamples * (1 + 2 * header.dimension);
+}
+
+//==============================================================================
+/// Cuts \c file after its last complete record, so that records appended
+/// after a crash are not lost behind a cut off one, and positions it there.
+/// Writes the file header to a file that is empty or shorter than it.
+/// \param[in] file Dump opened for reading and writing.
+/// \return False if \c file is not a trajectory dump or cannot be cut.
+bool truncateToLastRecord(std::FILE* file)
+{
+  if (std::fseek(file, 0, SEEK_END) != 0)
+    return false;
+  const long size = std::ftell(file);
+
+  trajectorydump::FileHeader header;
+  if (size < static_cast<long>(sizeof(header)))
+  {
+    std::memcpy(header.magic, trajectorydump::MAGIC, sizeof(header.magic));
+    header.version = trajectorydump::VERSION;
+    header.reserved = 0;
+    return ::ftruncate(::fileno(file), 0) == 0
+           && std::fseek(file, 0, SEEK_SET) == 0
+           && std::fwrite(&header, sizeof(header), 1, file) == 1;
+  }
+
+  std::rewind(file);
+  if (std::fread(&header, sizeof(header), 1, file) != 1
+      || std::memcmp(header.magic, trajectorydump::MAGIC, sizeof(header.magic))
+             != 0
+      || header.version != trajectorydump::VERSION)
+    return false;
+
+  long offset = sizeof(header);
+  trajectorydump::RecordHeader record;
+  while (offset + static_cast<long>(sizeof(record)) <= size
+         && std::fseek(file, offset, SEEK_SET) == 0
+         && std::fread(&record, sizeof(record), 1, file) == 1)
+  {
+    // Compared by division so that a garbled header cannot overflow.
+    std::size_t remaining = size - offset - sizeof(record);
+    std::size_t labelSize = getPaddedSize(record.labelSize);
+    std::size_t sampleSize
+        = sizeof(double) * (1 + 2 * std::size_t(record.dimension));
+    if (labelSize > remaining
+        || record.numSamples > (remaining - labelSize) / sampleSize)
+      break;
+    offset += getRecordSize(record);
+  }
+
+  if (offset < size)
+  {
+    ROS_WARN_STREAM(
+        "Cutting off " << size - offset << " bytes of an incomplete record.");
+    if (::ftruncate(::fileno(file), offset) != 0)
+      return false;
+  }
+  return std::fseek(file, offset, SEEK_SET) == 0;
+}
+
+} // namespace
+
+//==============================================================================
+TrajectoryDumpWriter::TrajectoryDumpWriter(
+    const std::string& filename, double timeStep, std::size_t bufferSize)
+  : mTimeStep(timeStep)
+  , mBufferSize(bufferSize)
+  , mFile(nullptr)
+  , mDimension(0)
+  , mState(nullptr)
+{
+  // Sessions append to the existing file.
+  mFile = std::fopen(filename.c_str(), "r+b");
+  if (!mFile)
+    mFile = std::fopen(filename.c_str(), "w+b");
+  if (!mFile)
+  {
+    ROS_ERROR_STREAM("Could not open " << filename << " for dumping.");
+    return;
+  }
+
+  if (!truncateToLastRecord(mFile))
+  {
+    ROS_ERROR_STREAM(filename << " is not a trajectory dump.");
+    std::fclose(mFile);
+    mFile = nullptr;
+    return;
+  }
+  mBuffer.reserve(mBufferSize);
+}
+
+//==============================================================================
+TrajectoryDumpWriter::~TrajectoryDumpWriter()
+{
+  if (mState)
+    mStateSpace->freeState(mState);
+
+  if (!mFile)
+    return;
+  writeBuffer();
+  std::fclose(mFile);
+}
+
+//==============================================================================
+bool TrajectoryDumpWriter::isOpen() const
+{
+  return mFile != nullptr;
+}
+
+//==============================================================================
+void TrajectoryDumpWriter::append(
+    const aikido::trajectory::Spline& spline,
+    const std::string& label,
+    double time)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mFile)
+    return;
+
+  sample(spline);
+  appendRecord(label, time);
+}
+
+//==============================================================================
+void TrajectoryDumpWriter::append(
+    const std::vector<const aikido::trajectory::Spline*>& splines,
+    const std::vector<std::string>& labels,
+    double time)
+{
+  if (splines.size() != labels.size())
+    throw std::invalid_argument("Need one label per spline.");
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mFile)
+    return;
+
+  for (std::size_t i = 0; i < splines.size(); ++i)
+  {
+    sample(*splines[i]);
+    appendRecord(labels[i], time);
+  }
+}
+
+//==============================================================================
+void TrajectoryDumpWriter::flush()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mFile)
+    writeBuffer();
+}
+
+//==============================================================================
+void TrajectoryDumpWriter::sample(const aikido::trajectory::Spline& spline)
+{
+  auto space = spline.getStateSpace();
+  if (space != mStateSpace)
+  {
+    if (mState)
+      mStateSpace->freeState(mState);
+    mStateSpace = space;
+    mState = mStateSpace->allocateState();
+  }
+
+  mDimension = space->getDimension();
+  const double startTime = spline.getStartTime();
+  const double endTime = spline.getEndTime();
+  auto numSamples = static_cast<std::size_t>(
+                        std::floor((endTime - startTime) / mTimeStep))
+                    + 1;
+  if (startTime + (numSamples - 1) * mTimeStep < endTime - 1e-9)
+    ++numSamples;
+
+  mTimes.resize(numSamples);
+  for (std::size_t i = 0; i < numSamples; ++i)
+    mTimes[i] = std::min(startTime + i * mTimeStep, endTime);
+  mPositions.resize(numSamples * mDimension);
+  mVelocities.resize(numSamples * mDimension);
+  mStartPositions.resize(mDimension);
+
+  using OuterStride = Eigen::OuterStride<>;
+  using ColumnBlock = Eigen::Map<Eigen::MatrixXd, 0, OuterStride>;
+
+  std::size_t sampleIndex = 0;
+  double segmentStartTime = startTime;
+  const std::size_t numSegments = spline.getNumSegments();
+  for (std::size_t segment = 0; segment < numSegments; ++segment)
+  {
+    const bool isLast = segment + 1 == numSegments;
+    const double segmentEndTime
+        = segmentStartTime + spline.getSegmentDuration(segment);
+    const std::size_t first = sampleIndex;
+    while (sampleIndex < numSamples
+           && (isLast || mTimes[sampleIndex] < segmentEndTime))
+      ++sampleIndex;
+
+    const std::size_t numSegmentSamples = sampleIndex - first;
+    if (numSegmentSamples > 0)
+    {
+      // Rows are the powers of the time since the segment start and their
+      // derivatives, so one product evaluates the segment at all samples.
+      const auto& coefficients = spline.getSegmentCoefficients(segment);
+      const std::size_t numCoefficients = coefficients.cols();
+      mPowers.resize(numSegmentSamples * numCoefficients);
+      mDerivativePowers.resize(numSegmentSamples * numCoefficients);
+      Eigen::Map<Eigen::MatrixXd> powers(
+          mPowers.data(), numSegmentSamples, numCoefficients);
+      Eigen::Map<Eigen::MatrixXd> derivativePowers(
+          mDerivativePowers.data(), numSegmentSamples, numCoefficients);
+      for (std::size_t row = 0; row < numSegmentSamples; ++row)
+      {
+        double t = mTimes[first + row] - segmentStartTime;
+        double power = 1;
+        powers(row, 0) = 1;
+        derivativePowers(row, 0) = 0;
+        for (std::size_t k = 1; k < numCoefficients; ++k)
+        {
+          derivativePowers(row, k) = k * power;
+          power *= t;
+          powers(row, k) = power;
+        }
+      }
+
+      // The spline stores offsets from the segment start state.
+      spline.getWaypoint(segment, mState);
+      space->logMap(mState, mStartPositions);
+
+      ColumnBlock positions(
+          mPositions.data() + first,
+          numSegmentSamples,
+          mDimension,
+          OuterStride(numSamples));
+      ColumnBlock velocities(
+          mVelocities.data() + first,
+          numSegmentSamples,
+          mDimension,
+          OuterStride(numSamples));
+      positions.noalias() = powers * coefficients.transpose();
+      positions.rowwise() += mStartPositions.transpose();
+      velocities.noalias() = derivativePowers * coefficients.transpose();
+    }
+    segmentStartTime = segmentEndTime;
+  }
+}
+
+//==============================================================================
+void TrajectoryDumpWriter::appendRecord(const std::string& label, double time)
+{
+  trajectorydump::RecordHeader header;
+  header.dimension = mDimension;
+  header.numSamples = mTimes.size();
+  header.labelSize = label.size();
+  header.reserved = 0;
+  header.time = time;
+
+  std::size_t offset = mBuffer.size();
+  mBuffer.resize(offset + getRecordSize(header), 0);
+  char* out = mBuffer.data() + offset;
+  std::memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+  std::memcpy(out, label.data(), label.size());
+  out += getPaddedSize(label.size());
+  std::memcpy(out, mTimes.data(), mTimes.size() * sizeof(double));
+  out += mTimes.size() * sizeof(double);
+  std::memcpy(out, mPositions.data(), mPositions.size() * sizeof(double));
+  out += mPositions.size() * sizeof(double);
+  std::memcpy(out, mVelocities.data(), mVelocities.size() * sizeof(double));
+
+  if (mBuffer.size() >= mBufferSize)
+    writeBuffer();
+}
+
+//==============================================================================
+void TrajectoryDumpWriter::writeBuffer()
+{
+  if (mBuffer.empty())
+    return;
+
+  if (std::fwrite(mBuffer.data(), 1, mBuffer.size(), mFile) != mBuffer.size())
+    ROS_ERROR_STREAM("Failed to write trajectory dump.");
+  std::fflush(mFile);
+  mBuffer.clear();
+}
+
+//==============================================================================
+TrajectoryDumpReader::TrajectoryDumpReader(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("Could not open " + filename);
+  mData.assign(
+      std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+  trajectorydump::FileHeader fileHeader;
+  if (mData.size() < sizeof(fileHeader))
+    throw std::runtime_error(filename + " is not a trajectory dump");
+  std::memcpy(&fileHeader, mData.data(), sizeof(fileHeader));
+  if (std::memcmp(
+          fileHeader.magic,
+          trajectorydump::MAGIC,
+          sizeof(trajectorydump::MAGIC))
+      != 0)
+    throw std::runtime_error(filename + " is not a trajectory dump");
+
+  std::size_t offset = sizeof(fileHeader);
+  while (offset + sizeof(trajectorydump::RecordHeader) <= mData.size())
+  {
+    trajectorydump::RecordHeader header;
+    std::memcpy(&header, mData.data() + offset, sizeof(header));
+    std::size_t recordSize = getRecordSize(header);
+    if (offset + recordSize > mData.size())
+      break;
+    mRecords.push_back(offset);
+    offset += recordSize;
+  }
+}
+
+//==============================================================================
+std::size_t TrajectoryDumpReader::getNumTrajectories() const
+{
+  return mRecords.size();
+}
+
+//==============================================================================
+DumpedTrajectory TrajectoryDumpReader::getTrajectory(std::size_t index) const
+{
+  trajectorydump::RecordHeader header;
+  const char* in = mData.data() + mRecords.at(index);
+  std::memcpy(&header, in, sizeof(header));
+  in += sizeof(header);
+
+  DumpedTrajectory trajectory;
+  trajectory.time = header.time;
+  trajectory.label.assign(in, header.labelSize);
+  in += getPaddedSize(header.labelSize);
+
+  const std::size_t numSamples = header.numSamples;
+  const std::size_t dimension = header.dimension;
+  trajectory.times.resize(numSamples);
+  std::memcpy(trajectory.times.data(), in, numSamples * sizeof(double));
+  in += numSamples * sizeof(double);
+  trajectory.positions.resize(numSamples, dimension);
+  std::memcpy(
+      trajectory.positions.data(), in, numSamples * dimension * sizeof(double));
+  in += numSamples * dimension * sizeof(double);
+  trajectory.velocities.resize(numSamples, dimension);
+  std::memcpy(
+      trajectory.velocities.data(),
+      in,
+      numSamples * dimension * sizeof(double));
+  return trajectory;
+}
+
+} // namespace feeding
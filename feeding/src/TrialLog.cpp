@@ -0,0 +1,166 @@
+#include "feeding/TrialLog.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+#include <aikido/statespace/dart/MetaSkeletonStateSpace.hpp>
+#include <ros/ros.h>
+
+using aikido::statespace::dart::MetaSkeletonStateSpace;
+
+namespace feeding {
+
+namespace {
+
+//==============================================================================
+std::string quote(const std::string& value)
+{
+  std::string quoted = "\"";
+  for (char c : value)
+  {
+    if (c == '"' || c == '\\')
+      quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+//==============================================================================
+std::string spanFields(double startTime, double endTime, bool success)
+{
+  std::ostringstream fields;
+  fields << std::fixed << std::setprecision(4) << ", duration: "
+         << endTime - startTime
+         << ", success: " << (success ? "true" : "false");
+  return fields.str();
+}
+
+} // namespace
+
+//==============================================================================
+TrialLog::TrialLog(const std::string& filename, const std::string& trialName)
+  : mFile(filename)
+{
+  if (!mFile)
+  {
+    ROS_ERROR_STREAM("Could not open trial log " << filename);
+    return;
+  }
+
+  mFile << "# Events of trial " << trialName << std::endl;
+  std::lock_guard<std::mutex> lock(mMutex);
+  write(ros::Time::now().toSec(), "start", ", trial: " + quote(trialName));
+}
+
+//==============================================================================
+bool TrialLog::isOpen() const
+{
+  return mFile.is_open();
+}
+
+//==============================================================================
+void TrialLog::logPlan(
+    const std::string& planner, double startTime, double endTime, bool success)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  write(
+      startTime,
+      "plan",
+      ", planner: " + quote(planner)
+          + spanFields(startTime, endTime, success));
+}
+
+//==============================================================================
+void TrialLog::logExecution(
+    const std::string& motion,
+    double startTime,
+    double endTime,
+    bool success,
+    const aikido::trajectory::Trajectory* trajectory)
+{
+  std::ostringstream fields;
+  fields << ", motion: " << quote(motion)
+         << spanFields(startTime, endTime, success);
+
+  auto space = trajectory ? std::dynamic_pointer_cast<
+                                const MetaSkeletonStateSpace>(
+                                trajectory->getStateSpace())
+                          : nullptr;
+  if (space)
+  {
+    // Each sample is [time from start, joint positions...].
+    auto state = space->createState();
+    Eigen::VectorXd positions;
+    double duration = trajectory->getDuration();
+    fields << std::fixed << std::setprecision(4)
+           << ", trajectoryDuration: " << duration << ", samples: [";
+    for (std::size_t i = 0; i < NUM_TRAJECTORY_SAMPLES; ++i)
+    {
+      double time = duration * i / (NUM_TRAJECTORY_SAMPLES - 1);
+      trajectory->evaluate(trajectory->getStartTime() + time, state);
+      space->convertStateToPositions(state, positions);
+
+      fields << (i == 0 ? "[" : ", [") << time;
+      for (int j = 0; j < positions.size(); ++j)
+        fields << ", " << positions[j];
+      fields << "]";
+    }
+    fields << "]";
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  write(startTime, "execute", fields.str());
+}
+
+//==============================================================================
+void TrialLog::logPerception(
+    const std::string& target, double startTime, double endTime, bool success)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  write(
+      startTime,
+      "perceive",
+      ", target: " + quote(target) + spanFields(startTime, endTime, success));
+}
+
+//==============================================================================
+void TrialLog::logThresholds(double time, double force, double torque)
+{
+  std::ostringstream fields;
+  fields << ", force: " << force << ", torque: " << torque;
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  write(time, "thresholds", fields.str());
+}
+
+//==============================================================================
+void TrialLog::logImage(
+    const std::string& stream, double stamp, const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  write(
+      stamp,
+      "image",
+      ", stream: " + quote(stream) + ", name: " + quote(name));
+}
+
+//==============================================================================
+void TrialLog::logOutcome(double time, const std::string& label)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  write(time, "outcome", ", label: " + quote(label));
+}
+
+//==============================================================================
+void TrialLog::write(
+    double time, const std::string& event, const std::string& fields)
+{
+  if (!mFile)
+    return;
+
+  mFile << "- {time: " << std::fixed << std::setprecision(4) << time
+        << ", event: " << event << fields << "}\n";
+  mFile.flush();
+}
+
+} // namespace feeding
@@ -0,0 +1,479 @@
+#include "feeding/TrialRecorder.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "feeding/Dataset.hpp"
+
+namespace feeding {
+
+namespace {
+
+//==============================================================================
+/// Writes the file header at the start of \c file and cuts off the rest.
+bool writeFileHeader(std::FILE* file)
+{
+  trialrecord::FileHeader header;
+  std::memcpy(header.magic, trialrecord::MAGIC, sizeof(header.magic));
+  header.version = trialrecord::VERSION;
+  header.reserved = 0;
+  return ::ftruncate(::fileno(file), 0) == 0
+         && std::fseek(file, 0, SEEK_SET) == 0
+         && std::fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+//==============================================================================
+/// Cuts \c file after its last complete record, so that records appended
+/// after a crash are not lost behind a cut off one, and positions it there.
+/// Writes the file header to a file that is empty or shorter than it.
+/// \param[in] file Recording opened for reading and writing.
+/// \param[out] hasJointNames True if the file has a JOINT_NAMES record.
+/// \return False if \c file is not a recording or cannot be cut.
+bool truncateToLastRecord(std::FILE* file, bool& hasJointNames)
+{
+  hasJointNames = false;
+  if (std::fseek(file, 0, SEEK_END) != 0)
+    return false;
+  const long size = std::ftell(file);
+  if (size < static_cast<long>(sizeof(trialrecord::FileHeader)))
+    return writeFileHeader(file);
+
+  trialrecord::FileHeader header;
+  std::rewind(file);
+  if (std::fread(&header, sizeof(header), 1, file) != 1
+      || std::memcmp(header.magic, trialrecord::MAGIC, sizeof(header.magic))
+             != 0
+      || header.version != trialrecord::VERSION)
+    return false;
+
+  long offset = sizeof(header);
+  trialrecord::RecordHeader record;
+  while (offset + static_cast<long>(sizeof(record)) <= size
+         && std::fseek(file, offset, SEEK_SET) == 0
+         && std::fread(&record, sizeof(record), 1, file) == 1)
+  {
+    long recordSize = sizeof(record) + record.numValues * sizeof(double);
+    if (offset + recordSize > size)
+      break;
+    if (record.type == trialrecord::JOINT_NAMES)
+      hasJointNames = true;
+    offset += recordSize;
+  }
+
+  if (offset < size)
+  {
+    ROS_WARN_STREAM(
+        "Cutting off " << size - offset << " bytes of an incomplete record.");
+    if (::ftruncate(::fileno(file), offset) != 0)
+      return false;
+  }
+  return std::fseek(file, offset, SEEK_SET) == 0;
+}
+
+} // namespace
+
+//==============================================================================
+TrialRecorder::TrialRecorder(
+    ros::NodeHandle nodeHandle, std::chrono::milliseconds flushPeriod)
+  : mNodeHandle(nodeHandle)
+  , mFlushPeriod(flushPeriod)
+  , mRecording(false)
+  , mNumRecords(0)
+  , mHasJointNames(false)
+  , mFile(nullptr)
+  , mStopWriter(false)
+{
+  std::string ftTopic;
+  std::string jointStateTopic;
+  mNodeHandle.param<std::string>(
+      "/ftSensor/ftTopic", ftTopic, "/forque/forqueSensor");
+  mNodeHandle.param<std::string>(
+      "/trialRecorder/jointStateTopic", jointStateTopic, "/joint_states");
+
+  // Large queues: the callbacks are cheap and we do not want ROS to drop
+  // messages at sensor rate.
+  mWrenchSub = mNodeHandle.subscribe(
+      ftTopic, 1000, &TrialRecorder::wrenchCallback, this);
+  mJointStateSub = mNodeHandle.subscribe(
+      jointStateTopic, 1000, &TrialRecorder::jointStateCallback, this);
+
+  mWriterThread = std::thread(&TrialRecorder::writerLoop, this);
+}
+
+//==============================================================================
+TrialRecorder::~TrialRecorder()
+{
+  mWrenchSub.shutdown();
+  mJointStateSub.shutdown();
+  stop();
+
+  {
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    mStopWriter = true;
+  }
+  mWakeCondition.notify_one();
+  mWriterThread.join();
+}
+
+//==============================================================================
+bool TrialRecorder::start(const std::string& filename)
+{
+  stop();
+
+  std::lock_guard<std::mutex> fileLock(mFileMutex);
+  // Restarted trials append to the existing file.
+  mFile = std::fopen(filename.c_str(), "r+b");
+  if (!mFile)
+    mFile = std::fopen(filename.c_str(), "w+b");
+  if (!mFile)
+  {
+    ROS_ERROR_STREAM("Could not open " << filename << " for recording.");
+    return false;
+  }
+
+  bool hasJointNames;
+  if (!truncateToLastRecord(mFile, hasJointNames))
+  {
+    ROS_ERROR_STREAM(filename << " is not a trial recording.");
+    std::fclose(mFile);
+    mFile = nullptr;
+    return false;
+  }
+  mHasJointNames.store(hasJointNames);
+
+  {
+    std::lock_guard<std::mutex> batchLock(mBatchMutex);
+    mPending.clear();
+  }
+  mNumRecords.store(0);
+  mRecording.store(true);
+  ROS_INFO_STREAM("Recording F/T and joint states to " << filename);
+  return true;
+}
+
+//==============================================================================
+void TrialRecorder::start(std::shared_ptr<DatasetWriter> dataset)
+{
+  stop();
+
+  std::lock_guard<std::mutex> fileLock(mFileMutex);
+  mDataset = std::move(dataset);
+  mHasJointNames.store(false);
+  {
+    std::lock_guard<std::mutex> batchLock(mBatchMutex);
+    mPending.clear();
+  }
+  mNumRecords.store(0);
+  mRecording.store(true);
+  ROS_INFO_STREAM("Recording F/T and joint states to the dataset");
+}
+
+//==============================================================================
+void TrialRecorder::stop()
+{
+  mRecording.store(false);
+
+  std::lock_guard<std::mutex> fileLock(mFileMutex);
+  if (!mFile && !mDataset)
+    return;
+
+  flushPending();
+  if (mFile)
+  {
+    std::fclose(mFile);
+    mFile = nullptr;
+  }
+  mDataset.reset();
+}
+
+//==============================================================================
+bool TrialRecorder::isRecording() const
+{
+  return mRecording.load();
+}
+
+//==============================================================================
+std::size_t TrialRecorder::getNumRecords() const
+{
+  return mNumRecords.load();
+}
+
+//==============================================================================
+void TrialRecorder::wrenchCallback(
+    const geometry_msgs::WrenchStamped::ConstPtr& msg)
+{
+  if (!mRecording.load(std::memory_order_relaxed))
+    return;
+
+  const double values[6] = {msg->wrench.force.x,
+                            msg->wrench.force.y,
+                            msg->wrench.force.z,
+                            msg->wrench.torque.x,
+                            msg->wrench.torque.y,
+                            msg->wrench.torque.z};
+  append(trialrecord::WRENCH, msg->header.stamp.toSec(), values, 6);
+}
+
+//==============================================================================
+void TrialRecorder::jointStateCallback(
+    const sensor_msgs::JointState::ConstPtr& msg)
+{
+  if (!mRecording.load(std::memory_order_relaxed))
+    return;
+
+  if (!msg->name.empty() && !mHasJointNames.exchange(true))
+    appendJointNames(msg->name);
+
+  // Missing velocities or efforts are stored as NaN.
+  const std::size_t numJoints = msg->position.size();
+  std::vector<double> values(
+      3 * numJoints, std::numeric_limits<double>::quiet_NaN());
+  for (std::size_t i = 0; i < numJoints; ++i)
+  {
+    values[i] = msg->position[i];
+    if (i < msg->velocity.size())
+      values[numJoints + i] = msg->velocity[i];
+    if (i < msg->effort.size())
+      values[2 * numJoints + i] = msg->effort[i];
+  }
+  append(
+      trialrecord::JOINT_STATE,
+      msg->header.stamp.toSec(),
+      values.data(),
+      values.size());
+}
+
+//==============================================================================
+void TrialRecorder::appendJointNames(const std::vector<std::string>& names)
+{
+  std::string bytes;
+  for (const auto& name : names)
+  {
+    bytes += name;
+    bytes += '\0';
+  }
+  std::vector<double> values(
+      (bytes.size() + sizeof(double) - 1) / sizeof(double), 0);
+  std::memcpy(values.data(), bytes.data(), bytes.size());
+  append(
+      trialrecord::JOINT_NAMES,
+      ros::Time::now().toSec(),
+      values.data(),
+      values.size());
+}
+
+//==============================================================================
+void TrialRecorder::append(
+    trialrecord::RecordType type,
+    double time,
+    const double* values,
+    std::size_t numValues)
+{
+  if (numValues > std::numeric_limits<std::uint16_t>::max())
+  {
+    ROS_WARN_STREAM("Dropping record with " << numValues << " values.");
+    return;
+  }
+
+  trialrecord::RecordHeader header;
+  header.type = type;
+  header.numValues = static_cast<std::uint16_t>(numValues);
+  header.reserved = 0;
+  header.time = time;
+
+  const char* headerBytes = reinterpret_cast<const char*>(&header);
+  const char* valueBytes = reinterpret_cast<const char*>(values);
+
+  std::lock_guard<std::mutex> lock(mBatchMutex);
+  mPending.insert(mPending.end(), headerBytes, headerBytes + sizeof(header));
+  mPending.insert(
+      mPending.end(), valueBytes, valueBytes + numValues * sizeof(double));
+  mNumRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void TrialRecorder::writerLoop()
+{
+  std::unique_lock<std::mutex> wakeLock(mWakeMutex);
+  while (!mStopWriter)
+  {
+    mWakeCondition.wait_for(wakeLock, mFlushPeriod);
+    wakeLock.unlock();
+    {
+      std::lock_guard<std::mutex> fileLock(mFileMutex);
+      if (mFile || mDataset)
+        flushPending();
+    }
+    wakeLock.lock();
+  }
+}
+
+//==============================================================================
+void TrialRecorder::flushPending()
+{
+  {
+    std::lock_guard<std::mutex> lock(mBatchMutex);
+    mWriting.swap(mPending);
+  }
+
+  if (!mWriting.empty() && mDataset)
+  {
+    mDataset->appendSensorRecords(
+        ros::Time::now().toSec(), mWriting.data(), mWriting.size());
+  }
+  else if (!mWriting.empty())
+  {
+    if (std::fwrite(mWriting.data(), 1, mWriting.size(), mFile)
+        != mWriting.size())
+    {
+      ROS_ERROR_STREAM("Failed to write trial record batch.");
+    }
+    std::fflush(mFile);
+  }
+  // Keep the capacity so the callbacks do not reallocate next time.
+  mWriting.clear();
+}
+
+//==============================================================================
+TrialRecordReader::TrialRecordReader(const std::string& filename)
+  : mData(nullptr), mSize(0)
+{
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Could not open " + filename);
+
+  struct stat fileStat;
+  if (::fstat(fd, &fileStat) != 0
+      || fileStat.st_size < static_cast<off_t>(sizeof(trialrecord::FileHeader)))
+  {
+    ::close(fd);
+    throw std::runtime_error(filename + " is not a trial recording.");
+  }
+  mSize = static_cast<std::size_t>(fileStat.st_size);
+
+  void* data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error("Could not map " + filename);
+  mData = static_cast<const char*>(data);
+
+  const auto* header = reinterpret_cast<const trialrecord::FileHeader*>(mData);
+  if (std::memcmp(header->magic, trialrecord::MAGIC, sizeof(header->magic))
+          != 0
+      || header->version != trialrecord::VERSION)
+  {
+    ::munmap(const_cast<char*>(mData), mSize);
+    throw std::runtime_error(filename + " is not a trial recording.");
+  }
+
+  std::size_t offset = sizeof(trialrecord::FileHeader);
+  while (offset + sizeof(trialrecord::RecordHeader) <= mSize)
+  {
+    const auto* record = getRecord(offset);
+    std::size_t recordSize
+        = sizeof(trialrecord::RecordHeader) + record->numValues * sizeof(double);
+    if (offset + recordSize > mSize)
+      break;
+
+    if (record->type == trialrecord::WRENCH && record->numValues == 6)
+      mWrenchOffsets.push_back(offset);
+    else if (
+        record->type == trialrecord::JOINT_STATE && record->numValues % 3 == 0)
+      mJointStateOffsets.push_back(offset);
+    else if (record->type == trialrecord::JOINT_NAMES && mJointNames.empty())
+    {
+      const char* names = reinterpret_cast<const char*>(record + 1);
+      const char* end = names + record->numValues * sizeof(double);
+      while (names < end && *names != '\0')
+      {
+        std::size_t length = strnlen(names, end - names);
+        mJointNames.emplace_back(names, length);
+        names += length + 1;
+      }
+    }
+
+    offset += recordSize;
+  }
+}
+
+//==============================================================================
+TrialRecordReader::~TrialRecordReader()
+{
+  ::munmap(const_cast<char*>(mData), mSize);
+}
+
+//==============================================================================
+std::size_t TrialRecordReader::getNumWrenches() const
+{
+  return mWrenchOffsets.size();
+}
+
+//==============================================================================
+FTSample TrialRecordReader::getWrench(std::size_t index) const
+{
+  const auto* record = getRecord(mWrenchOffsets.at(index));
+  const auto* values = reinterpret_cast<const double*>(record + 1);
+
+  FTSample sample;
+  sample.time = record->time;
+  sample.force = Eigen::Map<const Eigen::Vector3d>(values);
+  sample.torque = Eigen::Map<const Eigen::Vector3d>(values + 3);
+  return sample;
+}
+
+//==============================================================================
+std::size_t TrialRecordReader::getNumJointStates() const
+{
+  return mJointStateOffsets.size();
+}
+
+//==============================================================================
+JointStateSample TrialRecordReader::getJointState(std::size_t index) const
+{
+  const auto* record = getRecord(mJointStateOffsets.at(index));
+  const auto* values = reinterpret_cast<const double*>(record + 1);
+  const std::size_t numJoints = record->numValues / 3;
+
+  JointStateSample sample;
+  sample.time = record->time;
+  sample.positions = Eigen::Map<const Eigen::VectorXd>(values, numJoints);
+  sample.velocities
+      = Eigen::Map<const Eigen::VectorXd>(values + numJoints, numJoints);
+  sample.efforts
+      = Eigen::Map<const Eigen::VectorXd>(values + 2 * numJoints, numJoints);
+  return sample;
+}
+
+//==============================================================================
+const std::vector<std::string>& TrialRecordReader::getJointNames() const
+{
+  return mJointNames;
+}
+
+//==============================================================================
+std::vector<FTSample> TrialRecordReader::getWrenches(
+    double startTime, double endTime) const
+{
+  std::vector<FTSample> wrenches;
+  for (std::size_t i = 0; i < mWrenchOffsets.size(); ++i)
+  {
+    double time = getRecord(mWrenchOffsets[i])->time;
+    if (time >= startTime && time <= endTime)
+      wrenches.push_back(getWrench(i));
+  }
+  return wrenches;
+}
+
+//==============================================================================
+const trialrecord::RecordHeader* TrialRecordReader::getRecord(
+    std::size_t offset) const
+{
+  return reinterpret_cast<const trialrecord::RecordHeader*>(mData + offset);
+}
+
+} // namespace feeding
@@ -0,0 +1,101 @@
+#include "feeding/WebStatusPublisher.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "std_msgs/String.h"
+
+namespace feeding {
+
+namespace {
+
+struct EventTopic
+{
+  const char* topic;
+  const char* text;
+};
+
+// Indexed by WebStatusPublisher::Event.
+const EventTopic eventTopics[] = {{"/action_done", "action done"},
+                                  {"/timing_done", "timing done"},
+                                  {"/transfer_done", "transfer done"}};
+
+} // namespace
+
+//==============================================================================
+WebStatusPublisher::WebStatusPublisher(ros::NodeHandle nodeHandle)
+{
+  std::string statusTopic;
+  int maxOutboxSize;
+  nodeHandle.param<std::string>(
+      "/webStatus/topic", statusTopic, "/feeding/web_status");
+  nodeHandle.param<int>("/webStatus/outboxSize", maxOutboxSize, 16);
+  mMaxOutboxSize = std::max(maxOutboxSize, 1);
+
+  for (const auto& eventTopic : eventTopics)
+  {
+    mEventPubs.push_back(
+        nodeHandle.advertise<std_msgs::String>(eventTopic.topic, 100, true));
+  }
+  mStatusPub = nodeHandle.advertise<std_msgs::String>(statusTopic, 100, true);
+  mWorker = std::thread(&WebStatusPublisher::run, this);
+}
+
+//==============================================================================
+WebStatusPublisher::~WebStatusPublisher()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRunning = false;
+  }
+  mCondition.notify_all();
+  mWorker.join();
+}
+
+//==============================================================================
+std::uint64_t WebStatusPublisher::publish(Event event)
+{
+  std::uint64_t sequence;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mOutbox.size() >= mMaxOutboxSize)
+    {
+      ROS_WARN_STREAM(
+          "Web status outbox is full, dropped event "
+          << mOutbox.front().sequence);
+      mOutbox.pop_front();
+    }
+    sequence = mNextSequence++;
+    mOutbox.push_back(Message{event, sequence});
+  }
+  mCondition.notify_one();
+  return sequence;
+}
+
+//==============================================================================
+void WebStatusPublisher::run()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true)
+  {
+    mCondition.wait(lock, [this] { return !mRunning || !mOutbox.empty(); });
+    if (mOutbox.empty())
+      return;
+
+    Message message = mOutbox.front();
+    mOutbox.pop_front();
+    lock.unlock();
+
+    const auto& eventTopic = eventTopics[static_cast<int>(message.event)];
+    std_msgs::String msg;
+    msg.data = eventTopic.text;
+    mEventPubs[static_cast<int>(message.event)].publish(msg);
+    msg.data = std::to_string(message.sequence) + " " + eventTopic.text;
+    mStatusPub.publish(msg);
+    ROS_INFO_STREAM(eventTopic.text << " published to web page");
+
+    lock.lock();
+  }
+}
+
+} // namespace feeding
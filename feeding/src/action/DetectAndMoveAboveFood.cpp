@@ -32,12 +32,23 @@ std::unique_ptr<FoodItem> detectAndMoveAboveFood(
     double* angleGuess,
     int actionOverride)
 {
+  auto trialLog = feedingDemo ? feedingDemo->getTrialLog() : nullptr;
+
   std::vector<std::unique_ptr<FoodItem>> candidateItems;
   while (true)
   {
     // Perception returns the list of good candidates, any one of them is good.
     // Multiple candidates are preferrable since planning may fail.
+    double perceptionStartTime = ros::Time::now().toSec();
     candidateItems = perception->perceiveFood(foodName);
+    if (trialLog)
+    {
+      trialLog->logPerception(
+          foodName,
+          perceptionStartTime,
+          ros::Time::now().toSec(),
+          !candidateItems.empty());
+    }
 
     if (candidateItems.size() == 0)
     {
@@ -1,5 +1,7 @@
 #include "feeding/action/FeedFoodToPerson.hpp"
 
+#include <boost/optional.hpp>
+
 #include <libada/util.hpp>
 
 #include "feeding/action/Grab.hpp"
@@ -10,7 +12,6 @@
 #include "feeding/util.hpp"
 
 using ada::util::createBwMatrixForTSR;
-using ada::util::getRosParam;
 using aikido::constraint::dart::TSR;
 
 namespace feeding {
@@ -43,8 +44,18 @@ void feedFoodToPerson(
     double endEffectorOffsetAngularTolerance,
     std::vector<double> velocityLimits,
     const Eigen::Vector3d* tiltOffset,
-    FeedingDemo* feedingDemo)
+    FeedingDemo* feedingDemo,
+    const std::function<bool()>& isCancelled)
 {
+  auto parameters = feedingDemo->getParameters()->get();
+
+  auto cancelled = [&] {
+    if (!isCancelled || !isCancelled())
+      return false;
+    ROS_WARN_STREAM("Transfer cancelled");
+    return true;
+  };
+
   auto moveIFOPerson = [&] {
     return moveInFrontOfPerson(
         ada,
@@ -55,13 +66,16 @@ void feedFoodToPerson(
         verticalToleranceForPerson,
         planningTimeout,
         maxNumTrials,
-        velocityLimits);
+        velocityLimits,
+        feedingDemo);
   };
 
   bool moveIFOSuccess = false;
   bool moveSuccess = false;
   for (std::size_t i = 0; i < 2; ++i)
   {
+    if (cancelled())
+      return;
     moveIFOSuccess = moveIFOPerson();
     if (!moveIFOSuccess)
     {
@@ -72,6 +86,8 @@ void feedFoodToPerson(
     else
       break;
   }
+  if (cancelled())
+    return;
 
   // Send message to web interface to indicate skewer finished
   publishActionDoneToWeb((ros::NodeHandle*)nodeHandle);
@@ -79,22 +95,15 @@ void feedFoodToPerson(
   // Ask for Tilt Override
   auto overrideTiltOffset = tiltOffset;
 
-  if (!getRosParam<bool>("/humanStudy/autoTransfer", *nodeHandle))
+  if (!parameters->autoTransfer)
   {
     talk("Should I tilt the food item?", false);
     std::string done = "";
-    std::string actionTopic;
-    nodeHandle->param<std::string>(
-        "/humanStudy/actionTopic", actionTopic, "/study_action_msgs");
-    done = getInputFromTopic(actionTopic, *nodeHandle, false, -1);
+    done = getInputFromTopic(parameters->actionTopic, *nodeHandle, false, -1);
 
     if (done == "tilt_the_food" || done == "tilt")
     {
-      std::vector<double> tiltOffsetVector
-          = getRosParam<std::vector<double>>("/study/tiltOffset", *nodeHandle);
-      auto tiltOffsetEigen = Eigen::Vector3d(
-          tiltOffsetVector[0], tiltOffsetVector[1], tiltOffsetVector[2]);
-      overrideTiltOffset = &tiltOffsetEigen;
+      overrideTiltOffset = &parameters->tiltOffset;
     }
     else if (done == "continue")
     {
@@ -105,11 +114,7 @@ void feedFoodToPerson(
       if (getUserInputWithOptions(optionPrompts, "Not valid, should I tilt??")
           == 1)
       {
-        std::vector<double> tiltOffsetVector = getRosParam<std::vector<double>>(
-            "/study/tiltOffset", *nodeHandle);
-        auto tiltOffsetEigen = Eigen::Vector3d(
-            tiltOffsetVector[0], tiltOffsetVector[1], tiltOffsetVector[2]);
-        overrideTiltOffset = &tiltOffsetEigen;
+        overrideTiltOffset = &parameters->tiltOffset;
       }
       else
       {
@@ -120,26 +125,69 @@ void feedFoodToPerson(
 
   publishTransferDoneToWeb((ros::NodeHandle*)nodeHandle);
 
+  aikido::trajectory::TrajectoryPtr approachPath;
+
   // Check autoTiming, and if false, wait for topic
-  if (!getRosParam<bool>("/humanStudy/autoTiming", *nodeHandle))
+  if (!parameters->autoTiming)
   {
     talk("Let me know when you are ready.", false);
     std::string done = "";
     while (done != "continue")
     {
-      std::string actionTopic;
-      nodeHandle->param<std::string>(
-          "/humanStudy/actionTopic", actionTopic, "/study_action_msgs");
-      done = getInputFromTopic(actionTopic, *nodeHandle, false, -1);
+      done
+          = getInputFromTopic(parameters->actionTopic, *nodeHandle, false, -1);
     }
   }
   else
   {
     nodeHandle->setParam("/feeding/facePerceptionOn", true);
     talk("Open your mouth when ready.", false);
+
+    // The approach to the face is planned while waiting, and again whenever
+    // the face moves, so that it starts as soon as the mouth opens. The arm
+    // still stops in front of the person: it must not move towards the
+    // face before the mouth is open.
+    auto lookahead = feedingDemo->getLookaheadPlanner();
+    bool planApproach
+        = lookahead && moveIFOSuccess
+          && !(parameters->autoTransfer && parameters->createError);
+    boost::optional<Eigen::Vector3d> approachFace;
     // TODO: Add mouth-open detection.
     while (true)
     {
+      if (cancelled())
+      {
+        nodeHandle->setParam("/feeding/facePerceptionOn", false);
+        return;
+      }
+
+      if (planApproach)
+      {
+        try
+        {
+          Eigen::Isometry3d face = perception->perceiveFace();
+          if (!approachFace
+              || (face.translation() - *approachFace).norm()
+                     > parameters->approachReplanDistance)
+          {
+            Eigen::Vector3d offset = getOffsetTowardsPerson(
+                ada, face, overrideTiltOffset ? distanceToPerson : 0);
+            lookahead->planEndEffectorOffset(
+                lookahead->getCurrentConfiguration(),
+                offset.normalized(),
+                offset.norm(),
+                planningTimeout,
+                endEffectorOffsetPositionTolerenace,
+                endEffectorOffsetAngularTolerance);
+            approachFace = face.translation();
+          }
+        }
+        catch (...)
+        {
+          // No face detected yet.
+        }
+      }
+
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       if (perception->isMouthOpen())
       {
@@ -151,8 +199,10 @@ void feedFoodToPerson(
       }
     }
     nodeHandle->setParam("/feeding/facePerceptionOn", false);
+    if (approachFace)
+      approachPath = lookahead->getPath();
 
-    if (getRosParam<bool>("/humanStudy/createError", *nodeHandle))
+    if (parameters->createError)
     {
       // Wait an extra 5 seconds
       ROS_WARN_STREAM("Error Requested for Timing!");
@@ -161,11 +211,13 @@ void feedFoodToPerson(
     }
   }
 
+  if (cancelled())
+    return;
+
   if (moveIFOSuccess)
   {
 
-    if (getRosParam<bool>("/humanStudy/autoTransfer", *nodeHandle)
-        && getRosParam<bool>("/humanStudy/createError", *nodeHandle))
+    if (parameters->autoTransfer && parameters->createError)
     {
       ROS_WARN_STREAM("Error Requested for Transfer!");
       // Erroneous Transfer
@@ -197,9 +249,12 @@ void feedFoodToPerson(
           verticalToleranceForPerson,
           planningTimeout,
           maxNumTrials,
-          velocityLimits);
+          velocityLimits,
+          feedingDemo);
     }
 
+    if (cancelled())
+      return;
     nodeHandle->setParam("/feeding/facePerceptionOn", true);
 
     if (overrideTiltOffset == nullptr)
@@ -216,10 +271,14 @@ void feedFoodToPerson(
         distanceToPerson,
         planningTimeout,
         endEffectorOffsetPositionTolerenace,
-        endEffectorOffsetAngularTolerance);
+        endEffectorOffsetAngularTolerance,
+        approachPath);
     nodeHandle->setParam("/feeding/facePerceptionOn", false);
   }
 
+  if (cancelled())
+    return;
+
   // Execute Tilt
   if (overrideTiltOffset != nullptr)
   {
@@ -263,13 +322,34 @@ void feedFoodToPerson(
 
     talk("Tilting, hold tight.", true);
 
-    ada->moveArmToTSR(
-        personTSR,
-        nullptr, // collisionFreeWithWallFurtherBack,
-        planningTimeout,
-        maxNumTrials,
-        getConfigurationRanker(ada),
-        slowerVelocity);
+    auto goalSeeds = feedingDemo ? feedingDemo->getGoalSeedCache() : nullptr;
+    bool tiltCompleted;
+    if (goalSeeds)
+    {
+      tiltCompleted = goalSeeds->moveArmToTSR(
+          ada,
+          personTSR,
+          nullptr, // collisionFreeWithWallFurtherBack,
+          planningTimeout,
+          maxNumTrials,
+          goalSeeds->getConfigurationRanker(ada, personTSR),
+          slowerVelocity);
+    }
+    else
+    {
+      tiltCompleted = ada->moveArmToTSR(
+          personTSR,
+          nullptr, // collisionFreeWithWallFurtherBack,
+          planningTimeout,
+          maxNumTrials,
+          getConfigurationRanker(ada),
+          slowerVelocity);
+    }
+    if (tiltCompleted && goalSeeds)
+    {
+      goalSeeds->addSeed(
+          personTSR, ada->getArm()->getMetaSkeleton()->getPositions());
+    }
 
     /*
     Eigen::VectorXd moveTiltPose(6);
@@ -279,6 +359,9 @@ void feedFoodToPerson(
     */
   }
 
+  if (cancelled())
+    return;
+
   if (moveIFOSuccess)
   {
     // ===== EATING =====
@@ -287,7 +370,9 @@ void feedFoodToPerson(
     std::this_thread::sleep_for(waitAtPerson);
 
     // Backward
-    ada::util::waitForUser("Move backward", ada);
+    waitForOperator("Move backward");
+    if (cancelled())
+      return;
     talk("Let me get out of your way.", true);
     Eigen::Vector3d goalDirection(0, -1, 0);
     bool success = moveInFrontOfPerson(
@@ -299,10 +384,14 @@ void feedFoodToPerson(
         verticalToleranceForPerson * 2,
         planningTimeout,
         maxNumTrials,
-        velocityLimits);
+        velocityLimits,
+        feedingDemo);
     ROS_INFO_STREAM("Backward " << success << std::endl);
   }
 
+  if (cancelled())
+    return;
+
   // ===== BACK TO PLATE =====
   ROS_INFO_STREAM("Move back to plate");
 
@@ -319,7 +408,8 @@ void feedFoodToPerson(
       rotationToleranceAbovePlate,
       planningTimeout,
       maxNumTrials,
-      velocityLimits);
+      velocityLimits,
+      feedingDemo);
 
   publishTimingDoneToWeb((ros::NodeHandle*)nodeHandle);
 }
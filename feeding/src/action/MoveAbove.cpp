@@ -27,68 +27,150 @@ bool moveAbove(
     FeedingDemo* feedingDemo)
 {
   ROS_WARN_STREAM("CALLED MOVE ABOVE; Rotation: " << rotationTolerance);
-  TSR target;
+  auto createTarget = [&](double tolerance) {
+    TSR target;
+    target.mT0_w = targetTransform;
+    target.mBw = createBwMatrixForTSR(
+        horizontalTolerance,
+        horizontalTolerance,
+        verticalTolerance,
+        0,
+        tiltTolerance,
+        tolerance);
+    target.mTw_e.matrix() = endEffectorTransform.matrix();
+    return target;
+  };
 
-  target.mT0_w = targetTransform;
-  target.mBw = createBwMatrixForTSR(
-      horizontalTolerance,
-      horizontalTolerance,
-      verticalTolerance,
-      0,
-      tiltTolerance,
-      rotationTolerance);
+  // Retries loosen the rotation tolerance by a factor of 4 up to 2 rad.
+  std::vector<double> rotationTolerances{rotationTolerance};
+  while (rotationTolerances.back() * 4 <= 2.0)
+    rotationTolerances.push_back(rotationTolerances.back() * 4);
+  std::vector<TSR> targets;
+  for (double tolerance : rotationTolerances)
+    targets.push_back(createTarget(tolerance));
 
-  target.mTw_e.matrix() = endEffectorTransform.matrix();
+  auto trialLog = feedingDemo ? feedingDemo->getTrialLog() : nullptr;
+  auto roadmap = feedingDemo ? feedingDemo->getRoadmap() : nullptr;
+  auto goalSeeds = feedingDemo ? feedingDemo->getGoalSeedCache() : nullptr;
+  auto retimer = feedingDemo ? feedingDemo->getRetimer() : nullptr;
+  // The portfolio only mirrors the main collision constraint of the demo.
+  auto portfolio = feedingDemo ? feedingDemo->getPlanningPortfolio() : nullptr;
+  if (portfolio && portfolio->getCollisionConstraint() != collisionFree)
+    portfolio = nullptr;
 
   try
   {
     bool trajectoryCompleted = false;
-    do
+    std::size_t level = 0;
+    while (!trajectoryCompleted && level < targets.size())
     {
       std::cout << "MoveAbove Current pose \n"
                 << ada->getMetaSkeleton()->getPositions().transpose()
                 << std::endl;
-      trajectoryCompleted = ada->moveArmToTSR(
-          target,
-          collisionFree,
-          planningTimeout,
-          maxNumTrials,
-          getConfigurationRanker(ada),
-          velocityLimits,
-          ::ada::TrajectoryPostprocessType::KUNZ);
+      if (level > 0)
+      {
+        std::cout << "Trying again with rotation Tolerance:"
+                  << rotationTolerances[level] << std::endl;
+      }
 
-      if (!trajectoryCompleted)
+      // Same as moveArmToTSR, split so that the trial log can tell planning
+      // from execution time.
+      double planStartTime = ros::Time::now().toSec();
+      std::string planner = "roadmap";
+      std::size_t plannedLevel = level;
+      auto trajectory
+          = roadmap ? roadmap->planToTSR(ada, targets[level], collisionFree)
+                    : nullptr;
+      if (!trajectory && portfolio)
+      {
+        // Plans this and all looser tolerances at once and takes the
+        // tightest one that succeeded.
+        planner = "portfolio";
+        auto planned = portfolio->plan(
+            std::vector<TSR>(targets.begin() + level, targets.end()),
+            planningTimeout,
+            maxNumTrials);
+        trajectory = planned.second;
+        plannedLevel = level + planned.first - (trajectory ? 0 : 1);
+      }
+      else if (!trajectory)
       {
-        if (rotationTolerance <= 2.0)
+        planner = "planArmToTSR";
+        if (goalSeeds)
         {
-          rotationTolerance *= 4;
-          std::cout << "Trying again with rotation Tolerance:"
-                    << rotationTolerance << std::endl;
-          target.mBw = createBwMatrixForTSR(
-              horizontalTolerance,
-              horizontalTolerance,
-              verticalTolerance,
-              0,
-              tiltTolerance,
-              rotationTolerance);
-          continue;
+          trajectory = goalSeeds->planToTSR(
+              ada,
+              targets[level],
+              collisionFree,
+              planningTimeout,
+              maxNumTrials,
+              goalSeeds->getConfigurationRanker(ada, targets[level]));
         }
+        else
+        {
+          trajectory = ada->planArmToTSR(
+              targets[level],
+              collisionFree,
+              planningTimeout,
+              maxNumTrials,
+              getConfigurationRanker(ada));
+        }
+      }
+      double executionStartTime = ros::Time::now().toSec();
+      if (trialLog)
+      {
+        trialLog->logPlan(
+            planner,
+            planStartTime,
+            executionStartTime,
+            trajectory != nullptr);
+      }
+
+      if (trajectory && retimer)
+      {
+        trajectoryCompleted = retimer->moveArm(
+            ada,
+            "moveAbove",
+            trajectory,
+            collisionFree,
+            velocityLimits,
+            feedingDemo->getTrajectoryDump());
       }
       else
       {
-        break;
+        trajectoryCompleted = trajectory
+                              && ada->moveArmOnTrajectory(
+                                  trajectory,
+                                  collisionFree,
+                                  ::ada::TrajectoryPostprocessType::KUNZ,
+                                  velocityLimits);
+      }
+      if (trialLog && trajectory)
+      {
+        // Logs the planned path; the timed motion is in the joint states.
+        trialLog->logExecution(
+            planner,
+            executionStartTime,
+            ros::Time::now().toSec(),
+            trajectoryCompleted,
+            trajectory.get());
+      }
+      if (trajectoryCompleted && goalSeeds)
+      {
+        goalSeeds->addSeed(
+            targets[plannedLevel],
+            ada->getArm()->getMetaSkeleton()->getPositions());
       }
+      level = plannedLevel + 1;
+    }
 
-    } while (rotationTolerance <= 2.0);
     if (!trajectoryCompleted)
     {
       // talk("No trajectory, check T.S.R.", true);
       if (feedingDemo && feedingDemo->getViewer())
       {
-        feedingDemo->getViewer()->addTSRMarker(target);
-        std::cout << "Check TSR" << std::endl;
-        int n;
-        std::cin >> n;
+        feedingDemo->getViewer()->addTSRMarker(targets.back());
+        waitForOperator("Check TSR");
       }
     }
     return trajectoryCompleted;
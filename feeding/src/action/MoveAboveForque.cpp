@@ -15,7 +15,8 @@ void moveAboveForque(
     double forkHolderAngle,
     std::vector<double> forkHolderTranslation,
     double planningTimeout,
-    int maxNumTrials)
+    int maxNumTrials,
+    FeedingDemo* feedingDemo)
 {
   auto aboveForqueTSR = pr_tsr::getDefaultPlateTSR();
   Eigen::Isometry3d forquePose = Eigen::Isometry3d::Identity();
@@ -36,8 +37,31 @@ void moveAboveForque(
   aboveForqueTSR.mTw_e.matrix()
       *= ada->getHand()->getEndEffectorTransform("plate")->matrix();
 
-  if (!ada->moveArmToTSR(
-          aboveForqueTSR, collisionFree, planningTimeout, maxNumTrials))
+  auto cache = feedingDemo ? feedingDemo->getTrajectoryCache() : nullptr;
+  bool success;
+  if (cache)
+  {
+    std::vector<double> goalValues{forkHolderAngle};
+    goalValues.insert(
+        goalValues.end(),
+        forkHolderTranslation.begin(),
+        forkHolderTranslation.end());
+    success = cache->moveArm(
+        ada,
+        TrajectoryCache::getGoalName("aboveForque", goalValues),
+        collisionFree,
+        [&] {
+          return ada->planArmToTSR(
+              aboveForqueTSR, collisionFree, planningTimeout, maxNumTrials);
+        },
+        std::vector<double>());
+  }
+  else
+  {
+    success = ada->moveArmToTSR(
+        aboveForqueTSR, collisionFree, planningTimeout, maxNumTrials);
+  }
+  if (!success)
     throw std::runtime_error("Trajectory execution failed");
 }
 
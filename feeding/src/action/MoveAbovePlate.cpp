@@ -15,14 +15,24 @@ bool moveAbovePlate(
     double rotationTolerance,
     double planningTimeout,
     int maxNumTrials,
-    std::vector<double> velocityLimits)
+    std::vector<double> velocityLimits,
+    FeedingDemo* feedingDemo)
 {
 
   // Hardcoded pose
   Eigen::VectorXd homeConfig(6);
   homeConfig << -2.11666, 3.34967, 2.04129, -2.30031, -2.34026, 2.9545;
-  bool success = ada->moveArmToConfiguration(
-      homeConfig, collisionFree, 2.0, velocityLimits);
+  auto cache = feedingDemo ? feedingDemo->getTrajectoryCache() : nullptr;
+  bool success
+      = cache ? cache->moveArmToConfiguration(
+                    ada,
+                    "abovePlate",
+                    homeConfig,
+                    collisionFree,
+                    2.0,
+                    velocityLimits)
+              : ada->moveArmToConfiguration(
+                    homeConfig, collisionFree, 2.0, velocityLimits);
   if (!success)
     return moveAbove(
         ada,
@@ -78,14 +78,51 @@ bool moveDirectlyToPerson(
   //  std::cin >> n;
   //}
 
-  if (!ada->moveArmToTSR(
+  auto roadmap = feedingDemo ? feedingDemo->getRoadmap() : nullptr;
+  auto retimer = feedingDemo ? feedingDemo->getRetimer() : nullptr;
+  bool success;
+  if (retimer)
+  {
+    auto path = roadmap ? roadmap->planToTSR(ada, personTSR, collisionFree)
+                        : nullptr;
+    if (!path)
+    {
+      path = ada->planArmToTSR(
           personTSR,
           collisionFree,
           planningTimeout,
           maxNumTrials,
-          getConfigurationRanker(ada),
-          velocityLimits,
-          ada::TrajectoryPostprocessType::KUNZ))
+          getConfigurationRanker(ada));
+    }
+    success = path
+              && retimer->moveArm(
+                  ada,
+                  "moveDirectlyToPerson",
+                  path,
+                  collisionFree,
+                  velocityLimits,
+                  feedingDemo->getTrajectoryDump());
+  }
+  else
+  {
+    success = roadmap ? roadmap->moveArmToTSR(
+                            ada,
+                            personTSR,
+                            collisionFree,
+                            planningTimeout,
+                            maxNumTrials,
+                            getConfigurationRanker(ada),
+                            velocityLimits)
+                      : ada->moveArmToTSR(
+                            personTSR,
+                            collisionFree,
+                            planningTimeout,
+                            maxNumTrials,
+                            getConfigurationRanker(ada),
+                            velocityLimits,
+                            ada::TrajectoryPostprocessType::KUNZ);
+  }
+  if (!success)
   {
     ROS_WARN_STREAM("Execution failed");
     return false;
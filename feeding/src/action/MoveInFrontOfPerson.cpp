@@ -41,8 +41,17 @@ bool moveInFrontOfPerson(
   // Participant Tripod
   // moveIFOPose << -1.81752, 4.60286, 4.64300, -3.05122, 1.89743, -0.61493;
 
-  bool success = ada->moveArmToConfiguration(
-      moveIFOPose, collisionFree, 2.0, velocityLimits);
+  auto cache = feedingDemo ? feedingDemo->getTrajectoryCache() : nullptr;
+  bool success
+      = cache ? cache->moveArmToConfiguration(
+                    ada,
+                    "inFrontOfPerson",
+                    moveIFOPose,
+                    collisionFree,
+                    2.0,
+                    velocityLimits)
+              : ada->moveArmToConfiguration(
+                    moveIFOPose, collisionFree, 2.0, velocityLimits);
   if (success)
     return true;
 
@@ -64,13 +73,49 @@ bool moveInFrontOfPerson(
   personTSR.mTw_e.matrix()
       *= ada->getHand()->getEndEffectorTransform("person")->matrix();
 
-  return ada->moveArmToTSR(
-      personTSR,
-      collisionFree,
-      planningTimeout,
-      maxNumTrials,
-      getConfigurationRanker(ada),
-      velocityLimits);
+  auto roadmap = feedingDemo ? feedingDemo->getRoadmap() : nullptr;
+  auto goalSeeds = feedingDemo ? feedingDemo->getGoalSeedCache() : nullptr;
+  auto ranker = goalSeeds ? goalSeeds->getConfigurationRanker(ada, personTSR)
+                          : getConfigurationRanker(ada);
+  if (roadmap)
+  {
+    success = roadmap->moveArmToTSR(
+        ada,
+        personTSR,
+        collisionFree,
+        planningTimeout,
+        maxNumTrials,
+        ranker,
+        velocityLimits);
+  }
+  else if (goalSeeds)
+  {
+    success = goalSeeds->moveArmToTSR(
+        ada,
+        personTSR,
+        collisionFree,
+        planningTimeout,
+        maxNumTrials,
+        ranker,
+        velocityLimits);
+  }
+  else
+  {
+    success = ada->moveArmToTSR(
+        personTSR,
+        collisionFree,
+        planningTimeout,
+        maxNumTrials,
+        ranker,
+        velocityLimits);
+  }
+
+  if (success && goalSeeds)
+  {
+    goalSeeds->addSeed(
+        personTSR, ada->getArm()->getMetaSkeleton()->getPositions());
+  }
+  return success;
 }
 } // namespace action
 } // namespace feeding
@@ -1,7 +1,11 @@
 #include "feeding/action/MoveInto.hpp"
 
+#include <aikido/planner/kunzretimer/KunzRetimer.hpp>
+
 #include <libada/util.hpp>
 
+#include "feeding/Retimer.hpp"
+#include "feeding/SimulatedMoveUntilTouchExecutor.hpp"
 #include "feeding/TargetItem.hpp"
 #include "feeding/action/MoveAbove.hpp"
 #include "feeding/action/MoveOutOf.hpp"
@@ -12,6 +16,65 @@
 namespace feeding {
 namespace action {
 
+namespace {
+
+//==============================================================================
+/// Times \c path like moveArmOnTrajectory does and plays it on the
+/// simulated controller.
+/// \return False if the path could not be timed or the controller failed
+/// for another reason than contact.
+bool executeSimulated(
+    const std::shared_ptr<ada::Ada>& ada,
+    SimulatedMoveUntilTouchExecutor& controller,
+    const aikido::trajectory::TrajectoryPtr& path,
+    const std::vector<double>& velocityLimits)
+{
+  auto interpolated
+      = dynamic_cast<const aikido::trajectory::Interpolated*>(path.get());
+  if (!interpolated)
+    return false;
+
+  auto metaSkeleton = ada->getArm()->getMetaSkeleton();
+  Eigen::VectorXd velocityUpperLimits = metaSkeleton->getVelocityUpperLimits();
+  if (velocityLimits.size() == velocityUpperLimits.size())
+  {
+    velocityUpperLimits = Eigen::Map<const Eigen::VectorXd>(
+        velocityLimits.data(), velocityLimits.size());
+  }
+
+  // Only a failure of the execution itself can be a contact.
+  bool isExecuting = false;
+  try
+  {
+    aikido::trajectory::TrajectoryPtr trajectory
+        = aikido::planner::kunzretimer::computeKunzTiming(
+            *interpolated,
+            velocityUpperLimits,
+            metaSkeleton->getAccelerationUpperLimits(),
+            KUNZ_MAX_DEVIATION,
+            KUNZ_TIME_STEP);
+    if (!trajectory)
+    {
+      ROS_WARN_STREAM("Could not time the simulated trajectory");
+      return false;
+    }
+    isExecuting = true;
+    controller.execute(trajectory).get();
+  }
+  catch (const std::exception& e)
+  {
+    if (!isExecuting || !controller.hasStoppedOnContact())
+    {
+      ROS_WARN_STREAM("Simulated execution failed: " << e.what());
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+//==============================================================================
 bool moveInto(
     const std::shared_ptr<ada::Ada>& ada,
     const std::shared_ptr<Perception>& perception,
@@ -23,7 +86,8 @@ bool moveInto(
     double endEffectorOffsetAngularTolerance,
     const Eigen::Vector3d& endEffectorDirection,
     std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
-    const std::vector<double>& velocityLimits)
+    const std::vector<double>& velocityLimits,
+    const aikido::trajectory::TrajectoryPtr& path)
 {
   ROS_INFO_STREAM("Move into " + TargetToString.at(item));
 
@@ -75,18 +139,45 @@ bool moveInto(
   // int n;
   // std::cin >> n;
   {
-    double length = 0.085;
     int numDofs = ada->getArm()->getMetaSkeleton()->getNumDofs();
     // Collision constraint is not set because f/t sensor stops execution.
 
-    auto result = ada->moveArmToEndEffectorOffset(
-        endEffectorDirection,
-        length,
-        nullptr,
-        planningTimeout,
-        endEffectorOffsetPositionTolerance,
-        endEffectorOffsetAngularTolerance,
-        velocityLimits);
+    auto simulatedController = ftThresholdHelper
+                                   ? ftThresholdHelper->getSimulatedController()
+                                   : nullptr;
+    if (simulatedController)
+    {
+      auto trajectory = path ? path
+                             : ada->planArmToEndEffectorOffset(
+                                   endEffectorDirection,
+                                   MOVE_INTO_FOOD_LENGTH,
+                                   nullptr,
+                                   planningTimeout,
+                                   endEffectorOffsetPositionTolerance,
+                                   endEffectorOffsetAngularTolerance);
+      auto result = trajectory
+                    && executeSimulated(
+                           ada,
+                           *simulatedController,
+                           trajectory,
+                           velocityLimits);
+      ROS_INFO_STREAM(" Simulated execution result: " << result);
+      return true;
+    }
+
+    auto result = path ? ada->moveArmOnTrajectory(
+                             path,
+                             nullptr,
+                             ::ada::TrajectoryPostprocessType::KUNZ,
+                             velocityLimits)
+                       : ada->moveArmToEndEffectorOffset(
+                             endEffectorDirection,
+                             MOVE_INTO_FOOD_LENGTH,
+                             nullptr,
+                             planningTimeout,
+                             endEffectorOffsetPositionTolerance,
+                             endEffectorOffsetAngularTolerance,
+                             velocityLimits);
     ROS_INFO_STREAM(" Execution result: " << result);
   }
 
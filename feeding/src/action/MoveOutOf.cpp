@@ -23,7 +23,8 @@ void moveOutOf(
     double endEffectorOffsetPositionTolerance,
     double endEffectorOffsetAngularTolerance,
     const std::shared_ptr<FTThresholdHelper>& ftThresholdHelper,
-    const std::vector<double>& velocityLimits)
+    const std::vector<double>& velocityLimits,
+    const aikido::trajectory::TrajectoryPtr& path)
 {
 
   ROS_INFO_STREAM("Move Out of " + TargetToString.at(item));
@@ -33,14 +34,19 @@ void moveOutOf(
     ftThresholdHelper->setThresholds(AFTER_GRAB_FOOD_FT_THRESHOLD);
   }
 
-  bool trajectoryCompleted = ada->moveArmToEndEffectorOffset(
-      direction,
-      length,
-      collisionFree,
-      planningTimeout,
-      endEffectorOffsetPositionTolerance,
-      endEffectorOffsetAngularTolerance,
-      velocityLimits);
+  bool trajectoryCompleted = path ? ada->moveArmOnTrajectory(
+                                        path,
+                                        collisionFree,
+                                        ::ada::TrajectoryPostprocessType::KUNZ,
+                                        velocityLimits)
+                                  : ada->moveArmToEndEffectorOffset(
+                                        direction,
+                                        length,
+                                        collisionFree,
+                                        planningTimeout,
+                                        endEffectorOffsetPositionTolerance,
+                                        endEffectorOffsetAngularTolerance,
+                                        velocityLimits);
 
   // trajectoryCompleted might be false because the forque hit the food
   // along the way and the trajectory was aborted
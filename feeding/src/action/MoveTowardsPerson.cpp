@@ -7,6 +7,23 @@
 namespace feeding {
 namespace action {
 
+//==============================================================================
+Eigen::Vector3d getOffsetTowardsPerson(
+    const std::shared_ptr<ada::Ada>& ada,
+    const Eigen::Isometry3d& facePose,
+    double distanceToPerson)
+{
+  Eigen::Isometry3d currentPose
+      = ada->getHand()->getEndEffectorBodyNode()->getTransform();
+
+  // Plan from current to goal pose
+  Eigen::Vector3d vectorToGoalPose
+      = facePose.translation() - currentPose.translation();
+  vectorToGoalPose.y() -= distanceToPerson;
+  return vectorToGoalPose;
+}
+
+//==============================================================================
 bool moveTowardsPerson(
     const std::shared_ptr<ada::Ada>& ada,
     const aikido::constraint::dart::CollisionFreePtr& collisionFree,
@@ -15,7 +32,8 @@ bool moveTowardsPerson(
     double distanceToPerson,
     double planningTimeout,
     double endEffectorOffsetPositionTolerenace,
-    double endEffectorOffsetAngularTolerance)
+    double endEffectorOffsetAngularTolerance,
+    const aikido::trajectory::TrajectoryPtr& path)
 {
   ROS_INFO_STREAM("Move towards person");
 
@@ -25,6 +43,20 @@ bool moveTowardsPerson(
   // SLOW
   // std::vector<double> velocityLimits(numDofs, 0.1);
 
+  if (path)
+  {
+    if (!ada->moveArmOnTrajectory(
+            path,
+            nullptr,
+            ::ada::TrajectoryPostprocessType::KUNZ,
+            velocityLimits))
+    {
+      ROS_WARN_STREAM("Execution failed");
+      return false;
+    }
+    return true;
+  }
+
   /*
 
   PerceptionServoClient servoClient(
@@ -65,13 +97,8 @@ bool moveTowardsPerson(
     }
   }
 
-  Eigen::Isometry3d currentPose
-      = ada->getHand()->getEndEffectorBodyNode()->getTransform();
-
-  // Plan from current to goal pose
   Eigen::Vector3d vectorToGoalPose
-      = personPose.translation() - currentPose.translation();
-  vectorToGoalPose.y() -= distanceToPerson;
+      = getOffsetTowardsPerson(ada, personPose, distanceToPerson);
   auto length = vectorToGoalPose.norm();
   vectorToGoalPose.normalize();
 
@@ -26,7 +26,8 @@ void pickUpFork(
     double planningTimeout,
     int maxNumTrials,
     std::vector<double> velocityLimits,
-    std::shared_ptr<FTThresholdHelper> ftThresholdHelper)
+    std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
+    FeedingDemo* feedingDemo)
 {
   ada->openHand();
   moveAboveForque(
@@ -35,7 +36,8 @@ void pickUpFork(
       forkHolderAngle,
       forkHolderTranslation,
       planningTimeout,
-      maxNumTrials);
+      maxNumTrials,
+      feedingDemo);
 
   Eigen::Vector3d endEffectorDirection(0, 0, -1);
   moveInto(
@@ -83,7 +85,8 @@ void pickUpFork(
       rotationToleranceAbovePlate,
       planningTimeout,
       maxNumTrials,
-      velocityLimits);
+      velocityLimits,
+      feedingDemo);
 }
 
 } // namespace action
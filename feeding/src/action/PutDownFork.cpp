@@ -26,7 +26,8 @@ void putDownFork(
     double planningTimeout,
     int maxNumTrials,
     std::vector<double> velocityLimits,
-    std::shared_ptr<FTThresholdHelper> ftThresholdHelper)
+    std::shared_ptr<FTThresholdHelper> ftThresholdHelper,
+    FeedingDemo* feedingDemo)
 {
   ada->closeHand();
   moveAboveForque(
@@ -35,7 +36,8 @@ void putDownFork(
       forkHolderAngle,
       forkHolderTranslation,
       planningTimeout,
-      maxNumTrials);
+      maxNumTrials,
+      feedingDemo);
 
   moveInto(
       ada,
@@ -73,7 +75,8 @@ void putDownFork(
       rotationToleranceAbovePlate,
       planningTimeout,
       maxNumTrials,
-      velocityLimits);
+      velocityLimits,
+      feedingDemo);
 }
 
 } // namespace action
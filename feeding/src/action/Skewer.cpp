@@ -1,8 +1,16 @@
 #include "feeding/action/Skewer.hpp"
 
+#include <chrono>
+#include <thread>
+#include <tuple>
+
 #include <libada/util.hpp>
 
 #include "feeding/FeedingDemo.hpp"
+#include "feeding/LookaheadPlanner.hpp"
+#include "feeding/SkewerSuccessClassifier.hpp"
+#include "feeding/SkewerThresholdAdapter.hpp"
+#include "feeding/TrialLog.hpp"
 #include "feeding/action/DetectAndMoveAboveFood.hpp"
 #include "feeding/action/Grab.hpp"
 #include "feeding/action/MoveAbovePlate.hpp"
@@ -10,8 +18,6 @@
 #include "feeding/action/MoveOutOf.hpp"
 #include "feeding/util.hpp"
 
-using ada::util::getRosParam;
-
 static const std::vector<std::string> optionPrompts{"(1) success", "(2) fail"};
 static const std::vector<std::string> actionPrompts{
     "(1) skewer", "(3) tilt", "(5) angle"};
@@ -47,8 +53,21 @@ bool skewer(
     std::vector<double> velocityLimits,
     const std::shared_ptr<FTThresholdHelper>& ftThresholdHelper,
     std::vector<std::string> rotationFreeFoodNames,
-    FeedingDemo* feedingDemo)
+    FeedingDemo* feedingDemo,
+    const std::function<bool()>& isCancelled)
 {
+  // Without a demo, e.g. in experiments, the defaults apply.
+  auto parameters = feedingDemo
+                        ? feedingDemo->getParameters()->get()
+                        : std::make_shared<const FeedingParameters>();
+
+  auto cancelled = [&] {
+    if (!isCancelled || !isCancelled())
+      return false;
+    ROS_WARN_STREAM("Skewer cancelled");
+    return true;
+  };
+
   ROS_INFO_STREAM("Move above plate");
   bool abovePlaceSuccess = moveAbovePlate(
       ada,
@@ -60,7 +79,8 @@ bool skewer(
       rotationToleranceAbovePlate,
       planningTimeout,
       maxNumTrials,
-      velocityLimits);
+      velocityLimits,
+      feedingDemo);
 
   if (!abovePlaceSuccess)
   {
@@ -70,23 +90,21 @@ bool skewer(
     ROS_WARN_STREAM("Move above plate failed. Please restart");
     return false;
   }
+  if (cancelled())
+    return false;
 
   bool detectAndMoveAboveFoodSuccess = true;
 
   int actionOverride = -1;
 
-  if (!getRosParam<bool>(
-          "/humanStudy/autoAcquisition", *(feedingDemo->getNodeHandle())))
+  if (!parameters->autoAcquisition)
   {
     // Read Action from Topic
     talk("How should I pick up the food?", true);
     ROS_INFO_STREAM("Waiting for action...");
     std::string actionName;
-    std::string actionTopic;
-    feedingDemo->getNodeHandle()->param<std::string>(
-        "/humanStudy/actionTopic", actionTopic, "/study_action_msgs");
-    actionName = getInputFromTopic(
-        actionTopic, *(feedingDemo->getNodeHandle()), false, -1);
+    actionName
+        = getInputFromTopic(parameters->actionTopic, *nodeHandle, false, -1);
     talk("Alright, let me use " + actionName, false);
 
     if (actionName == "skewer")
@@ -149,11 +167,40 @@ bool skewer(
 
   for (std::size_t trialCount = 0; trialCount < 3; ++trialCount)
   {
+    if (cancelled())
+      return false;
+
+    // The F/T and joint state record and the event log of an attempt share
+    // a name.
+    std::string trialRecordName;
+    std::shared_ptr<TrialLog> trialLog;
+    if (feedingDemo && !feedingDemo->getTrialRecordDirectory().empty())
+    {
+      trialRecordName = feedingDemo->getTrialRecordDirectory() + "/" + foodName
+                        + "-" + std::to_string(ros::Time::now().sec)
+                        + "-trial-" + std::to_string(trialCount);
+      trialLog = std::make_shared<TrialLog>(
+          trialRecordName + ".log.yaml",
+          foodName + " trial " + std::to_string(trialCount));
+      feedingDemo->setTrialLog(trialLog);
+    }
+    auto finishTrialLog = [&](const std::string& label) {
+      if (!trialLog)
+        return;
+      trialLog->logOutcome(ros::Time::now().toSec(), label);
+      feedingDemo->setTrialLog(nullptr);
+    };
 
     Eigen::Vector3d endEffectorDirection(0, 0, -1);
     std::unique_ptr<FoodItem> item;
     for (std::size_t i = 0; i < 2; ++i)
     {
+      if (cancelled())
+      {
+        finishTrialLog("cancelled");
+        return false;
+      }
+
       if (i == 0)
       {
         talk(std::string("Planning to the ") + foodName, true);
@@ -280,6 +327,7 @@ bool skewer(
 
       if (!item)
       {
+        finishTrialLog("aborted");
         talk("Failed, let me start from the beginning");
         return false;
       }
@@ -290,13 +338,9 @@ bool skewer(
       }
 
       // Add error if autonomous
-      if (getRosParam<bool>(
-              "/humanStudy/autoAcquisition", *(feedingDemo->getNodeHandle()))
-          && // autonomous
-          getRosParam<bool>(
-              "/humanStudy/createError", *(feedingDemo->getNodeHandle()))
-          &&               // add error
-          trialCount == 0) // First Trial
+      if (parameters->autoAcquisition // autonomous
+          && parameters->createError  // add error
+          && trialCount == 0)         // First Trial
       {
         ROS_WARN_STREAM("Error Requested for Acquisition!");
         endEffectorDirection(1) -= 1.0;
@@ -305,19 +349,90 @@ bool skewer(
     }
 
     if (!detectAndMoveAboveFoodSuccess)
+    {
+      finishTrialLog("aborted");
       return false;
+    }
+    if (cancelled())
+    {
+      finishTrialLog("cancelled");
+      return false;
+    }
+
+    // The fork stays above the food until moveInto, so moveInto is planned
+    // while the thresholds and recorders are set up.
+    auto lookahead = feedingDemo ? feedingDemo->getLookaheadPlanner() : nullptr;
+    if (lookahead)
+    {
+      lookahead->planEndEffectorOffset(
+          lookahead->getCurrentConfiguration(),
+          endEffectorDirection,
+          MOVE_INTO_FOOD_LENGTH,
+          planningTimeout,
+          endEffectorOffsetPositionTolerance,
+          endEffectorOffsetAngularTolerance);
+    }
+
+    auto thresholdAdapter
+        = feedingDemo ? feedingDemo->getSkewerThresholdAdapter() : nullptr;
+    double forceThreshold = foodSkeweringForces.at(foodName);
+    double torqueThreshold = 2;
+    if (thresholdAdapter)
+      std::tie(forceThreshold, torqueThreshold)
+          = thresholdAdapter->getThresholds(foodName);
 
     ROS_INFO_STREAM(
-        "Getting " << foodName << "with " << foodSkeweringForces.at(foodName)
+        "Getting " << foodName << "with " << forceThreshold
                    << "N with angle mode ");
 
-    double torqueThreshold = 2;
     if (ftThresholdHelper)
-      ftThresholdHelper->setThresholds(
-          foodSkeweringForces.at(foodName), torqueThreshold);
+      ftThresholdHelper->setThresholds(forceThreshold, torqueThreshold);
+
+    // The fork is still and empty above the food.
+    auto successClassifier = feedingDemo
+                                 ? feedingDemo->getSkewerSuccessClassifier()
+                                 : nullptr;
+    if (successClassifier)
+      successClassifier->recordBaseline();
+
+    auto trialRecorder
+        = feedingDemo ? feedingDemo->getTrialRecorder() : nullptr;
+    if (trialRecorder)
+      trialRecorder->start(trialRecordName + ".bin");
+
+    // Capture the contact forces of moveInto for the threshold adapter.
+    if (ftThresholdHelper)
+      ftThresholdHelper->startContactCapture();
 
     // ===== INTO FOOD =====
     talk("Here we go!", true);
+    Eigen::Vector3d direction(0, 0, 1);
+    aikido::trajectory::TrajectoryPtr moveIntoPath;
+    if (lookahead)
+    {
+      // moveOutOf is planned from where moveInto ends while moveInto runs.
+      moveIntoPath = lookahead->getPath();
+      if (moveIntoPath)
+      {
+        lookahead->planEndEffectorOffset(
+            lookahead->getEndConfiguration(*moveIntoPath),
+            direction,
+            moveOutofFoodLength * 2.0,
+            planningTimeout,
+            endEffectorOffsetPositionTolerance,
+            endEffectorOffsetAngularTolerance);
+      }
+    }
+    if (cancelled())
+    {
+      if (ftThresholdHelper)
+        ftThresholdHelper->stopContactCapture();
+      if (trialRecorder)
+        trialRecorder->stop();
+      finishTrialLog("cancelled");
+      return false;
+    }
+    double moveIntoStartTime = ros::Time::now().toSec();
     auto moveIntoSuccess = moveInto(
         ada,
         perception,
@@ -329,19 +444,58 @@ bool skewer(
         endEffectorOffsetAngularTolerance,
         endEffectorDirection,
         ftThresholdHelper,
-        velocityLimits);
+        velocityLimits,
+        moveIntoPath);
+
+    if (trialLog)
+    {
+      trialLog->logExecution(
+          "moveInto",
+          moveIntoStartTime,
+          ros::Time::now().toSec(),
+          moveIntoSuccess);
+    }
+
+    SkewerContact contact;
+    if (ftThresholdHelper)
+      contact
+          = SkewerContact::fromSamples(ftThresholdHelper->stopContactCapture());
 
     if (!moveIntoSuccess)
     {
+      if (trialRecorder)
+        trialRecorder->stop();
+      finishTrialLog("aborted");
       ROS_INFO_STREAM("Failed. Retry");
       talk("Sorry, I'm having a little trouble moving. Let me try again.");
       return false;
     }
 
-    std::this_thread::sleep_for(waitTimeForFood);
+    // The F/T sensor usually stops moveInto early. Then moveOutOf is planned
+    // again from where the fork stopped while waiting for the food.
+    auto waitEndTime = std::chrono::steady_clock::now() + waitTimeForFood;
+    if (lookahead && !lookahead->startsAtCurrentConfiguration())
+    {
+      lookahead->planEndEffectorOffset(
+          lookahead->getCurrentConfiguration(),
+          direction,
+          moveOutofFoodLength * 2.0,
+          planningTimeout,
+          endEffectorOffsetPositionTolerance,
+          endEffectorOffsetAngularTolerance);
+    }
+    std::this_thread::sleep_until(waitEndTime);
+    if (cancelled())
+    {
+      if (trialRecorder)
+        trialRecorder->stop();
+      finishTrialLog("cancelled");
+      return false;
+    }
 
     // ===== OUT OF FOOD =====
-    Eigen::Vector3d direction(0, 0, 1);
+    auto moveOutOfPath = lookahead ? lookahead->getPath() : nullptr;
+    double moveOutOfStartTime = ros::Time::now().toSec();
     moveOutOf(
         ada,
         nullptr,
@@ -352,9 +506,29 @@ bool skewer(
         endEffectorOffsetPositionTolerance,
         endEffectorOffsetAngularTolerance,
         ftThresholdHelper,
-        velocityLimits);
+        velocityLimits,
+        moveOutOfPath);
+
+    if (trialLog)
+    {
+      trialLog->logExecution(
+          "moveOutOf", moveOutOfStartTime, ros::Time::now().toSec(), true);
+    }
+
+    if (trialRecorder)
+      trialRecorder->stop();
+
+    bool success
+        = isSkewerSuccessful(successClassifier, foodName, optionPrompts);
+    if (thresholdAdapter)
+    {
+      thresholdAdapter->update(foodName, contact, success);
+      thresholdAdapter->save();
+    }
+
+    finishTrialLog(success ? "success" : "fail");
 
-    if (getUserInputWithOptions(optionPrompts, "Did I succeed?") == 1)
+    if (success)
     {
       ROS_INFO_STREAM("Successful");
       talk("Success.");
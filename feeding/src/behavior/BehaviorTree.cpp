@@ -0,0 +1,326 @@
+#include "feeding/behavior/BehaviorTree.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <sstream>
+
+#include <ros/ros.h>
+
+namespace feeding {
+namespace behavior {
+
+//==============================================================================
+const char* toString(Status status)
+{
+  switch (status)
+  {
+    case Status::SUCCESS:
+      return "success";
+    case Status::FAILURE:
+      return "failure";
+    case Status::CANCELLED:
+      return "cancelled";
+  }
+  return "unknown";
+}
+
+//==============================================================================
+Context::Context() : mShared(std::make_shared<Shared>()), mParent(nullptr)
+{
+  // Do nothing
+}
+
+//==============================================================================
+Context::Context(Context& parent) : mShared(parent.mShared), mParent(&parent)
+{
+  mParentCallback = mParent->onCancel([this] { cancel(); });
+}
+
+//==============================================================================
+Context::~Context()
+{
+  if (mParent)
+    mParent->removeOnCancel(mParentCallback);
+}
+
+//==============================================================================
+void Context::cancel()
+{
+  // Held while the callbacks run, so that removeOnCancel waits for them.
+  std::lock_guard<std::mutex> callbackLock(mCallbackMutex);
+  std::map<std::size_t, std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mCancelled)
+      return;
+    mCancelled = true;
+    callbacks.swap(mCallbacks);
+  }
+  for (const auto& callback : callbacks)
+    callback.second();
+}
+
+//==============================================================================
+bool Context::isCancelled() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mCancelled;
+}
+
+//==============================================================================
+std::size_t Context::onCancel(std::function<void()> callback)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  std::size_t id = mNextCallback++;
+  if (mCancelled)
+  {
+    lock.unlock();
+    callback();
+    return id;
+  }
+  mCallbacks[id] = std::move(callback);
+  return id;
+}
+
+//==============================================================================
+void Context::removeOnCancel(std::size_t id)
+{
+  std::lock_guard<std::mutex> callbackLock(mCallbackMutex);
+  std::lock_guard<std::mutex> lock(mMutex);
+  mCallbacks.erase(id);
+}
+
+//==============================================================================
+void Context::set(const std::string& key, const std::string& value)
+{
+  std::lock_guard<std::mutex> lock(mShared->mutex);
+  mShared->blackboard[key] = value;
+}
+
+//==============================================================================
+std::string Context::get(const std::string& key) const
+{
+  std::lock_guard<std::mutex> lock(mShared->mutex);
+  auto it = mShared->blackboard.find(key);
+  return it == mShared->blackboard.end() ? "" : it->second;
+}
+
+//==============================================================================
+void Context::addTiming(const Timing& timing)
+{
+  std::lock_guard<std::mutex> lock(mShared->mutex);
+  mShared->timings.push_back(timing);
+}
+
+//==============================================================================
+std::vector<Timing> Context::getTimings() const
+{
+  std::lock_guard<std::mutex> lock(mShared->mutex);
+  return mShared->timings;
+}
+
+//==============================================================================
+Node::Node(const std::string& name) : mName(name)
+{
+  // Do nothing
+}
+
+//==============================================================================
+Status Node::run(Context& context)
+{
+  if (context.isCancelled())
+    return Status::CANCELLED;
+
+  auto start = std::chrono::steady_clock::now();
+  Status status;
+  try
+  {
+    status = execute(context);
+  }
+  catch (const std::exception& e)
+  {
+    ROS_WARN_STREAM(mName << " threw: " << e.what());
+    status = Status::FAILURE;
+  }
+  if (status == Status::FAILURE && context.isCancelled())
+    status = Status::CANCELLED;
+
+  std::chrono::duration<double> duration
+      = std::chrono::steady_clock::now() - start;
+  context.addTiming(Timing{mName, duration.count(), status});
+  ROS_INFO_STREAM(
+      "[" << mName << "] " << toString(status) << " after "
+          << duration.count() << "s");
+  return status;
+}
+
+//==============================================================================
+const std::string& Node::getName() const
+{
+  return mName;
+}
+
+//==============================================================================
+Action::Action(const std::string& name, std::function<bool(Context&)> function)
+  : Node(name), mFunction(std::move(function))
+{
+  // Do nothing
+}
+
+//==============================================================================
+Status Action::execute(Context& context)
+{
+  return mFunction(context) ? Status::SUCCESS : Status::FAILURE;
+}
+
+//==============================================================================
+Sequence::Sequence(const std::string& name, std::vector<NodePtr> children)
+  : Node(name), mChildren(std::move(children))
+{
+  // Do nothing
+}
+
+//==============================================================================
+Status Sequence::execute(Context& context)
+{
+  for (const auto& child : mChildren)
+  {
+    Status status = child->run(context);
+    if (status != Status::SUCCESS)
+      return status;
+  }
+  return Status::SUCCESS;
+}
+
+//==============================================================================
+Fallback::Fallback(const std::string& name, std::vector<NodePtr> children)
+  : Node(name), mChildren(std::move(children))
+{
+  // Do nothing
+}
+
+//==============================================================================
+Status Fallback::execute(Context& context)
+{
+  for (const auto& child : mChildren)
+  {
+    Status status = child->run(context);
+    if (status != Status::FAILURE)
+      return status;
+  }
+  return Status::FAILURE;
+}
+
+//==============================================================================
+Retry::Retry(const std::string& name, NodePtr child, int maxAttempts)
+  : Node(name), mChild(std::move(child)), mMaxAttempts(maxAttempts)
+{
+  // Do nothing
+}
+
+//==============================================================================
+Status Retry::execute(Context& context)
+{
+  Status status = Status::FAILURE;
+  for (int attempt = 1; attempt <= mMaxAttempts; ++attempt)
+  {
+    status = mChild->run(context);
+    if (status != Status::FAILURE)
+      return status;
+    ROS_WARN_STREAM(
+        getName() << ": attempt " << attempt << " of " << mMaxAttempts
+                  << " failed");
+  }
+  return status;
+}
+
+//==============================================================================
+Parallel::Parallel(
+    const std::string& name, std::vector<NodePtr> children, Policy policy)
+  : Node(name), mChildren(std::move(children)), mPolicy(policy)
+{
+  // Do nothing
+}
+
+//==============================================================================
+Status Parallel::execute(Context& context)
+{
+  Context children(context);
+  std::vector<std::future<Status>> results;
+  for (std::size_t i = 0; i < mChildren.size(); ++i)
+  {
+    const auto& child = mChildren[i];
+    bool isMain = i == 0;
+    results.push_back(
+        std::async(std::launch::async, [this, &children, child, isMain] {
+          Status status = child->run(children);
+          if ((mPolicy == Policy::MAIN && isMain)
+              || (mPolicy == Policy::ALL && status == Status::FAILURE))
+            children.cancel();
+          return status;
+        }));
+  }
+
+  std::vector<Status> statuses;
+  for (auto& result : results)
+    statuses.push_back(result.get());
+
+  if (context.isCancelled())
+    return Status::CANCELLED;
+  if (mPolicy == Policy::MAIN)
+    return statuses.empty() ? Status::SUCCESS : statuses.front();
+
+  // The others were cancelled because of the failure.
+  Status result = Status::SUCCESS;
+  for (Status status : statuses)
+  {
+    if (status == Status::FAILURE)
+      return Status::FAILURE;
+    if (status == Status::CANCELLED)
+      result = Status::CANCELLED;
+  }
+  return result;
+}
+
+//==============================================================================
+void logTimings(const Context& context)
+{
+  struct Total
+  {
+    std::string node;
+    int runs;
+    double duration;
+    Status lastStatus;
+  };
+  std::vector<Total> totals;
+  for (const auto& timing : context.getTimings())
+  {
+    auto it = std::find_if(
+        totals.begin(), totals.end(), [&timing](const Total& total) {
+          return total.node == timing.node;
+        });
+    if (it == totals.end())
+    {
+      totals.push_back(Total{timing.node, 1, timing.duration, timing.status});
+      continue;
+    }
+    ++it->runs;
+    it->duration += timing.duration;
+    it->lastStatus = timing.status;
+  }
+
+  std::ostringstream summary;
+  summary << "Node timings:";
+  for (const auto& total : totals)
+  {
+    summary << "\n  [" << total.node << "] " << total.runs << " run"
+            << (total.runs == 1 ? "" : "s") << ", " << total.duration
+            << "s, last " << toString(total.lastStatus);
+  }
+  ROS_INFO_STREAM(summary.str());
+}
+
+} // namespace behavior
+} // namespace feeding
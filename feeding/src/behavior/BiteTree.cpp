@@ -0,0 +1,176 @@
+#include "feeding/behavior/BiteTree.hpp"
+
+#include <chrono>
+
+#include "feeding/TopicInput.hpp"
+#include "feeding/action/FeedFoodToPerson.hpp"
+#include "feeding/action/Skewer.hpp"
+
+namespace feeding {
+namespace behavior {
+
+namespace {
+
+/// Stops the trajectory of the arm if the context is cancelled while it
+/// is alive.
+class StopArmOnCancel
+{
+public:
+  StopArmOnCancel(Context& context, const std::shared_ptr<ada::Ada>& ada)
+    : mContext(context)
+  {
+    mCallback = mContext.onCancel([ada] {
+      ROS_WARN_STREAM("Stopping the arm");
+      ada->getTrajectoryExecutor()->cancel();
+    });
+  }
+
+  ~StopArmOnCancel()
+  {
+    mContext.removeOnCancel(mCallback);
+  }
+
+private:
+  Context& mContext;
+  std::size_t mCallback;
+};
+
+} // namespace
+
+//==============================================================================
+NodePtr createBiteTree(
+    FeedingDemo& feedingDemo,
+    const std::shared_ptr<Perception>& perception,
+    ros::NodeHandle nodeHandle)
+{
+  int maxSkewerAttempts;
+  std::string stopTopic;
+  nodeHandle.param<int>("/behavior/maxSkewerAttempts", maxSkewerAttempts, 2);
+  nodeHandle.param<std::string>(
+      "/behavior/stopTopic", stopTopic, "/feeding/stop");
+
+  auto handle = std::make_shared<ros::NodeHandle>(nodeHandle);
+  auto stopInput = std::make_shared<TopicInput>(nodeHandle, stopTopic);
+
+  auto skewer = std::make_shared<Action>(
+      "skewer", [&feedingDemo, perception, handle](Context& context) {
+        auto ada = feedingDemo.getAda();
+        auto workspace = feedingDemo.getWorkspace();
+        StopArmOnCancel stopArm(context, ada);
+
+        if (feedingDemo.getFTThresholdHelper())
+          feedingDemo.getFTThresholdHelper()->setThresholds(
+              STANDARD_FT_THRESHOLD);
+
+        return action::skewer(
+            ada,
+            workspace,
+            feedingDemo.getCollisionConstraint(),
+            perception,
+            handle.get(),
+            context.get("foodName"),
+            workspace->getPlate()->getRootBodyNode()->getWorldTransform(),
+            feedingDemo.getPlateEndEffectorTransform(),
+            feedingDemo.mFoodSkeweringForces,
+            feedingDemo.mPlateTSRParameters.at("horizontalTolerance"),
+            feedingDemo.mPlateTSRParameters.at("verticalTolerance"),
+            feedingDemo.mPlateTSRParameters.at("rotationTolerance"),
+            feedingDemo.mFoodTSRParameters.at("height"),
+            feedingDemo.mFoodTSRParameters.at("horizontalTolerance"),
+            feedingDemo.mFoodTSRParameters.at("verticalTolerance"),
+            feedingDemo.mFoodTSRParameters.at("rotationTolerance"),
+            feedingDemo.mFoodTSRParameters.at("tiltTolerance"),
+            feedingDemo.mMoveOufOfFoodLength,
+            feedingDemo.mEndEffectorOffsetPositionTolerance,
+            feedingDemo.mEndEffectorOffsetAngularTolerance,
+            feedingDemo.mWaitTimeForFood,
+            feedingDemo.mPlanningTimeout,
+            feedingDemo.mMaxNumTrials,
+            feedingDemo.mVelocityLimits,
+            feedingDemo.getFTThresholdHelper(),
+            feedingDemo.mRotationFreeFoodNames,
+            &feedingDemo,
+            [&context] { return context.isCancelled(); });
+      });
+
+  auto transfer = std::make_shared<Action>(
+      "transfer", [&feedingDemo, perception, handle](Context& context) {
+        auto ada = feedingDemo.getAda();
+        auto workspace = feedingDemo.getWorkspace();
+        StopArmOnCancel stopArm(context, ada);
+
+        if (feedingDemo.getFTThresholdHelper())
+          feedingDemo.getFTThresholdHelper()->setThresholds(
+              STANDARD_FT_THRESHOLD);
+
+        ROS_INFO_STREAM("Move forque in front of person");
+        bool tilted = context.get("tilted") == "true";
+        action::feedFoodToPerson(
+            ada,
+            workspace,
+            feedingDemo.getCollisionConstraint(),
+            feedingDemo.getCollisionConstraintWithWallFurtherBack(),
+            perception,
+            handle.get(),
+            workspace->getPlate()->getRootBodyNode()->getWorldTransform(),
+            feedingDemo.getPlateEndEffectorTransform(),
+            workspace->getPersonPose(),
+            feedingDemo.mWaitTimeForPerson,
+            feedingDemo.mPlateTSRParameters.at("height"),
+            feedingDemo.mPlateTSRParameters.at("horizontalTolerance"),
+            feedingDemo.mPlateTSRParameters.at("verticalTolerance"),
+            feedingDemo.mPlateTSRParameters.at("rotationTolerance"),
+            feedingDemo.mPersonTSRParameters.at("distance"),
+            feedingDemo.mPersonTSRParameters.at("horizontalTolerance"),
+            feedingDemo.mPersonTSRParameters.at("verticalTolerance"),
+            feedingDemo.mPlanningTimeout,
+            feedingDemo.mMaxNumTrials,
+            feedingDemo.mEndEffectorOffsetPositionTolerance,
+            feedingDemo.mEndEffectorOffsetAngularTolerance,
+            feedingDemo.mVelocityLimits,
+            tilted ? &feedingDemo.mTiltOffset : nullptr,
+            &feedingDemo,
+            [&context] { return context.isCancelled(); });
+        return !context.isCancelled();
+      });
+
+  // Runs alongside the bite until it is done, and preempts it on "stop".
+  auto stopMonitor = std::make_shared<Action>(
+      "stop monitor", [stopInput](Context& context) {
+        ros::Time since = ros::Time::now();
+        while (true)
+        {
+          std::size_t request;
+          auto command = stopInput->receive(since, &request);
+          while (command.wait_for(std::chrono::milliseconds(100))
+                 != std::future_status::ready)
+          {
+            if (context.isCancelled())
+            {
+              stopInput->cancel(request);
+              return true;
+            }
+          }
+          if (command.get() == "stop")
+          {
+            ROS_WARN_STREAM("Bite preempted");
+            context.cancel();
+            return true;
+          }
+        }
+      });
+
+  auto bite = std::make_shared<Sequence>(
+      "bite",
+      std::vector<NodePtr>{
+          std::make_shared<Retry>("acquire", skewer, maxSkewerAttempts),
+          transfer});
+
+  return std::make_shared<Parallel>(
+      "bite with stop",
+      std::vector<NodePtr>{bite, stopMonitor},
+      Parallel::Policy::MAIN);
+}
+
+} // namespace behavior
+} // namespace feeding
@@ -28,11 +28,13 @@ Perception::Perception(
     std::shared_ptr<ros::NodeHandle> nodeHandle,
     std::shared_ptr<TargetFoodRanker> ranker,
     float faceZOffset,
-    bool removeRotationForFood)
+    bool removeRotationForFood,
+    std::shared_ptr<ParameterSnapshot> parameters)
   : mWorld(world)
   , mAda(ada)
   , mAdaMetaSkeleton(adaMetaSkeleton)
   , mNodeHandle(nodeHandle)
+  , mParameters(std::move(parameters))
   , mTargetFoodRanker(ranker)
   , mFaceZOffset(faceZOffset)
   , mRemoveRotationForFood(removeRotationForFood)
@@ -40,6 +42,8 @@ Perception::Perception(
 {
   if (!mNodeHandle)
     throw std::invalid_argument("Ros nodeHandle is nullptr.");
+  if (!mParameters)
+    mParameters = std::make_shared<ParameterSnapshot>(*mNodeHandle);
   std::string detectorDataURI
       = getRosParam<std::string>("/perception/detectorDataUri", *mNodeHandle);
   std::string referenceFrameName = getRosParam<std::string>(
@@ -193,8 +197,7 @@ Eigen::Isometry3d Perception::perceiveFace()
       auto faceTransform = perceivedFace->getBodyNode(0)->getWorldTransform();
 
       // fixed distance:
-      double fixedFaceY
-          = getRosParam<double>("/feedingDemo/fixedFaceY", *mNodeHandle);
+      double fixedFaceY = mParameters->get()->fixedFaceY;
       if (fixedFaceY > 0)
       {
         faceTransform.translation().y() = fixedFaceY;
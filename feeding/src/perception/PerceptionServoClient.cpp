@@ -12,6 +12,7 @@
 
 #include <libada/util.hpp>
 
+#include "feeding/Retimer.hpp"
 #include "feeding/util.hpp"
 
 #define THRESHOLD 10.0 // s to wait for good frame
@@ -543,8 +544,8 @@ SplinePtr PerceptionServoClient::planToGoalPose(
         *dynamic_cast<Interpolated*>(trajToGoal.get()),
         mVelocityLimits,
         mMaxAcceleration,
-        1e-2,
-        3e-3);
+        KUNZ_MAX_DEVIATION,
+        KUNZ_TIME_STEP);
 
     if (!timedTraj)
       ROS_WARN_STREAM("Concatenation &/ timing failed");
@@ -608,8 +609,8 @@ SplinePtr PerceptionServoClient::planToGoalPose(
         *dynamic_cast<Interpolated*>(concatenatedTraj.get()),
         mVelocityLimits,
         mMaxAcceleration,
-        1e-2,
-        9e-3);
+        KUNZ_MAX_DEVIATION,
+        KUNZ_COARSE_TIME_STEP);
 
     ROS_INFO_STREAM("8");
   }
@@ -1,10 +1,12 @@
 #include "feeding/util.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <map>
+#include <mutex>
 
 #include <aikido/common/Spline.hpp>
-#include <aikido/common/StepSequence.hpp>
 #include <aikido/distance/NominalConfigurationRanker.hpp>
 #include <aikido/distance/defaults.hpp>
 #include <aikido/planner/parabolic/ParabolicTimer.hpp>
@@ -16,6 +18,10 @@
 
 #include <libada/util.hpp>
 
+#include "feeding/OperatorInput.hpp"
+#include "feeding/Speech.hpp"
+#include "feeding/TopicInput.hpp"
+#include "feeding/WebStatusPublisher.hpp"
 #include "std_msgs/String.h"
 
 static const std::vector<double> weights = {1, 1, 0.01, 0.01, 0.01, 0.01};
@@ -30,6 +36,17 @@ inline int sgn(double x)
   return (x < 0) ? -1 : (x > 0);
 }
 
+static std::shared_ptr<ParameterSnapshot> parameterSnapshot;
+
+//==============================================================================
+/// Returns the snapshot set by initTopics, or the defaults before it.
+static std::shared_ptr<const FeedingParameters> getParameters()
+{
+  if (parameterSnapshot)
+    return parameterSnapshot->get();
+  return std::make_shared<const FeedingParameters>();
+}
+
 //==============================================================================
 void handleArguments(
     int argc,
@@ -81,57 +98,6 @@ void handleArguments(
   }
 }
 
-//==============================================================================
-void printStateWithTime(
-    double t,
-    std::size_t dimension,
-    Eigen::VectorXd& stateVec,
-    Eigen::VectorXd& velocityVec,
-    std::ofstream& cout)
-{
-  cout << t << ",";
-  for (std::size_t i = 0; i < dimension; i++)
-  {
-    cout << stateVec[i] << "," << velocityVec[i];
-    if (i < dimension - 1)
-    {
-      cout << ",";
-    }
-  }
-  cout << std::endl;
-  return;
-}
-
-//==============================================================================
-void dumpSplinePhasePlot(
-    const aikido::trajectory::Spline& spline,
-    const std::string& filename,
-    double timeStep)
-{
-  std::ofstream phasePlotFile;
-  phasePlotFile.open(filename);
-  auto stateSpace = spline.getStateSpace();
-  std::size_t dim = stateSpace->getDimension();
-
-  aikido::common::StepSequence sequence(
-      timeStep, true, true, spline.getStartTime(), spline.getEndTime());
-  auto state = stateSpace->createState();
-  Eigen::VectorXd stateVec(dim);
-  Eigen::VectorXd velocityVec(dim);
-
-  for (std::size_t i = 0; i < sequence.getLength(); i++)
-  {
-    double t = sequence[i];
-    spline.evaluate(t, state);
-    spline.evaluateDerivative(t, 1, velocityVec);
-    stateSpace->logMap(state, stateVec);
-    printStateWithTime(t, dim, stateVec, velocityVec, phasePlotFile);
-  }
-
-  phasePlotFile.close();
-  return;
-}
-
 //==============================================================================
 std::string getCurrentTimeDate()
 {
@@ -143,15 +109,24 @@ std::string getCurrentTimeDate()
   return ss.str();
 }
 
+//==============================================================================
+/// Returns the option number in \c answer, or -1 if it is not a number.
+static int parseOption(const std::string& answer)
+{
+  char* end;
+  long option = std::strtol(answer.c_str(), &end, 10);
+  if (end == answer.c_str())
+    return -1;
+  return static_cast<int>(option);
+}
+
 //==============================================================================
 std::string getUserFoodInput(
     bool food_only, ros::NodeHandle& nodeHandle, bool useAlexa, double timeout)
 {
 
   std::string foodName;
-  std::string foodTopic;
-  nodeHandle.param<std::string>(
-      "/humanStudy/foodTopic", foodTopic, "/study_food_msgs");
+  std::string foodTopic = getParameters()->foodTopic;
   foodName
       = useAlexa ? getInputFromTopic(foodTopic, nodeHandle, true, timeout) : "";
   if (foodName != "")
@@ -188,9 +163,7 @@ std::string getUserFoodInput(
 
   while (true)
   {
-    std::cout << "> ";
-    int id;
-    std::cin >> id;
+    int id = parseOption(askOperator("Which food item do you want?"));
     if (id < 1 || id > max_id)
     {
       ROS_WARN_STREAM("Invalid argument. Quitting...");
@@ -208,6 +181,20 @@ std::string getUserFoodInput(
   }
 }
 
+static std::mutex topicInputsMutex;
+static std::map<std::string, std::shared_ptr<TopicInput>> topicInputs;
+
+//==============================================================================
+static std::shared_ptr<TopicInput> getTopicInput(
+    const std::string& topic, const ros::NodeHandle& nodeHandle)
+{
+  std::lock_guard<std::mutex> lock(topicInputsMutex);
+  auto& input = topicInputs[topic];
+  if (!input)
+    input = std::make_shared<TopicInput>(nodeHandle, topic);
+  return input;
+}
+
 //==============================================================================
 std::string getInputFromTopic(
     std::string topic,
@@ -215,33 +202,34 @@ std::string getInputFromTopic(
     bool validateAsFood,
     double timeout)
 {
-  boost::shared_ptr<std_msgs::String const> sharedPtr;
-  std_msgs::String rosFoodWord;
+  auto input = getTopicInput(topic, nodeHandle);
 
-  if (timeout > 0)
-  {
-    sharedPtr = ros::topic::waitForMessage<std_msgs::String>(
-        topic, ros::Duration(timeout));
-  }
-  else
-  {
-    sharedPtr = ros::topic::waitForMessage<std_msgs::String>(topic);
-  }
+  // Input sent shortly before the question is asked answers it.
+  double maxAge = getParameters()->topicInputMaxAge;
+  ros::Time newerThan(std::max(0.0, ros::Time::now().toSec() - maxAge));
 
-  if (sharedPtr == nullptr)
-  {
-    ROS_INFO_STREAM("No message from topic, please input manually");
-    return "";
-  }
-  rosFoodWord = *sharedPtr;
-  std::string foodWord = rosFoodWord.data.c_str();
-  if (foodWord.compare("~~no_input~~") == 0)
+  auto deadline = std::chrono::steady_clock::now()
+                  + std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::duration<double>(std::max(timeout, 0.0)));
+  std::string foodWord;
+  do
   {
-    std_msgs::String rosFoodWord;
-    sharedPtr = ros::topic::waitForMessage<std_msgs::String>(topic);
-    rosFoodWord = *sharedPtr;
-    std::string foodWord = rosFoodWord.data.c_str();
-  }
+    std::size_t request;
+    auto message = input->receive(newerThan, &request);
+    bool isTimedOut
+        = timeout > 0
+          && message.wait_until(deadline) != std::future_status::ready;
+    // The input is shared, so only this call is cancelled. A message that
+    // arrived just before is still taken.
+    if (isTimedOut)
+      input->cancel(request);
+    foodWord = message.get();
+    if (isTimedOut && foodWord.empty())
+    {
+      ROS_INFO_STREAM("No message from topic, please input manually");
+      return "";
+    }
+  } while (foodWord == "~~no_input~~");
   ROS_INFO_STREAM("Got Input " << foodWord);
   if (validateAsFood)
   {
@@ -266,15 +254,33 @@ int getUserInputWithOptions(
 {
   ROS_INFO_STREAM(prompt);
 
+  std::string question = prompt;
   for (const auto& option : optionPrompts)
   {
     ROS_INFO_STREAM(option);
+    question += "\n" + option;
   }
-  std::cout << "> ";
-  int option;
-  std::cin.clear();
-  std::cin >> option;
-  return option;
+  return parseOption(askOperator(question));
+}
+
+static std::mutex operatorInputMutex;
+static std::unique_ptr<OperatorInput> operatorInput;
+
+//==============================================================================
+std::string askOperator(const std::string& prompt)
+{
+  std::lock_guard<std::mutex> lock(operatorInputMutex);
+  if (!operatorInput)
+    operatorInput.reset(new TtyOperatorInput);
+  return operatorInput->ask(prompt);
+}
+
+//==============================================================================
+bool waitForOperator(const std::string& prompt)
+{
+  ROS_INFO_STREAM(prompt << " Press [ENTER] to continue, [n] to stop.");
+  std::string answer = askOperator(prompt);
+  return answer.empty() || (answer[0] != 'n' && answer[0] != 'N');
 }
 
 //==============================================================================
@@ -392,8 +398,15 @@ Eigen::Isometry3d getForqueTransform(tf::TransformListener& tfListener)
 aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
     const std::shared_ptr<ada::Ada>& ada)
 {
-  auto space = ada->getArm()->getStateSpace();
-  auto metaSkeleton = ada->getArm()->getMetaSkeleton();
+  return getConfigurationRanker(
+      ada->getArm()->getStateSpace(), ada->getArm()->getMetaSkeleton());
+}
+
+//==============================================================================
+aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
+    const aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr& space,
+    const dart::dynamics::MetaSkeletonPtr& metaSkeleton)
+{
   auto nominalState = space->createState();
 
   nominalState = space->getScopedStateFromMetaSkeleton(metaSkeleton.get());
@@ -402,82 +415,93 @@ aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
       space, metaSkeleton, std::move(nominalState), weights);
 }
 
-static ros::Publisher actionPub;
-static ros::Publisher timingPub;
-static ros::Publisher transferPub;
-static ros::Publisher talkPub;
-void initTopics(ros::NodeHandle* nodeHandle)
+//==============================================================================
+aikido::distance::ConfigurationRankerPtr getConfigurationRanker(
+    const aikido::statespace::dart::ConstMetaSkeletonStateSpacePtr& space,
+    const dart::dynamics::MetaSkeletonPtr& metaSkeleton,
+    const Eigen::VectorXd& nominalConfiguration)
 {
-  actionPub = nodeHandle->advertise<std_msgs::String>("/action_done", 100);
-  timingPub = nodeHandle->advertise<std_msgs::String>("/timing_done", 100);
-  transferPub = nodeHandle->advertise<std_msgs::String>("/transfer_done", 100);
-  talkPub = nodeHandle->advertise<std_msgs::String>("/talk_pub", 100);
+  auto nominalState = space->createState();
+  space->convertPositionsToState(nominalConfiguration, nominalState);
+
+  return std::make_shared<NominalConfigurationRanker>(
+      space, metaSkeleton, std::move(nominalState), weights);
 }
 
+static std::unique_ptr<WebStatusPublisher> webStatusPublisher;
+static std::unique_ptr<SpeechQueue> speechQueue;
+
 //==============================================================================
-void talk(const std::string& statement, bool background)
+void initTopics(
+    ros::NodeHandle* nodeHandle,
+    bool adaReal,
+    std::shared_ptr<ParameterSnapshot> parameters)
 {
-  std::string cmd;
-  if (background)
-  {
-    cmd = "aoss swift \"" + statement + "\"" + " &";
-  }
+  parameterSnapshot = std::move(parameters);
+  webStatusPublisher.reset(new WebStatusPublisher(*nodeHandle));
+
+  // Subscribe to the study input now so that no command gets lost.
+  auto snapshot = getParameters();
+  getTopicInput(snapshot->foodTopic, *nodeHandle);
+  getTopicInput(snapshot->actionTopic, *nodeHandle);
+
+  std::string backendName;
+  nodeHandle->param<std::string>(
+      "/speech/backend", backendName, adaReal ? "swift" : "null");
+  std::unique_ptr<SpeechBackend> backend;
+  if (backendName == "swift")
+    backend.reset(new SwiftSpeechBackend);
   else
+    backend.reset(new NullSpeechBackend);
+  speechQueue.reset(new SpeechQueue(std::move(backend), *nodeHandle));
+
+  std::lock_guard<std::mutex> lock(operatorInputMutex);
+  operatorInput = createOperatorInput(*nodeHandle);
+}
+
+//==============================================================================
+std::shared_future<bool> talk(const std::string& statement, bool background)
+{
+  if (!speechQueue)
   {
-    cmd = "aoss swift \"" + statement + "\"";
+    ROS_WARN_STREAM("Speech is not started, not saying " << statement);
+    std::promise<bool> dropped;
+    dropped.set_value(false);
+    return dropped.get_future().share();
   }
-  std::system(cmd.c_str());
-  std_msgs::String msg;
-  msg.data = statement;
-  if (talkPub.getNumSubscribers() < 1)
+  return speechQueue->say(
+      statement,
+      background ? SpeechQueue::Priority::LOW
+                 : SpeechQueue::Priority::NORMAL);
+}
+
+//==============================================================================
+static void publishToWeb(WebStatusPublisher::Event event)
+{
+  if (!webStatusPublisher)
   {
-    ROS_INFO_STREAM("Waiting for subscribers...");
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    ROS_WARN_STREAM("Web status topics are not advertised");
+    return;
   }
-  talkPub.publish(msg);
+  webStatusPublisher->publish(event);
 }
 
+//==============================================================================
 void publishActionDoneToWeb(ros::NodeHandle* nodeHandle)
 {
-  if (!actionPub)
-  {
-    ROS_WARN_STREAM("EMPTY ACTION PUBLISHER");
-  }
-  std_msgs::String msg;
-  msg.data = "action done";
-  if (actionPub.getNumSubscribers() < 1)
-  {
-    ROS_INFO_STREAM("Waiting for subscribers...");
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-  }
-  actionPub.publish(msg);
-  ROS_INFO_STREAM("action done published to web page");
+  publishToWeb(WebStatusPublisher::Event::ACTION_DONE);
 }
 
+//==============================================================================
 void publishTimingDoneToWeb(ros::NodeHandle* nodeHandle)
 {
-  std_msgs::String msg;
-  msg.data = "timing done";
-  if (timingPub.getNumSubscribers() < 1)
-  {
-    ROS_INFO_STREAM("Waiting for subscribers...");
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-  }
-  timingPub.publish(msg);
-  ROS_INFO_STREAM("timing done published to web page");
+  publishToWeb(WebStatusPublisher::Event::TIMING_DONE);
 }
 
+//==============================================================================
 void publishTransferDoneToWeb(ros::NodeHandle* nodeHandle)
 {
-  std_msgs::String msg;
-  msg.data = "transfer done";
-  if (transferPub.getNumSubscribers() < 1)
-  {
-    ROS_INFO_STREAM("Waiting for subscribers...");
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-  }
-  transferPub.publish(msg);
-  ROS_INFO_STREAM("transfer done published to web page");
+  publishToWeb(WebStatusPublisher::Event::TRANSFER_DONE);
 }
 
 } // namespace feeding